@@ -13,9 +13,9 @@ namespace AxionOnly {
 #define AXION_ONLY_TRUNCATION_MODIFIER(x)                                      \
     template <>                                                                \
     AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE double TruncationModifier<x>(     \
-        const amrex::Array4<const double> &state, const int i, const int j,    \
-        const int k, const int lev, const double time, const double dt,        \
-        const double dx, const double truncation_error,                        \
+        const amrex::Array4<const amrex::Real> &state, const int i,            \
+        const int j, const int k, const int lev, const double time,            \
+        const double dt, const double dx, const double truncation_error,       \
         const double *params) {                                                \
         return truncation_error * dt / time;                                   \
     }
@@ -23,9 +23,9 @@ namespace AxionOnly {
 #define AXION_ONLY_TRUNCATION_MODIFIER2(x)                                     \
     template <>                                                                \
     AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE double TruncationModifier<x>(     \
-        const amrex::Array4<const double> &state, const int i, const int j,    \
-        const int k, const int lev, const double time, const double dt,        \
-        const double dx, const double truncation_error,                        \
+        const amrex::Array4<const amrex::Real> &state, const int i,            \
+        const int j, const int k, const int lev, const double time,            \
+        const double dt, const double dx, const double truncation_error,       \
         const double *params) {                                                \
         return truncation_error / time;                                        \
     }
@@ -121,7 +121,7 @@ long Cosmology::GetStringTags(const int lev) {
     // performace critical and it is a lot simpler this way.
 #pragma omp parallel reduction(+: ntags)
     for (amrex::MFIter mfi(state, true); mfi.isValid(); ++mfi) {
-        const amrex::Array4<double const>& state_fab = state.array(mfi);
+        const amrex::Array4<amrex::Real const>& state_fab = state.array(mfi);
         const amrex::Box& tilebox  = mfi.tilebox();
         const amrex::Dim3 lo = amrex::lbound(tilebox);
         const amrex::Dim3 hi = amrex::ubound(tilebox);
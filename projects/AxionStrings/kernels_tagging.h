@@ -29,7 +29,7 @@ int ZeroXing(double Psi1_1, double Psi2_1, double Psi1_2, double Psi2_2) {
  * @return  Winding factor.
  */
 AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
-int WindingAxis1(const amrex::Array4<const double>& state,
+int WindingAxis1(const amrex::Array4<const amrex::Real>& state,
                  const int i, const int j, const int k) {
     return ZeroXing(state(i  ,j  ,k  ,Scalar::Psi1),
                     state(i  ,j  ,k  ,Scalar::Psi2),
@@ -50,7 +50,7 @@ int WindingAxis1(const amrex::Array4<const double>& state,
 }
 
 AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
-int WindingAxis2(const amrex::Array4<const double>& state,
+int WindingAxis2(const amrex::Array4<const amrex::Real>& state,
                  const int i, const int j, const int k) {
     return ZeroXing(state(i  ,j  ,k  ,Scalar::Psi1),
                     state(i  ,j  ,k  ,Scalar::Psi2),
@@ -71,7 +71,7 @@ int WindingAxis2(const amrex::Array4<const double>& state,
 }
 
 AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
-int WindingAxis3(const amrex::Array4<const double>& state,
+int WindingAxis3(const amrex::Array4<const amrex::Real>& state,
                  const int i, const int j, const int k) {
     return ZeroXing(state(i  ,j  ,k  ,Scalar::Psi1),
                     state(i  ,j  ,k  ,Scalar::Psi2),
@@ -95,7 +95,7 @@ int WindingAxis3(const amrex::Array4<const double>& state,
  * @return  Boolean value as to whether cell should be refined or not.
  */
 template<> AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
-bool TagCellForRefinement<true>(const amrex::Array4<const double>& state,
+bool TagCellForRefinement<true>(const amrex::Array4<const amrex::Real>& state,
         const int i, const int j, const int k, const int lev, const double time,
         const double dt, const double dx, const double* params) {
     // Check all three plaquettes (in positive index direction) for string
@@ -114,7 +114,7 @@ bool TagCellForRefinement<true>(const amrex::Array4<const double>& state,
  */
 #define AXION_STRING_TRUNCATION_MODIFIER(x) \
 template<> AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE \
-double TruncationModifier<x>(const amrex::Array4<const double>& state, \
+double TruncationModifier<x>(const amrex::Array4<const amrex::Real>& state, \
         const int i, const int j, const int k, const int lev, \
         const double time, const double dt, const double dx, \
         const double truncation_error, const double* params) { \
@@ -20,7 +20,7 @@ using namespace AxionStrings;
  */
 AMREX_GPU_DEVICE AMREX_FORCE_INLINE
 void Rhs(const amrex::Array4<double>& rhs,
-         const amrex::Array4<const double>& state,
+         const amrex::Array4<const amrex::Real>& state,
          const int i, const int j, const int k, const int lev,
          const double time, const double dt, const double dx,
          const double* params) {
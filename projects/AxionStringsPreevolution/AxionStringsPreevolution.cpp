@@ -29,7 +29,7 @@ void AxionStringsPreevolution::SetRandomState() {
 
     // #pragma omp parallel
     for (amrex::MFIter mfi(state, true); mfi.isValid(); ++mfi) {
-        const amrex::Array4<double> &state_arr = state.array(mfi);
+        const amrex::Array4<amrex::Real> &state_arr = state.array(mfi);
         const amrex::Box &bx = mfi.tilebox();
 
         const amrex::Dim3 lo = amrex::lbound(bx);
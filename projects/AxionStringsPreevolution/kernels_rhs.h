@@ -19,8 +19,9 @@ using namespace AxionStrings;
  * @param   dx      Grid spacing.
  */
 AMREX_GPU_DEVICE AMREX_FORCE_INLINE void
-Rhs(const amrex::Array4<double> &rhs, const amrex::Array4<const double> &state,
-    const int i, const int j, const int k, const int lev, const double time,
+Rhs(const amrex::Array4<double> &rhs,
+    const amrex::Array4<const amrex::Real> &state, const int i, const int j,
+    const int k, const int lev, const double time,
     const double dt, const double dx, const double *params) {
     // Fetch field values.
     double Psi1 = state(i, j, k, Scalar::Psi1);
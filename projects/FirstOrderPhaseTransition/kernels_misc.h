@@ -9,7 +9,7 @@ namespace FirstOrderPhaseTransition {
 /** @brief TODO
  */
 AMREX_FORCE_INLINE
-double dPhi2(amrex::Array4<double const> const& state, const int i,
+double dPhi2(amrex::Array4<amrex::Real const> const& state, const int i,
         const int j, const int k, const int lev, const double time,
         const double dt, const double dx,
         const std::vector<double>& params) {
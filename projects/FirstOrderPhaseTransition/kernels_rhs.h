@@ -18,8 +18,9 @@ namespace FirstOrderPhaseTransition {
  * @param   dx      Grid spacing.
  */
 AMREX_GPU_DEVICE AMREX_FORCE_INLINE void
-Rhs(const amrex::Array4<double> &rhs, const amrex::Array4<const double> &state,
-    const int i, const int j, const int k, const int lev, const double time,
+Rhs(const amrex::Array4<double> &rhs,
+    const amrex::Array4<const amrex::Real> &state, const int i, const int j,
+    const int k, const int lev, const double time,
     const double dt, const double dx, const double *params) {
     int potential_type = static_cast<int>(params[0]);
     double quadratic = params[1];
@@ -55,8 +56,9 @@ Rhs(const amrex::Array4<double> &rhs, const amrex::Array4<const double> &state,
 
 template <>
 AMREX_GPU_DEVICE AMREX_FORCE_INLINE void GravitationalWavesRhs<true>(
-    const amrex::Array4<double> &rhs, const amrex::Array4<const double> &state,
-    const int i, const int j, const int k, const int lev, const double time,
+    const amrex::Array4<double> &rhs,
+    const amrex::Array4<const amrex::Real> &state, const int i, const int j,
+    const int k, const int lev, const double time,
     const double dt, const double dx, const double *params) {
     double tc = params[0];
     double t0 = params[1];
@@ -12,7 +12,7 @@ namespace FirstOrderPhaseTransition {
  */
 #define FIRST_ORDER_PHASE_TRANSITION_TRUNCATION_MODIFIER(x) \
 template<> AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE \
-double TruncationModifier<x>(const amrex::Array4<const double>& state, \
+double TruncationModifier<x>(const amrex::Array4<const amrex::Real>& state, \
         const int i, const int j, const int k, const int lev, \
         const double time, const double dt, const double dx, \
         const double truncation_error, const double* params) { \
@@ -21,7 +21,7 @@ double TruncationModifier<x>(const amrex::Array4<const double>& state, \
 
 #define FIRST_ORDER_PHASE_TRANSITION_TRUNCATION_MODIFIER_DT(x) \
 template<> AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE \
-double TruncationModifier<x>(const amrex::Array4<const double>& state, \
+double TruncationModifier<x>(const amrex::Array4<const amrex::Real>& state, \
         const int i, const int j, const int k, const int lev, \
         const double time, const double dt, const double dx, \
         const double truncation_error, const double* params) { \
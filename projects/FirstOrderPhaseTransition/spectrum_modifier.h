@@ -17,28 +17,14 @@ struct SpectrumModifier_UtimesK
     };
 
     virtual void FourierSpaceModifications(
-            amrex::MultiFab du_real[6], amrex::MultiFab du_imag[6],
-            const double dk, const int dimN) {
+            amrex::FabArray<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>>&
+                du, const int slot[6], const double dk, const int dimN) {
 
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
-        for (amrex::MFIter mfi(du_real[0], true); mfi.isValid(); ++mfi) {
+        for (amrex::MFIter mfi(du, true); mfi.isValid(); ++mfi) {
             const amrex::Box& bx = mfi.tilebox();
-            amrex::Array4<double> const& dr0 = du_real[0].array(mfi);
-            amrex::Array4<double> const& dr1 = du_real[1].array(mfi);
-            amrex::Array4<double> const& dr2 = du_real[2].array(mfi);
-            amrex::Array4<double> const& dr3 = du_real[3].array(mfi);
-            amrex::Array4<double> const& dr4 = du_real[4].array(mfi);
-            amrex::Array4<double> const& dr5 = du_real[5].array(mfi);
-            amrex::Array4<double> const& di0 = du_imag[0].array(mfi);
-            amrex::Array4<double> const& di1 = du_imag[1].array(mfi);
-            amrex::Array4<double> const& di2 = du_imag[2].array(mfi);
-            amrex::Array4<double> const& di3 = du_imag[3].array(mfi);
-            amrex::Array4<double> const& di4 = du_imag[4].array(mfi);
-            amrex::Array4<double> const& di5 = du_imag[5].array(mfi);
-            const amrex::Array4<double>* du_real_arr[6] = {&dr0, &dr1, &dr2,
-                                                           &dr3, &dr4, &dr5};
-            const amrex::Array4<double>* du_imag_arr[6] = {&di0, &di1, &di2,
-                                                           &di3, &di4, &di5};
+            amrex::Array4<amrex::GpuComplex<amrex::Real>> const& du_arr =
+                du.array(mfi);
 
             const amrex::Dim3 lo = amrex::lbound(bx);
             const amrex::Dim3 hi = amrex::ubound(bx);
@@ -53,8 +39,9 @@ struct SpectrumModifier_UtimesK
                         double k = std::sqrt(kx*kx + ky*ky + kz*kz) * dk;
 
                         for (int i = 0; i < 6; ++i) {
-                            (*du_real_arr)[i](a, b, c) *= k;
-                            (*du_imag_arr)[i](a, b, c) *= k;
+                            du_arr(a, b, c, i) = amrex::GpuComplex<amrex::Real>(
+                                    du_arr(a, b, c, i).real() * k,
+                                    du_arr(a, b, c, i).imag() * k);
                         }
                     }
                 }
@@ -70,28 +57,14 @@ struct SpectrumModifier_2BubblesFrom1
     }
 
     virtual void FourierSpaceModifications(
-            amrex::MultiFab du_real[6], amrex::MultiFab du_imag[6],
-            const double dk, const int dimN) {
+            amrex::FabArray<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>>&
+                du, const int slot[6], const double dk, const int dimN) {
 
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
-        for (amrex::MFIter mfi(du_real[0], true); mfi.isValid(); ++mfi) {
+        for (amrex::MFIter mfi(du, true); mfi.isValid(); ++mfi) {
             const amrex::Box& bx = mfi.tilebox();
-            amrex::Array4<double> const& dr0 = du_real[0].array(mfi);
-            amrex::Array4<double> const& dr1 = du_real[1].array(mfi);
-            amrex::Array4<double> const& dr2 = du_real[2].array(mfi);
-            amrex::Array4<double> const& dr3 = du_real[3].array(mfi);
-            amrex::Array4<double> const& dr4 = du_real[4].array(mfi);
-            amrex::Array4<double> const& dr5 = du_real[5].array(mfi);
-            amrex::Array4<double> const& di0 = du_imag[0].array(mfi);
-            amrex::Array4<double> const& di1 = du_imag[1].array(mfi);
-            amrex::Array4<double> const& di2 = du_imag[2].array(mfi);
-            amrex::Array4<double> const& di3 = du_imag[3].array(mfi);
-            amrex::Array4<double> const& di4 = du_imag[4].array(mfi);
-            amrex::Array4<double> const& di5 = du_imag[5].array(mfi);
-            const amrex::Array4<double>* du_real_arr[6] = {&dr0, &dr1, &dr2,
-                                                           &dr3, &dr4, &dr5};
-            const amrex::Array4<double>* du_imag_arr[6] = {&di0, &di1, &di2,
-                                                           &di3, &di4, &di5};
+            amrex::Array4<amrex::GpuComplex<amrex::Real>> const& du_arr =
+                du.array(mfi);
 
             const amrex::Dim3 lo = amrex::lbound(bx);
             const amrex::Dim3 hi = amrex::ubound(bx);
@@ -108,10 +81,11 @@ struct SpectrumModifier_2BubblesFrom1
                         double cx = std::cos(kd);
 
                         for (int i = 0; i < 6; ++i) {
-                            double dur = (*du_real_arr)[i](a, b, c);
-                            double dui = (*du_imag_arr)[i](a, b, c);
-                            (*du_real_arr)[i](a,b,c) = dur + (cx*dur - sx*dui);
-                            (*du_imag_arr)[i](a,b,c) = dui + (sx*dur + cx*dui);
+                            double dur = du_arr(a, b, c, i).real();
+                            double dui = du_arr(a, b, c, i).imag();
+                            du_arr(a, b, c, i) = amrex::GpuComplex<amrex::Real>(
+                                    dur + (cx*dur - sx*dui),
+                                    dui + (sx*dur + cx*dui));
                         }
                     }
                 }
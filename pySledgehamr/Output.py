@@ -302,6 +302,31 @@ class Output:
         fin.close()
         return d
 
+    ## Returns the throughput logged by the latest performance monitor output.
+    # @return   d           Dictionary containing the storage precision in
+    #                       bytes and the mean number of cells advanced per
+    #                       second on each level. None if nothing has been
+    #                       logged.
+    def GetThroughput(self):
+        folder = self._prefix + '/performance_monitor/'
+        i = 0
+        d = None
+
+        # iterate over logs and keep the latest one
+        while True:
+            file = folder + str(i) + '/log.hdf5'
+            if not path.exists( file ):
+                break
+            fin = h5py.File(file,'r')
+            if 'cells_per_second' in fin.keys():
+                d = dict()
+                d['storage_bytes'] = fin['storage_bytes'][0]
+                d['cells_per_second'] = fin['cells_per_second'][:]
+            fin.close()
+            i = i + 1
+
+        return d
+
     ## Helper function parsing a 2D field.
     # @param    folder      Folder containing the chunks.
     # @param    dim         Number of cells in each dimension.
@@ -1,15 +1,6 @@
 import numpy as np
-import h5py
-
-## Generates the unique k values (combinations of i^2 + j^2 + k^2).
-# @param    dim Maximum value for i-1, j-1, k-1.
-# @return   Unique values.
-def CreateUniqueVals(dim):
-    kVals = np.array(np.fft.fftfreq(dim)*dim, dtype = 'int')
-    unique_mags = np.unique(np.unique(np.unique(kVals**2)[:, None]\
-                + np.unique(kVals**2)[None, :])[:, None]\
-                + np.unique(kVals[None, :]**2)[None, :])
-    return unique_mags
+
+from pySledgehamr.Output import Output
 
 ## Compute the effective momentum k from an index for different projection types.
 # @param    a               Index.
@@ -26,22 +17,57 @@ def IndexToK(a, N, projection_type):
         return (8. * np.sin(two_pi_n_tilde) - np.sin(2. * two_pi_n_tilde)) / 6.
     return 0.
 
-## Add unique k values to file.
-# @param    data_dir    Sledgehamr data directory.
-# @param    dim         Dimension for which to generate k values.
-def CreateSpectrumBins(data_dir, dim):
-    file = 'spectra_ks.hdf5'
-    filename = data_dir +'/' + file
-
-    archive = h5py.File(filename, 'a')
-    if str(dim) not in archive.keys():
-        vals = CreateUniqueVals(dim)
-        i = np.linspace(0, dim-1, dim)
-        archive.create_dataset(str(dim)+'_bins', data = vals)
-        archive.create_dataset(str(dim)+'_nks', data = np.array([len(vals)]))
-        archive.create_dataset(str(dim)+'_k1', data = IndexToK(np.copy(i), dim, 1))
-        archive.create_dataset(str(dim)+'_k2', data = IndexToK(np.copy(i), dim, 2))
-        archive.close()
-        print('Binning for a '+str(dim)+'^3 spectrum added!')
-    else:
-        print('Binning already exists in file.')
+## Compares two runs of the same setup that only differ in the storage
+#  precision, i.e. one built with SLEDGEHAMR_REAL = double and one with
+#  SLEDGEHAMR_REAL = float. Both runs need the performance monitor and spectra
+#  enabled. Reports the throughput on the coarse level and the largest
+#  deviation of each spectrum at the last output both runs have in common.
+# @param    double_folder   Output folder of the double precision run.
+# @param    single_folder   Output folder of the single precision run.
+# @param    names           List of spectrum names to compare.
+# @return   Dictionary containing the speedup and the relative deviation of
+#           each spectrum.
+def ComparePrecision(double_folder, single_folder, names):
+    out_d = Output(double_folder)
+    out_s = Output(single_folder)
+    res = dict()
+
+    perf_d = out_d.GetThroughput()
+    perf_s = out_s.GetThroughput()
+    if perf_d is not None and perf_s is not None:
+        res['speedup'] = perf_s['cells_per_second'][0] /\
+                         perf_d['cells_per_second'][0]
+        print('Coarse level cells/s: ' + str(perf_d['cells_per_second'][0]) +\
+              ' (' + str(perf_d['storage_bytes']) + ' bytes), ' +\
+              str(perf_s['cells_per_second'][0]) +\
+              ' (' + str(perf_s['storage_bytes']) + ' bytes), speedup ' +\
+              str(res['speedup']))
+
+    def Deviation(a, b):
+        return np.max(np.abs(b - a)) / np.max(np.abs(a))
+
+    times_d = out_d.GetTimesOfSpectra()
+    times_s = out_s.GetTimesOfSpectra()
+    if times_d is not None and times_s is not None:
+        i = min(len(times_d), len(times_s)) - 1
+        if not np.isclose(times_d[i], times_s[i]):
+            print('Warning: spectra were written at different times.')
+
+        spec_d = out_d.GetSpectrum(i, names)
+        spec_s = out_s.GetSpectrum(i, names)
+        for name in names:
+            res[name] = Deviation(spec_d[name], spec_s[name])
+            print('Spectrum ' + name + ' at t = ' + str(spec_d['t']) +\
+                  ': max. relative deviation ' + str(res[name]))
+
+    times_d = out_d.GetTimesOfGravitationalWaveSpectra()
+    times_s = out_s.GetTimesOfGravitationalWaveSpectra()
+    if times_d is not None and times_s is not None:
+        i = min(len(times_d), len(times_s)) - 1
+        gw_d = out_d.GetGravitationalWaveSpectrum(i)
+        gw_s = out_s.GetGravitationalWaveSpectrum(i)
+        res['gw_spectrum'] = Deviation(gw_d['spectrum'], gw_s['spectrum'])
+        print('Gravitational wave spectrum at t = ' + str(gw_d['t']) +\
+              ': max. relative deviation ' + str(res['gw_spectrum']))
+
+    return res
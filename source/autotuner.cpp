@@ -0,0 +1,180 @@
+#include "autotuner.h"
+#include "sledgehamr.h"
+
+namespace sledgehamr {
+
+/** @brief Reads autotuning parameters and applies the first candidate.
+ * @param   owner   Pointer to the simulation.
+ */
+Autotuner::Autotuner(Sledgehamr *owner) : sim(owner) {
+    amrex::ParmParse pp("autotune");
+    pp.query("active", active);
+    pp.query("steps_per_candidate", steps_per_candidate);
+
+    std::vector<int> tile_sizes = {8, 16, 32};
+    std::vector<int> max_grid_sizes;
+    pp.queryarr("tile_sizes", tile_sizes);
+    pp.queryarr("max_grid_sizes", max_grid_sizes);
+
+    default_tile_size = amrex::FabArrayBase::mfiter_tile_size;
+
+    const int nlevels = sim->max_level + 1;
+    tile_size.resize(nlevels, default_tile_size[1]);
+    max_grid_size_in_effect.resize(nlevels);
+    for (int lev = 0; lev < nlevels; ++lev)
+        max_grid_size_in_effect[lev] = sim->maxGridSize(lev)[0];
+
+    if (!active)
+        return;
+
+    if (!sim->performance_monitor->IsActive()) {
+        amrex::Abort("#error: autotune.active requires an active performance "
+                     "monitor, i.e. output.performance_monitor.interval > 0!");
+    }
+
+    if (steps_per_candidate < 1)
+        amrex::Abort("#error: autotune.steps_per_candidate needs to be >= 1!");
+
+    if (max_grid_sizes.empty())
+        max_grid_sizes.push_back(-1);
+
+    for (const int ts : tile_sizes) {
+        for (const int mgs : max_grid_sizes)
+            candidates.push_back({ts, mgs});
+    }
+
+    measurements.resize(nlevels);
+    start_seconds.resize(nlevels, 0.);
+    tuning = !candidates.empty();
+
+    if (tuning) {
+        for (int lev = 0; lev < nlevels; ++lev)
+            Apply(lev, candidates[0]);
+    }
+}
+
+/** @brief To be called before a level is advanced. Switches to the next
+ *         candidate at the start of a coarse step if needed and sets the tile
+ *         size of the level.
+ * @param   lev Level.
+ */
+void Autotuner::BeginStep(const int lev) {
+    if (!active)
+        return;
+
+    if (lev == 0 && tuning) {
+        if (ncoarse_steps > 0 && ncoarse_steps % steps_per_candidate == 0) {
+            if (++current == candidates.size()) {
+                Decide();
+            } else {
+                for (int l = 0; l <= sim->max_level; ++l)
+                    Apply(l, candidates[current]);
+            }
+        }
+        ++ncoarse_steps;
+    }
+
+    amrex::FabArrayBase::mfiter_tile_size = amrex::IntVect(
+        default_tile_size[0], tile_size[lev], tile_size[lev]);
+
+    if (tuning)
+        start_seconds[lev] = Seconds(lev);
+}
+
+/** @brief To be called after a level has been advanced.
+ * @param   lev     Level.
+ * @param   ncells  Number of cells on the level.
+ */
+void Autotuner::EndStep(const int lev, const long ncells) {
+    if (!active || !tuning)
+        return;
+
+    Measurement &m =
+        measurements[lev][{tile_size[lev], max_grid_size_in_effect[lev]}];
+    m.seconds += Seconds(lev) - start_seconds[lev];
+    m.ncells += ncells;
+}
+
+/** @brief Keeps track of the max grid size the levels have been created with.
+ *         To be called once the new layout of the levels exists.
+ * @param   lbase       Coarsest level that has not been changed.
+ * @param   new_finest  New finest level.
+ */
+void Autotuner::DidGlobalRegrid(const int lbase, const int new_finest) {
+    for (int lev = lbase + 1; lev <= new_finest; ++lev)
+        max_grid_size_in_effect[lev] = sim->maxGridSize(lev)[0];
+}
+
+/** @brief Sets the tile size and, for refined levels, the max grid size of a
+ *         candidate. Max grid sizes that are not a multiple of the blocking
+ *         factor are ignored.
+ * @param   lev         Level.
+ * @param   candidate   Candidate.
+ */
+void Autotuner::Apply(const int lev, const Candidate &candidate) {
+    tile_size[lev] = candidate.tile_size;
+
+    if (lev == 0 || candidate.max_grid_size <= 0 ||
+        candidate.max_grid_size % sim->blocking_factor[lev][0] != 0)
+        return;
+
+    sim->max_grid_size[lev] = amrex::IntVect(candidate.max_grid_size);
+}
+
+/** @brief Picks the fastest measured combination on each level and logs the
+ *         decision.
+ */
+void Autotuner::Decide() {
+    tuning = false;
+    amrex::Print() << std::endl << "Autotuner decisions:" << std::endl;
+
+    for (int lev = 0; lev <= sim->max_level; ++lev) {
+        // Timings differ between ranks, all ranks need to agree.
+        std::vector<double> seconds;
+        for (const auto &m : measurements[lev])
+            seconds.push_back(m.second.seconds);
+        if (!seconds.empty()) {
+            amrex::ParallelDescriptor::ReduceRealMax(seconds.data(),
+                                                     seconds.size());
+        }
+
+        int i = 0;
+        double best_cost = DBL_MAX;
+        Candidate best = {tile_size[lev], -1};
+        for (const auto &m : measurements[lev]) {
+            const double ncells = m.second.ncells;
+            const double cost = seconds[i++] / ncells;
+            if (ncells > 0 && cost < best_cost) {
+                best_cost = cost;
+                best = {m.first.first, m.first.second};
+            }
+        }
+
+        Apply(lev, best);
+        if (best_cost == DBL_MAX)
+            continue;
+
+        amrex::Print() << "  Level " << lev << ": tile size " << best.tile_size
+                       << ", max grid size " << best.max_grid_size << " ("
+                       << best_cost * 1e9 << "ns per cell update)"
+                       << std::endl;
+
+        sim->performance_monitor->Count(
+            sim->performance_monitor->idx_autotune_tile_size, best.tile_size,
+            lev);
+        sim->performance_monitor->Count(
+            sim->performance_monitor->idx_autotune_max_grid_size,
+            best.max_grid_size, lev);
+    }
+}
+
+/** @brief Total time spent in Rhs and FillPatch on a level so far.
+ * @param   lev Level.
+ */
+double Autotuner::Seconds(const int lev) {
+    PerformanceMonitor *pm = sim->performance_monitor.get();
+    return pm->timer[pm->idx_rhs + lev].GetTotalTimeSeconds() +
+           pm->timer[pm->idx_fill_patch + lev].GetTotalTimeSeconds();
+}
+
+}; // namespace sledgehamr
@@ -0,0 +1,101 @@
+#ifndef SLEDGEHAMR_AUTOTUNER_H_
+#define SLEDGEHAMR_AUTOTUNER_H_
+
+#include <map>
+
+#include <AMReX_IntVect.H>
+
+namespace sledgehamr {
+
+class Sledgehamr;
+
+/** @brief Tries different MFIter tile sizes and max grid sizes for each level
+ *         during the first couple of coarse steps and keeps the fastest
+ *         combination. Each candidate is evaluated by the time spent in the
+ *         Rhs and FillPatch timers of the performance monitor per cell
+ *         update. The tile size is applied at the start of each level's time
+ *         step, the max grid size only takes effect at the next global regrid.
+ *         Measurements are therefore attributed to the max grid size that the
+ *         layout has actually been created with.
+ */
+class Autotuner {
+  public:
+    Autotuner(Sledgehamr *owner);
+
+    void BeginStep(const int lev);
+    void EndStep(const int lev, const long ncells);
+    void DidGlobalRegrid(const int lbase, const int new_finest);
+
+    /** @brief Whether the autotuner is enabled.
+     */
+    bool active = false;
+
+  private:
+    /** @brief Tile size along the y- and z-axis and max grid size of a
+     *         candidate. A max grid size of -1 leaves it untouched.
+     */
+    struct Candidate {
+        int tile_size;
+        int max_grid_size;
+    };
+
+    /** @brief Accumulated time and cell updates.
+     */
+    struct Measurement {
+        double seconds = 0;
+        double ncells = 0;
+    };
+
+    void Apply(const int lev, const Candidate &candidate);
+    void Decide();
+    double Seconds(const int lev);
+
+    /** @brief List of candidates, evaluated in order.
+     */
+    std::vector<Candidate> candidates;
+
+    /** @brief Number of coarse steps each candidate is evaluated for.
+     */
+    int steps_per_candidate = 1;
+
+    /** @brief Currently evaluated candidate.
+     */
+    int current = 0;
+
+    /** @brief Number of coarse steps taken while tuning.
+     */
+    int ncoarse_steps = 0;
+
+    /** @brief Whether we are still evaluating candidates.
+     */
+    bool tuning = false;
+
+    /** @brief Default MFIter tile size. Its x-component is kept.
+     */
+    amrex::IntVect default_tile_size;
+
+    /** @brief Tile size currently used on each level.
+     */
+    std::vector<int> tile_size;
+
+    /** @brief Max grid size each level has been created with.
+     */
+    std::vector<int> max_grid_size_in_effect;
+
+    /** @brief Timer values at the start of the current time step of each
+     *         level.
+     */
+    std::vector<double> start_seconds;
+
+    /** @brief Measurements of each level keyed by tile size and max grid size.
+     */
+    std::vector<std::map<std::pair<int, int>, Measurement>> measurements;
+
+    /** @brief Pointer to the simulation.
+     */
+    Sledgehamr *sim;
+};
+
+}; // namespace sledgehamr
+
+#endif // SLEDGEHAMR_AUTOTUNER_H_
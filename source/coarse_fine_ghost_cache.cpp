@@ -0,0 +1,67 @@
+#include "coarse_fine_ghost_cache.h"
+
+namespace sledgehamr {
+
+/** @brief Determines all fine ghost regions not covered by the fine level
+ *         (including periodic images) and allocates the coarse patches needed
+ *         to interpolate them.
+ * @param   ba      Fine level BoxArray.
+ * @param   dm      Fine level DistributionMapping.
+ * @param   ncomp   Number of components.
+ * @param   nghost  Number of fine ghost cells.
+ * @param   fgeom   Fine level geometry.
+ * @param   ratio   Refinement ratio.
+ * @param   mapper  Interpolator to be used.
+ */
+CoarseFineGhostCache::CoarseFineGhostCache(
+    const amrex::BoxArray &ba, const amrex::DistributionMapping &dm,
+    const int ncomp, const int nghost, const amrex::Geometry &fgeom,
+    const amrex::IntVect &ratio, amrex::Interpolater *mapper)
+    : fine_ba(ba), fine_dm(dm), fine_nghost(nghost), ratio(ratio),
+      mapper(mapper) {
+    const std::vector<amrex::IntVect> pshifts =
+        fgeom.periodicity().shiftIntVect();
+
+    amrex::BoxList crse_bl;
+    amrex::Vector<int> pmap;
+    for (int i = 0; i < ba.size(); ++i) {
+        // Remove everything covered by the fine level or its periodic images.
+        amrex::BoxList uncovered(amrex::grow(ba[i], nghost));
+        for (const amrex::IntVect &iv : pshifts) {
+            amrex::BoxList remaining;
+            for (const amrex::Box &b : uncovered) {
+                amrex::BoxList c = ba.complementIn(amrex::shift(b, iv));
+                for (const amrex::Box &bc : c)
+                    remaining.push_back(amrex::shift(bc, -iv));
+            }
+            uncovered = remaining;
+        }
+
+        for (const amrex::Box &b : uncovered) {
+            fine_index.push_back(i);
+            fine_region.push_back(b);
+            crse_bl.push_back(mapper->CoarseBox(b, ratio));
+            pmap.push_back(dm[i]);
+        }
+    }
+
+    if (crse_bl.isEmpty())
+        return;
+
+    amrex::BoxArray crse_ba(crse_bl);
+    amrex::DistributionMapping crse_dm(pmap);
+    crse_patch.define(crse_ba, crse_dm, ncomp, 0);
+}
+
+/** @brief Checks whether the cache has been built for the layout of a given
+ *         MultiFab.
+ * @param   mf  Fine level MultiFab.
+ * @return  Whether the cache can be used for mf.
+ */
+bool CoarseFineGhostCache::Matches(const amrex::MultiFab &mf) const {
+    return mf.nGrow() == fine_nghost && mf.boxArray() == fine_ba &&
+           mf.DistributionMap() == fine_dm &&
+           (!crse_patch.ok() || crse_patch.nComp() >= mf.nComp());
+}
+
+}; // namespace sledgehamr
@@ -0,0 +1,102 @@
+#ifndef SLEDGEHAMR_COARSE_FINE_GHOST_CACHE_H_
+#define SLEDGEHAMR_COARSE_FINE_GHOST_CACHE_H_
+
+#include <AMReX_FillPatchUtil.H>
+#include <AMReX_Interpolater.H>
+#include <AMReX_MultiFab.H>
+
+namespace sledgehamr {
+
+/** @brief Precomputed mapping between the fine level ghost cells that are not
+ *         covered by the fine level itself and the coarse level cells needed
+ *         to interpolate them. Built once per fine level layout, i.e. once
+ *         per regrid, instead of within every call to
+ *         amrex::FillPatchTwoLevels. Also keeps the coarse patch MultiFab
+ *         allocated across calls.
+ */
+class CoarseFineGhostCache {
+  public:
+    CoarseFineGhostCache(const amrex::BoxArray &ba,
+                         const amrex::DistributionMapping &dm,
+                         const int ncomp, const int nghost,
+                         const amrex::Geometry &fgeom,
+                         const amrex::IntVect &ratio,
+                         amrex::Interpolater *mapper);
+
+    bool Matches(const amrex::MultiFab &mf) const;
+
+    /** @brief Fills all fine ghost cells not covered by the fine level with
+     *         time- and space-interpolated coarse level data. Valid cells and
+     *         ghost cells covered by the fine level are not touched.
+     * @param   mf      Fine level MultiFab. Must match the cache.
+     * @param   time    Time of fine level.
+     * @param   cmfs    Coarse level data.
+     * @param   ctime   Times of coarse level data.
+     * @param   scomp   Starting component of source.
+     * @param   dcomp   Starting component of destination.
+     * @param   ncomp   Number of components.
+     * @param   cgeom   Coarse level geometry.
+     * @param   fgeom   Fine level geometry.
+     * @param   cphysbc Coarse level boundary conditions.
+     * @param   bcs     Boundary conditions of all components.
+     */
+    template <typename BC>
+    void Fill(amrex::MultiFab &mf, const double time,
+              const amrex::Vector<amrex::MultiFab *> &cmfs,
+              const amrex::Vector<double> &ctime, const int scomp,
+              const int dcomp, const int ncomp, const amrex::Geometry &cgeom,
+              const amrex::Geometry &fgeom, BC &cphysbc,
+              const amrex::Vector<amrex::BCRec> &bcs) {
+        if (!crse_patch.ok())
+            return;
+
+        // Time interpolation of the coarse data onto the coarse patches.
+        amrex::FillPatchSingleLevel(crse_patch, time, cmfs, ctime, scomp,
+                                    scomp, ncomp, cgeom, cphysbc, scomp);
+
+        amrex::Vector<amrex::BCRec> bcr(bcs.begin() + scomp,
+                                        bcs.begin() + scomp + ncomp);
+
+        // Spatial interpolation directly into the fine ghost cells. Patches
+        // belonging to the same fine box write to disjoint regions.
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+        for (amrex::MFIter mfi(crse_patch); mfi.isValid(); ++mfi) {
+            const int i = mfi.index();
+            mapper->interp(crse_patch[mfi], scomp, mf[fine_index[i]], dcomp,
+                           ncomp, fine_region[i], ratio, cgeom, fgeom, bcr,
+                           scomp, 0, amrex::RunOn::Gpu);
+        }
+    }
+
+  private:
+    /** @brief Layout of the fine level the cache has been built for.
+     */
+    amrex::BoxArray fine_ba;
+    amrex::DistributionMapping fine_dm;
+    int fine_nghost;
+
+    /** @brief Refinement ratio between coarse and fine level.
+     */
+    amrex::IntVect ratio;
+
+    /** @brief Interpolator the coarse patches have been sized for.
+     */
+    amrex::Interpolater *mapper;
+
+    /** @brief Coarse data needed for each uncovered fine ghost region. Each
+     *         patch lives on the rank that owns the corresponding fine box.
+     */
+    amrex::MultiFab crse_patch;
+
+    /** @brief Index of the fine box each coarse patch belongs to.
+     */
+    std::vector<int> fine_index;
+
+    /** @brief Fine ghost region each coarse patch is interpolated onto.
+     */
+    std::vector<amrex::Box> fine_region;
+};
+
+}; // namespace sledgehamr
+
+#endif // SLEDGEHAMR_COARSE_FINE_GHOST_CACHE_H_
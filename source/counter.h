@@ -0,0 +1,80 @@
+#ifndef SLEDGEHAMR_COUNTER_H_
+#define SLEDGEHAMR_COUNTER_H_
+
+#include <algorithm>
+#include <string>
+
+namespace sledgehamr {
+
+/** @brief This class accumulates samples of a quantity that is not a time,
+ *         e.g. bytes moved, number of allocations or memory footprints. It is
+ *         the counterpart to the Timer class within the PerformanceMonitor.
+ */
+class Counter {
+  public:
+    /** @brief Give the counter a display name during construction.
+     *  @param  my_name Display name of counter.
+     */
+    Counter(std::string my_name) : name{my_name} {};
+
+    /** @brief Adds a sample to the counter.
+     * @param   value   Value of sample.
+     */
+    void Add(double value) {
+        total += value;
+        last = value;
+        maximum = nsamples == 0 ? value : std::max(maximum, value);
+        nsamples++;
+    }
+
+    /** @brief Returns the sum of all samples.
+     */
+    double GetTotal() const { return total; };
+
+    /** @brief Returns the mean of all samples.
+     */
+    double GetMean() const {
+        return nsamples == 0 ? 0. : total / static_cast<double>(nsamples);
+    };
+
+    /** @brief Returns the largest sample.
+     */
+    double GetMax() const { return maximum; };
+
+    /** @brief Returns the most recent sample.
+     */
+    double GetLast() const { return last; };
+
+    /** @brief Returns the number of samples.
+     */
+    long GetNumberOfSamples() const { return nsamples; };
+
+    /** @brief Returns display name of counter.
+     */
+    std::string GetName() const { return name; };
+
+  private:
+    /** @brief Sum of all samples.
+     */
+    double total = 0;
+
+    /** @brief Largest sample.
+     */
+    double maximum = 0;
+
+    /** @brief Most recent sample.
+     */
+    double last = 0;
+
+    /** @brief Number of samples.
+     */
+    long nsamples = 0;
+
+    /** @brief Display name of counter.
+     */
+    const std::string name = "Unknown Counter";
+};
+
+}; // namespace sledgehamr
+
+#endif // SLEDGEHAMR_COUNTER_H_
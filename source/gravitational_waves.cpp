@@ -4,6 +4,9 @@
 #include "sledgehamr_utils.h"
 #include <AMReX_ParallelReduce.H>
 
+#include <algorithm>
+#include <random>
+
 namespace sledgehamr {
 
 /** @brief Constructor that initialized all tensor components needed to
@@ -43,6 +46,19 @@ GravitationalWaves::GravitationalWaves(Sledgehamr *owner) {
 
     pp.query("output.gw_spectra.zero_padding_factor", zero_padding);
     pp.query("output.gw_spectra.unbinned", unbinned);
+
+    bins = std::make_unique<SpectrumBins>(
+        sim, "output.gw_spectra",
+        unbinned ? SpectrumBinScheme::ShellBins
+                 : SpectrumBinScheme::LinearBins);
+    unbinned = bins->scheme == SpectrumBinScheme::ShellBins;
+}
+
+/** @brief Builds the binning of the spectrum for the coarse level including
+ *         zero padding.
+ */
+void GravitationalWaves::BuildBins() {
+    bins->Build(sim->dimN[0] * zero_padding);
 }
 
 /** @brief Will compute the gravitional wave spectrum and write the result in
@@ -51,8 +67,6 @@ GravitationalWaves::GravitationalWaves(Sledgehamr *owner) {
  */
 void GravitationalWaves::ComputeSpectrum(
     hid_t file_id, GravitationalWavesSpectrumModifier *modifier) {
-    sim->ReadSpectrumKs();
-
     if (modifier == nullptr) {
         modifier = default_modifier.get();
     }
@@ -62,25 +76,55 @@ void GravitationalWaves::ComputeSpectrum(
     double L = sim->L * static_cast<double>(zero_padding);
 
     const LevelData &ld = sim->grid_new[lev];
-    amrex::MultiFab du_real[6];
-    amrex::MultiFab du_imag[6];
-    const int mat[3][3] = {{0, 1, 2}, {1, 3, 4}, {2, 4, 5}};
     int comps[6];
     modifier->SelectComponents(comps);
 
+    // Transform the components in storage order so consecutive ones are
+    // copied at once. slot[n] is the position of the n-th selected
+    // component within the batch.
+    int order[6] = {0, 1, 2, 3, 4, 5};
+    std::sort(order, order + 6,
+              [&](int a, int b) { return comps[a] < comps[b]; });
+    int sorted_comps[6];
+    amrex::GpuArray<int, 6> slot;
+    for (int n = 0; n < 6; ++n) {
+        sorted_comps[n] = comps[order[n]] + idx_offset;
+        slot[order[n]] = n;
+    }
+
     std::chrono::steady_clock::time_point start_time =
         std::chrono::steady_clock::now();
 
-    for (int i = 0; i < 6; ++i) {
 #ifdef OLD_FFT
-        const amrex::BoxArray &ba = ld.boxArray();
-        const amrex::DistributionMapping &dm = ld.DistributionMap();
-        du_real[i].define(ba, dm, 1, 0);
-        du_imag[i].define(ba, dm, 1, 0);
-#endif
-        utils::Fft(ld, comps[i] + idx_offset, du_real[i], du_imag[i],
-                   sim->geom[lev], false, zero_padding);
+    const amrex::BoxArray &ba = ld.boxArray();
+    const amrex::DistributionMapping &dm = ld.DistributionMap();
+    amrex::FabArray<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>> du(
+        ba, dm, 6, 0);
+    for (int n = 0; n < 6; ++n) {
+        amrex::MultiFab du_real(ba, dm, 1, 0);
+        amrex::MultiFab du_imag(ba, dm, 1, 0);
+        utils::Fft(ld, sorted_comps[n], du_real, du_imag, sim->geom[lev],
+                   false, zero_padding);
+
+        for (amrex::MFIter mfi(du); mfi.isValid(); ++mfi) {
+            const amrex::Array4<amrex::GpuComplex<amrex::Real>> &du_arr =
+                du.array(mfi);
+            const amrex::Array4<amrex::Real const> &re =
+                du_real.const_array(mfi);
+            const amrex::Array4<amrex::Real const> &im =
+                du_imag.const_array(mfi);
+            amrex::ParallelFor(mfi.fabbox(), [=] AMREX_GPU_DEVICE(
+                                                 int i, int j, int k) noexcept {
+                du_arr(i, j, k, n) =
+                    amrex::GpuComplex<amrex::Real>(re(i, j, k), im(i, j, k));
+            });
+        }
     }
+#else
+    // Transform all six components in one batch.
+    amrex::FabArray<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>> &du =
+        utils::FftBatch(ld, sorted_comps, 6, sim->geom[lev], zero_padding);
+#endif
 
     std::chrono::steady_clock::time_point end_time =
         std::chrono::steady_clock::now();
@@ -93,90 +137,58 @@ void GravitationalWaves::ComputeSpectrum(
     double dk = 2. * M_PI / L;
     double dimN6 = pow(dimN, 6);
 
-    modifier->FourierSpaceModifications(du_real, du_imag, dk, dimN);
-
-    int NTHREADS;
-    std::vector<int> ks;
-    if (unbinned) {
-        ks = sim->gw_spectrum_ks;
-        NTHREADS = 16;
-    } else {
-        for (int k = 0;
-             k <= std::sqrt(3.) / 2. * static_cast<double>(dimN) + .5; ++k) {
-            ks.push_back(k * k);
-        }
-        NTHREADS = 16;
-    }
+    modifier->FourierSpaceModifications(du, slot.data(), dk, dimN);
+
+    bins->Build(dimN);
+    ComputeIndexToK(dimN);
+
+    std::vector<double> &ks = bins->ks;
     int kmax = ks.size();
-    amrex::Gpu::AsyncArray<double> async_index_to_k(sim->index_to_k.data(),
-                                                    sim->index_to_k.size());
-    double *index_to_k = async_index_to_k.data();
+    amrex::Gpu::AsyncArray<double> async_index_to_k(index_to_k.data(),
+                                                    index_to_k.size());
+    const double *index_to_k_ptr = async_index_to_k.data();
+    amrex::Gpu::AsyncArray<int> async_sq_to_bin(bins->sq_to_bin.data(),
+                                                bins->sq_to_bin.size());
+    const int *sq_to_bin = async_sq_to_bin.data();
 
     start_time = std::chrono::steady_clock::now();
 
 #ifdef AMREX_USE_GPU
-    if (l_unbinned) {
-        amrex::Abort(
-            "Unbinned gw spectra on GPUs are currently not supported!");
-    }
-
-    bool l_unbinned = unbinned;
-
     unsigned long SpecLen = kmax;
     std::vector<double> gw_spectrum(SpecLen, 0.0);
     amrex::Gpu::DeviceVector<double> d_data(SpecLen, 0.0);
     double *const AMREX_RESTRICT dptr_data = d_data.dataPtr();
 
-    for (amrex::MFIter mfi(du_real[0], false); mfi.isValid(); ++mfi) {
+    for (amrex::MFIter mfi(du, false); mfi.isValid(); ++mfi) {
         const amrex::Box &bx = mfi.tilebox();
-
-        const amrex::Array4<double> du_real_arr[6] = {
-            du_real[0].array(mfi), du_real[1].array(mfi),
-            du_real[2].array(mfi), du_real[3].array(mfi),
-            du_real[4].array(mfi), du_real[5].array(mfi)};
-
-        const amrex::Array4<double> du_imag_arr[6] = {
-            du_imag[0].array(mfi), du_imag[1].array(mfi),
-            du_imag[2].array(mfi), du_imag[3].array(mfi),
-            du_imag[4].array(mfi), du_imag[5].array(mfi)};
+        const amrex::Array4<amrex::GpuComplex<amrex::Real> const> &du_arr =
+            du.const_array(mfi);
 
         amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int a, int b,
                                                     int c) noexcept {
+            // The k = 0 mode carries no projected power.
+            if (a == 0 && b == 0 && c == 0)
+                return;
+
             // To account of negative frequencies
             double multpl = (a == 0 || a == dimN / 2) ? 1. : 2.;
-            int abc[3] = {a, b, c};
-            double running_sum = 0;
 
             int li = a >= dimN / 2 ? a - dimN : a;
             int lj = b >= dimN / 2 ? b - dimN : b;
             int lk = c >= dimN / 2 ? c - dimN : c;
             unsigned int sq = li * li + lj * lj + lk * lk;
-            unsigned long index;
-            if (l_unbinned) {
-                // index = std::lower_bound(ks.begin(), ks.end(), sq) -
-                // ks.begin();
-            } else {
-                index =
-                    static_cast<long>(std::sqrt(static_cast<double>(sq)) + .5);
-            }
+            unsigned long index = sq_to_bin[sq];
 
-            for (int i = 0; i < 3; ++i) {
-                for (int j = 0; j < 3; ++j) {
-                    for (int l = 0; l < 3; ++l) {
-                        for (int m = 0; m < 3; ++m) {
-                            running_sum +=
-                                gw_GetLambda(i, j, l, m, abc, index_to_k) *
-                                multpl *
-                                (du_real_arr[mat[i][j]].operator()(a, b, c) *
-                                     du_real_arr[mat[l][m]].operator()(a, b,
-                                                                       c) +
-                                 du_imag_arr[mat[i][j]].operator()(a, b, c) *
-                                     du_imag_arr[mat[l][m]].operator()(a, b,
-                                                                       c));
-                        }
-                    }
-                }
+            // Accumulate in double independent of the storage precision.
+            double re[6], im[6];
+            for (int n = 0; n < 6; ++n) {
+                re[n] = du_arr(a, b, c, slot[n]).real();
+                im[n] = du_arr(a, b, c, slot[n]).imag();
             }
+            const double v[3] = {index_to_k_ptr[a], index_to_k_ptr[b],
+                                 index_to_k_ptr[c]};
+
+            double running_sum = multpl * gw_GetProjectedPower(re, im, v);
             amrex::HostDevice::Atomic::Add(&dptr_data[index],
                                            running_sum / dimN6);
         });
@@ -201,79 +213,57 @@ void GravitationalWaves::ComputeSpectrum(
 
 #else // ifdef AMREX_USE_GPU
 
-    unsigned long SpecLen = kmax * NTHREADS;
-    std::vector<double> gw_spectrum(SpecLen, 0.0);
+    SpectrumHistogram histogram(kmax);
 
-#pragma omp parallel num_threads(std::min(NTHREADS, omp_get_max_threads()))
-    for (amrex::MFIter mfi(du_real[0], true); mfi.isValid(); ++mfi) {
+#pragma omp parallel
+    for (amrex::MFIter mfi(du, true); mfi.isValid(); ++mfi) {
         const amrex::Box &bx = mfi.tilebox();
-
-        amrex::Array4<double> const &dr0 = du_real[0].array(mfi);
-        amrex::Array4<double> const &dr1 = du_real[1].array(mfi);
-        amrex::Array4<double> const &dr2 = du_real[2].array(mfi);
-        amrex::Array4<double> const &dr3 = du_real[3].array(mfi);
-        amrex::Array4<double> const &dr4 = du_real[4].array(mfi);
-        amrex::Array4<double> const &dr5 = du_real[5].array(mfi);
-        amrex::Array4<double> const &di0 = du_imag[0].array(mfi);
-        amrex::Array4<double> const &di1 = du_imag[1].array(mfi);
-        amrex::Array4<double> const &di2 = du_imag[2].array(mfi);
-        amrex::Array4<double> const &di3 = du_imag[3].array(mfi);
-        amrex::Array4<double> const &di4 = du_imag[4].array(mfi);
-        amrex::Array4<double> const &di5 = du_imag[5].array(mfi);
-
-        const amrex::Array4<double> *du_real_arr[6] = {
-            std::addressof(dr0), std::addressof(dr1), std::addressof(dr2),
-            std::addressof(dr3), std::addressof(dr4), std::addressof(dr5)};
-        const amrex::Array4<double> *du_imag_arr[6] = {
-            std::addressof(di0), std::addressof(di1), std::addressof(di2),
-            std::addressof(di3), std::addressof(di4), std::addressof(di5)};
+        double *hist = histogram.ThreadLocal();
+        const amrex::Array4<amrex::GpuComplex<amrex::Real> const> &du_arr =
+            du.const_array(mfi);
 
         const amrex::Dim3 lo = amrex::lbound(bx);
         const amrex::Dim3 hi = amrex::ubound(bx);
 
+        // Projected power along a pencil. Computed with SIMD first and
+        // scattered into the histogram afterwards since different lanes may
+        // hit the same bin.
+        std::vector<double> pencil(bx.length(0));
+        double *AMREX_RESTRICT power = pencil.data();
+
         for (int c = lo.z; c <= hi.z; ++c) {
             for (int b = lo.y; b <= hi.y; ++b) {
+                const double vb = index_to_k_ptr[b];
+                const double vc = index_to_k_ptr[c];
+
                 AMREX_PRAGMA_SIMD
                 for (int a = lo.x; a <= hi.x; ++a) {
                     // To account of negative frequencies
-                    double multpl = (a == 0 || a == dimN / 2) ? 1. : 2.;
-                    int abc[3] = {a, b, c};
-                    double running_sum = 0;
-
-                    int li = a >= dimN / 2 ? a - dimN : a;
-                    int lj = b >= dimN / 2 ? b - dimN : b;
-                    int lk = c >= dimN / 2 ? c - dimN : c;
-                    unsigned int sq = li * li + lj * lj + lk * lk;
-                    unsigned long index;
-                    if (unbinned) {
-                        index = std::lower_bound(ks.begin(), ks.end(), sq) -
-                                ks.begin() + omp_get_thread_num() * kmax;
-                    } else {
-                        index = static_cast<long>(
-                            std::sqrt(static_cast<double>(sq)) + .5);
+                    const double multpl =
+                        (a == 0 || a == dimN / 2) ? 1. : 2.;
+
+                    // Accumulate in double independent of the storage
+                    // precision.
+                    double re[6], im[6];
+                    for (int n = 0; n < 6; ++n) {
+                        re[n] = du_arr(a, b, c, slot[n]).real();
+                        im[n] = du_arr(a, b, c, slot[n]).imag();
                     }
+                    const double v[3] = {index_to_k_ptr[a], vb, vc};
 
-                    for (int i = 0; i < 3; ++i) {
-                        for (int j = 0; j < 3; ++j) {
-                            for (int l = 0; l < 3; ++l) {
-                                for (int m = 0; m < 3; ++m) {
-                                    running_sum +=
-                                        gw_GetLambda(i, j, l, m, abc,
-                                                     index_to_k) *
-                                        multpl *
-                                        (du_real_arr[mat[i][j]]->operator()(
-                                             a, b, c) *
-                                             du_real_arr[mat[l][m]]->operator()(
-                                                 a, b, c) +
-                                         du_imag_arr[mat[i][j]]->operator()(
-                                             a, b, c) *
-                                             du_imag_arr[mat[l][m]]->operator()(
-                                                 a, b, c));
-                                }
-                            }
-                        }
-                    }
-                    gw_spectrum[index] += running_sum;
+                    power[a - lo.x] = multpl * gw_GetProjectedPower(re, im, v);
+                }
+
+                // The k = 0 mode carries no projected power.
+                if (lo.x == 0 && b == 0 && c == 0)
+                    power[0] = 0.;
+
+                const int lj = b >= dimN / 2 ? b - dimN : b;
+                const int lk = c >= dimN / 2 ? c - dimN : c;
+                const int sq_jk = lj * lj + lk * lk;
+                for (int a = lo.x; a <= hi.x; ++a) {
+                    const int li = a >= dimN / 2 ? a - dimN : a;
+                    hist[sq_to_bin[li * li + sq_jk]] += power[a - lo.x];
                 }
             }
         }
@@ -287,11 +277,9 @@ void GravitationalWaves::ComputeSpectrum(
     // amrex::Print() << "Sum: " << duration_ms << std::endl;
     start_time = std::chrono::steady_clock::now();
 
-    for (int a = 1; a < NTHREADS; ++a) {
-        for (int c = 0; c < kmax; ++c) {
-            gw_spectrum[c] += gw_spectrum[a * kmax + c];
-        }
-    }
+    histogram.Reduce();
+    std::vector<double> gw_spectrum(histogram.Result(),
+                                    histogram.Result() + kmax);
 
     amrex::ParallelDescriptor::ReduceRealSum(
         &(gw_spectrum[0]), kmax,
@@ -321,4 +309,121 @@ void GravitationalWaves::ComputeSpectrum(
     }
 }
 
+/** @brief Compares gw_GetProjectedPower against the explicit sum of
+ *         gw_GetLambda over all 81 index combinations for random tensors and
+ *         momenta drawn from a fixed seed, and times both.
+ * @return Largest deviation relative to the squared norm of the tensors.
+ */
+double GravitationalWaves::CheckProjection() {
+    const int dim = 64;
+    const int nsamples = 1 << 14;
+    const int nrepeat = 16;
+
+    std::vector<double> index_to_k(dim);
+    for (int a = 0; a < dim; ++a)
+        index_to_k[a] = 2. * std::sin(M_PI * a / dim);
+
+    std::mt19937 rng(20241016);
+    std::uniform_real_distribution<double> val_dist(-1., 1.);
+    std::uniform_int_distribution<int> index_dist(0, dim - 1);
+
+    std::vector<double> re(6 * nsamples), im(6 * nsamples);
+    std::vector<int> abc(3 * nsamples);
+    for (int s = 0; s < nsamples; ++s) {
+        for (int n = 0; n < 6; ++n) {
+            re[6 * s + n] = val_dist(rng);
+            im[6 * s + n] = val_dist(rng);
+        }
+        do {
+            for (int d = 0; d < 3; ++d)
+                abc[3 * s + d] = index_dist(rng);
+        } while (abc[3 * s] == 0 && abc[3 * s + 1] == 0 && abc[3 * s + 2] == 0);
+    }
+
+    // Component of du_ij in the order xx, xy, xz, yy, yz, zz.
+    const int comp[3][3] = {{0, 1, 2}, {1, 3, 4}, {2, 4, 5}};
+
+    std::vector<double> reference(nsamples), contraction(nsamples);
+    std::chrono::steady_clock::time_point start_time =
+        std::chrono::steady_clock::now();
+    for (int r = 0; r < nrepeat; ++r) {
+        for (int s = 0; s < nsamples; ++s) {
+            const double *x = &re[6 * s];
+            const double *y = &im[6 * s];
+            double sum = 0.;
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    for (int l = 0; l < 3; ++l) {
+                        for (int m = 0; m < 3; ++m) {
+                            sum += gw_GetLambda(i, j, l, m, &abc[3 * s],
+                                                index_to_k.data()) *
+                                   (x[comp[i][j]] * x[comp[l][m]] +
+                                    y[comp[i][j]] * y[comp[l][m]]);
+                        }
+                    }
+                }
+            }
+            reference[s] += sum;
+        }
+    }
+    const double t_reference = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_time).count();
+
+    start_time = std::chrono::steady_clock::now();
+    for (int r = 0; r < nrepeat; ++r) {
+        for (int s = 0; s < nsamples; ++s) {
+            const double v[3] = {index_to_k[abc[3 * s]],
+                                 index_to_k[abc[3 * s + 1]],
+                                 index_to_k[abc[3 * s + 2]]};
+            contraction[s] +=
+                gw_GetProjectedPower(&re[6 * s], &im[6 * s], v);
+        }
+    }
+    const double t_contraction = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_time).count();
+
+    double max_dev = 0.;
+    for (int s = 0; s < nsamples; ++s) {
+        double norm = 0.;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                norm += re[6 * s + comp[i][j]] * re[6 * s + comp[i][j]] +
+                        im[6 * s + comp[i][j]] * im[6 * s + comp[i][j]];
+            }
+        }
+        max_dev = std::max(max_dev, std::abs(contraction[s] - reference[s]) /
+                                        (nrepeat * norm));
+    }
+
+    amrex::Print() << "GW projection: max. relative deviation " << max_dev
+                   << ", 81-term sum " << t_reference << "s, contraction "
+                   << t_contraction << "s, speedup "
+                   << t_reference / t_contraction << " (" << nsamples
+                   << " modes, " << nrepeat << " repetitions)" << std::endl;
+
+    return max_dev;
+}
+
+/** @brief Computes the effective momentum of each index for the selected
+ *         projection type, i.e. the eigenvalue of the gradient stencil.
+ * @param   dim Number of cells in each direction, including zero padding.
+ */
+void GravitationalWaves::ComputeIndexToK(const int dim) {
+    if (index_to_k.size() == dim)
+        return;
+
+    if (projection_type != 2) {
+        amrex::Abort("#error: No effective momentum known for "
+                     "output.gw_spectra.projection_type = " +
+                     std::to_string(projection_type));
+    }
+
+    index_to_k.resize(dim);
+    for (int a = 0; a < dim; ++a) {
+        const int n = a >= dim / 2 ? a - dim : a;
+        const double x = 2. * M_PI / static_cast<double>(dim) * n;
+        index_to_k[a] = (8. * std::sin(x) - std::sin(2. * x)) / 6.;
+    }
+}
+
 }; // namespace sledgehamr
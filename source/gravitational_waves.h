@@ -3,7 +3,10 @@
 
 #include <hdf5.h>
 
+#include <AMReX_GpuComplex.H>
+
 #include "sledgehamr.h"
+#include "spectrum_bins.h"
 
 namespace sledgehamr {
 
@@ -21,6 +24,9 @@ class GravitationalWaves {
     ComputeSpectrum(hid_t file_id,
                     GravitationalWavesSpectrumModifier *modifier = nullptr);
 
+    static double CheckProjection();
+    void BuildBins();
+
     int GetProjectionType() const { return projection_type; }
     int GetZeroPadding() const { return zero_padding; }
 
@@ -43,6 +49,8 @@ class GravitationalWaves {
     };
 
   private:
+    void ComputeIndexToK(const int dim);
+
     /** @brief Pointer to the simulation.
      */
     Sledgehamr *sim;
@@ -73,6 +81,15 @@ class GravitationalWaves {
 
     bool unbinned = true;
 
+    /** @brief Binning of the spectrum. Defaults to unique |k|^2 shells if
+     *         unbinned and to linear bins of unit width otherwise.
+     */
+    std::unique_ptr<SpectrumBins> bins;
+
+    /** @brief Effective momentum of each index for the given projection type.
+     */
+    std::vector<double> index_to_k;
+
     std::unique_ptr<GravitationalWavesSpectrumModifier> default_modifier;
 };
 
@@ -86,9 +103,17 @@ struct GravitationalWavesSpectrumModifier {
         components[5] = GravitationalWaves::Gw::du_zz;
     };
 
-    virtual void FourierSpaceModifications(amrex::MultiFab du_real[6],
-                                           amrex::MultiFab du_imag[6],
-                                           const double dk, const int dimN) {};
+    /** @brief Modifies the Fourier transformed components in place before
+     *         they are projected.
+     * @param   du      Complex FFT of the selected components.
+     * @param   slot    Component of du that holds the n-th selected
+     *                  component.
+     * @param   dk      Momentum spacing.
+     * @param   dimN    Number of (zero padded) cells per dimension.
+     */
+    virtual void FourierSpaceModifications(
+        amrex::FabArray<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>> &du,
+        const int slot[6], const double dk, const int dimN) {};
 };
 
 /** @brief Projects all indicies.
@@ -98,8 +123,8 @@ struct GravitationalWavesSpectrumModifier {
  * @param   N   Total index length.
  * @return Projected value.
  */
-AMREX_GPU_DEVICE AMREX_FORCE_INLINE double gw_GetProjection(int i, int j,
-                                                            double abc[3]) {
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE double
+gw_GetProjection(int i, int j, double abc[3]) {
     double norm = abc[0] * abc[0] + abc[1] * abc[1] + abc[2] * abc[2];
     int l = amrex::min(i, j);
     int m = amrex::max(i, j);
@@ -109,7 +134,8 @@ AMREX_GPU_DEVICE AMREX_FORCE_INLINE double gw_GetProjection(int i, int j,
     return static_cast<double>(l == m) - proj / norm;
 }
 
-/** @brief Computes lambda from projections.
+/** @brief Computes lambda from projections. Only used as a reference for
+ *         gw_GetProjectedPower by GravitationalWaves::CheckProjection.
  * @param   i   i-index.
  * @param   j   j-index.
  * @param   l   l-index.
@@ -118,7 +144,7 @@ AMREX_GPU_DEVICE AMREX_FORCE_INLINE double gw_GetProjection(int i, int j,
  * @param   N   Total index length.
  * @return Lambda
  */
-AMREX_GPU_DEVICE AMREX_FORCE_INLINE double
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE double
 gw_GetLambda(int i, int j, int l, int m, int abc[3], const double *index_to_k) {
     if (abc[0] == 0 && abc[1] == 0 && abc[2] == 0)
         return 0.;
@@ -132,6 +158,50 @@ gw_GetLambda(int i, int j, int l, int m, int abc[3], const double *index_to_k) {
            gw_GetProjection(i, j, abc_d) * gw_GetProjection(l, m, abc_d) / 2.;
 }
 
+/** @brief Contracts the TT-projector with a real symmetric tensor X, i.e.
+ *         computes sum_{ijlm} Lambda_{ij,lm} X_ij X_lm. With P = 1 - n n^T this
+ *         reduces to Tr(X^2) - 2|Xn|^2 + (nXn)^2 - (Tr(X) - nXn)^2 / 2, such
+ *         that only the 6 independent components of X are needed.
+ * @param   x   Components xx, xy, xz, yy, yz, zz of X.
+ * @param   v   Momentum vector, does not need to be normalized.
+ * @return Contraction.
+ */
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE double
+gw_ContractLambda(const double x[6], const double v[3]) {
+    const double inv_norm = 1. / (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+
+    // X v
+    const double xv0 = x[0] * v[0] + x[1] * v[1] + x[2] * v[2];
+    const double xv1 = x[1] * v[0] + x[3] * v[1] + x[4] * v[2];
+    const double xv2 = x[2] * v[0] + x[4] * v[1] + x[5] * v[2];
+
+    const double tr_x2 = x[0] * x[0] + x[3] * x[3] + x[5] * x[5] +
+                         2. * (x[1] * x[1] + x[2] * x[2] + x[4] * x[4]);
+    const double xn2 = (xv0 * xv0 + xv1 * xv1 + xv2 * xv2) * inv_norm;
+    const double nxn = (v[0] * xv0 + v[1] * xv1 + v[2] * xv2) * inv_norm;
+    const double tr_px = x[0] + x[3] + x[5] - nxn;
+
+    return tr_x2 - 2. * xn2 + nxn * nxn - .5 * tr_px * tr_px;
+}
+
+/** @brief Computes sum_{ijlm} Lambda_{ij,lm} Re(du_ij du_lm^*) at a single
+ *         k-mode. Equivalent to summing gw_GetLambda over all 81 index
+ *         combinations but exploits the symmetry of du_ij. Contains no
+ *         branches such that it can be vectorized along a pencil. The k = 0
+ *         mode is not defined and needs to be handled by the caller.
+ * @param   re  Real parts of du_xx, du_xy, du_xz, du_yy, du_yz, du_zz.
+ * @param   im  Imaginary parts of the same components.
+ * @param   v   Momentum vector, does not need to be normalized.
+ * @return Projected power.
+ */
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE double
+gw_GetProjectedPower(const double re[6], const double im[6],
+                     const double v[3]) {
+    // Real and imaginary parts decouple as Lambda is real and symmetric under
+    // (ij) <-> (lm).
+    return gw_ContractLambda(re, v) + gw_ContractLambda(im, v);
+}
+
 }; // namespace sledgehamr
 
 #endif // SLEDGEHAMR_GRAVITATIONAL_WAVES_H_
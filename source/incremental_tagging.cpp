@@ -0,0 +1,224 @@
+#include "incremental_tagging.h"
+#include "sledgehamr.h"
+
+namespace sledgehamr {
+
+/** @brief Reads incremental tagging parameters.
+ * @param   owner   Pointer to the simulation.
+ */
+IncrementalTagging::IncrementalTagging(Sledgehamr *owner) : sim(owner) {
+    amrex::ParmParse pp("amr");
+    pp.query("incremental_tagging", active);
+    pp.query("incremental_tagging_speed", speed);
+    pp.query("full_tagging_interval", full_sweep_interval);
+    pp.query("check_incremental_tagging", check);
+
+    if (speed <= 0) {
+        amrex::Abort("#error: amr.incremental_tagging_speed needs to be "
+                     "positive!");
+    }
+
+    const int nlevels = sim->max_level + 1;
+    footprint.resize(nlevels);
+    layout.resize(nlevels);
+    current_layout.resize(nlevels);
+    last_time.resize(nlevels, 0.);
+    sweeps_since_full.resize(nlevels, 0);
+    valid.resize(nlevels, false);
+    predictable.resize(nlevels, false);
+    band.resize(nlevels, 0);
+}
+
+/** @brief Prepares a tagging sweep of a level.
+ * @param   lev     Level.
+ * @param   time    Current time.
+ * @param   ba      BoxArray of the level.
+ * @return  Whether the sweep can skip tiles that are known to remain untagged.
+ */
+bool IncrementalTagging::Begin(const int lev, const double time,
+                               const amrex::BoxArray &ba) {
+    current_layout[lev] = ba;
+    predictable[lev] = active && valid[lev] && time > last_time[lev];
+
+    if (!predictable[lev])
+        return false;
+
+    // Features propagate by at most speed * elapsed time. The ghost cells
+    // account for the stencils used by the tagging criteria.
+    const double elapsed = time - last_time[lev];
+    band[lev] = static_cast<int>(std::ceil(speed * elapsed / sim->dx[lev])) +
+                sim->nghost;
+
+    return sweeps_since_full[lev] < full_sweep_interval;
+}
+
+/** @brief Determines whether a tile needs to be re-evaluated, i.e. whether it
+ *         did not exist during the previous sweep or is close to previous tags
+ *         or to the level border. Assumes periodic boundary conditions.
+ * @param   lev         Level.
+ * @param   tilebox     Tile.
+ * @return  Whether the tile may contain tags.
+ */
+bool IncrementalTagging::NeedsTagging(const int lev,
+                                      const amrex::Box &tilebox) const {
+    if (!predictable[lev])
+        return true;
+
+    // Newly added boxes have never been tagged on this level.
+    if (!layout[lev].contains(tilebox))
+        return true;
+
+    const amrex::Box region = amrex::grow(tilebox, band[lev]);
+    const amrex::Box &domain = sim->geom[lev].Domain();
+    const std::vector<amrex::IntVect> shifts =
+        sim->geom[lev].periodicity().shiftIntVect();
+
+    for (const amrex::IntVect &shift : shifts) {
+        const amrex::Box shifted = region + shift;
+
+        if (footprint[lev].intersects(shifted))
+            return true;
+
+        // Cells near the level border can be tagged by features entering
+        // from the coarser level.
+        const amrex::Box piece = shifted & domain;
+        if (lev > 0 && piece.ok() && !current_layout[lev].contains(piece))
+            return true;
+    }
+
+    return false;
+}
+
+/** @brief Stores where tags have been found during a tagging sweep. During
+ *         a full sweep it also checks whether an incremental sweep would have
+ *         missed any tags.
+ * @param   lev                 Level.
+ * @param   time                Current time.
+ * @param   state               State the tags have been computed from.
+ * @param   tags                Tags.
+ * @param   incremental_sweep   Whether tiles have been skipped.
+ * @param   ncells_skipped      Number of cells skipped on this rank.
+ */
+void IncrementalTagging::Finish(const int lev, const double time,
+                                const amrex::MultiFab &state,
+                                const amrex::TagBoxArray &tags,
+                                const bool incremental_sweep,
+                                long ncells_skipped) {
+    if (!active)
+        return;
+
+    amrex::Vector<amrex::Box> local_footprint;
+    long ncells_missed = 0;
+
+#pragma omp parallel reduction(+ : ncells_missed)
+    {
+        amrex::Vector<amrex::Box> my_footprint;
+
+        for (amrex::MFIter mfi(state, true); mfi.isValid(); ++mfi) {
+            const amrex::Box &tilebox = mfi.tilebox();
+            const bool needs_tagging = NeedsTagging(lev, tilebox);
+            if (incremental_sweep && !needs_tagging)
+                continue;
+
+            long ntags = 0;
+            const amrex::Box bbox =
+                Footprint(tags.const_array(mfi), tilebox, ntags);
+            if (!bbox.ok())
+                continue;
+
+            my_footprint.push_back(bbox);
+            if (!needs_tagging)
+                ncells_missed += ntags;
+        }
+
+#pragma omp critical
+        local_footprint.insert(local_footprint.end(), my_footprint.begin(),
+                               my_footprint.end());
+    }
+
+    amrex::AllGatherBoxes(local_footprint);
+    amrex::BoxList bl(std::move(local_footprint));
+    footprint[lev] = amrex::BoxArray(std::move(bl));
+    layout[lev] = state.boxArray();
+
+    sweeps_since_full[lev] = incremental_sweep ? sweeps_since_full[lev] + 1 : 0;
+    last_time[lev] = time;
+    valid[lev] = true;
+
+    amrex::ParallelDescriptor::ReduceLongSum(ncells_skipped, 0);
+    amrex::ParallelDescriptor::ReduceLongSum(ncells_missed, 0);
+
+    const double ncells = state.boxArray().numPts();
+    sim->performance_monitor->Count(
+        sim->performance_monitor->idx_tagging_cells_skipped,
+        static_cast<double>(ncells_skipped) / ncells, lev);
+
+    if (ncells_skipped > 0) {
+        amrex::Print() << "    Skipped " << ncells_skipped
+                       << " cells far from previous tags." << std::endl;
+    }
+
+    if (ncells_missed > 0) {
+        amrex::Print() << "    Warning: Incremental tagging would have missed "
+                       << ncells_missed << " tagged cells on level " << lev
+                       << ". Consider increasing "
+                       << "amr.incremental_tagging_speed." << std::endl;
+    }
+
+    sim->performance_monitor->Count(
+        sim->performance_monitor->idx_tagging_cells_missed, ncells_missed, lev);
+}
+
+/** @brief Forgets the previous sweep of a level, e.g. because the level has
+ *         been deleted.
+ * @param   lev Level.
+ */
+void IncrementalTagging::Invalidate(const int lev) {
+    if (lev < 0 || lev >= static_cast<int>(valid.size()))
+        return;
+
+    valid[lev] = false;
+    predictable[lev] = false;
+    sweeps_since_full[lev] = 0;
+    footprint[lev] = amrex::BoxArray();
+    layout[lev] = amrex::BoxArray();
+}
+
+/** @brief Computes the bounding box of all tags set by a tile. This includes
+ *         the truncation error tags that spill over by one cell in the upper
+ *         direction.
+ * @param   tag_arr Tags.
+ * @param   tilebox Tile.
+ * @param   ntags   Number of tags within the tile.
+ * @return  Bounding box. Empty if no tags have been set.
+ */
+amrex::Box
+IncrementalTagging::Footprint(const amrex::Array4<char const> &tag_arr,
+                              const amrex::Box &tilebox, long &ntags) {
+    const amrex::Box region =
+        amrex::Box(tilebox.smallEnd(), tilebox.bigEnd() + 1) &
+        amrex::Box(tag_arr);
+    const amrex::Dim3 lo = amrex::lbound(region);
+    const amrex::Dim3 hi = amrex::ubound(region);
+    amrex::IntVect bb_lo(hi.x + 1, hi.y + 1, hi.z + 1);
+    amrex::IntVect bb_hi(lo.x - 1, lo.y - 1, lo.z - 1);
+
+    for (int k = lo.z; k <= hi.z; ++k) {
+        for (int j = lo.y; j <= hi.y; ++j) {
+            for (int i = lo.x; i <= hi.x; ++i) {
+                if (tag_arr(i, j, k) != amrex::TagBox::SET)
+                    continue;
+
+                if (tilebox.contains(i, j, k))
+                    ntags++;
+
+                bb_lo.min(amrex::IntVect(i, j, k));
+                bb_hi.max(amrex::IntVect(i, j, k));
+            }
+        }
+    }
+
+    return amrex::Box(bb_lo, bb_hi);
+}
+
+}; // namespace sledgehamr
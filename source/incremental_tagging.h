@@ -0,0 +1,96 @@
+#ifndef SLEDGEHAMR_INCREMENTAL_TAGGING_H_
+#define SLEDGEHAMR_INCREMENTAL_TAGGING_H_
+
+#include <AMReX_BoxArray.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_TagBox.H>
+
+namespace sledgehamr {
+
+class Sledgehamr;
+
+/** @brief Keeps track of where tags have been found during the previous
+ *         tagging sweep of each level such that the next sweep only needs to
+ *         re-evaluate tiles that are close to previous tags or to the level
+ *         border. Tags can only appear where features that trigger them
+ *         have been able to propagate to since the last sweep. All other
+ *         tiles are known to remain untagged and are skipped. A full sweep
+ *         is enforced every couple of sweeps as a safety net, e.g. for
+ *         time-dependent tagging criteria.
+ */
+class IncrementalTagging {
+  public:
+    IncrementalTagging(Sledgehamr *owner);
+
+    bool Begin(const int lev, const double time, const amrex::BoxArray &ba);
+    bool NeedsTagging(const int lev, const amrex::Box &tilebox) const;
+    void Finish(const int lev, const double time, const amrex::MultiFab &state,
+                const amrex::TagBoxArray &tags, const bool incremental_sweep,
+                long ncells_skipped);
+    void Invalidate(const int lev);
+
+    /** @brief Whether incremental tagging is enabled.
+     */
+    bool active = false;
+
+    /** @brief Whether every incremental sweep is repeated as a full sweep and
+     *         the tag sets are compared.
+     */
+    bool check = false;
+
+  private:
+    static amrex::Box Footprint(const amrex::Array4<char const> &tag_arr,
+                                const amrex::Box &tilebox, long &ntags);
+
+    /** @brief Number of sweeps after which a full sweep is enforced.
+     */
+    int full_sweep_interval = 10;
+
+    /** @brief Maximum speed in units of the speed of light at which features
+     *         that trigger tags propagate, including a safety factor.
+     */
+    double speed = 2.;
+
+    /** @brief Bounding boxes of the tags found on each tile during the
+     *         previous sweep of each level.
+     */
+    std::vector<amrex::BoxArray> footprint;
+
+    /** @brief BoxArray of each level during the previous sweep.
+     */
+    std::vector<amrex::BoxArray> layout;
+
+    /** @brief Time of the previous sweep of each level.
+     */
+    std::vector<double> last_time;
+
+    /** @brief Number of incremental sweeps since the last full sweep.
+     */
+    std::vector<int> sweeps_since_full;
+
+    /** @brief Whether the previous sweep of a level can be relied upon.
+     */
+    std::vector<bool> valid;
+
+    /** @brief Whether the previous sweep of a level can be used to predict
+     *         which tiles of the current sweep will remain untagged.
+     */
+    std::vector<bool> predictable;
+
+    /** @brief Distance in cells around previous tags and the level border
+     *         within which tiles are re-evaluated during the current sweep.
+     */
+    std::vector<int> band;
+
+    /** @brief BoxArray of each level during the current sweep.
+     */
+    std::vector<amrex::BoxArray> current_layout;
+
+    /** @brief Pointer to the simulation.
+     */
+    Sledgehamr *sim;
+};
+
+}; // namespace sledgehamr
+
+#endif // SLEDGEHAMR_INCREMENTAL_TAGGING_H_
@@ -3,6 +3,48 @@
 
 namespace sledgehamr {
 
+/** @brief Reads parameters shared by all integrators.
+ * @param   owner   Pointer to the simulation.
+ */
+Integrator::Integrator(Sledgehamr *owner) : sim(owner) {
+    amrex::ParmParse pp("integrator");
+    pp.query("overlap_communication", overlap_communication);
+    stencil_width = sim->nghost;
+}
+
+/** @brief Reads temporal blocking parameters and raises the number of ghost
+ *         cells of blocked levels such that all Rhs evaluations of a time step
+ *         can be computed on a tile without intermediate ghost cell
+ *         exchanges. To be called by the constructor of integrators that
+ *         support temporal blocking.
+ * @param   nrhs    Number of Rhs evaluations per time step.
+ */
+void Integrator::SetUpTemporalBlocking(const int nrhs) {
+    amrex::ParmParse pp("integrator");
+    pp.query("temporal_blocking", temporal_blocking);
+    pp.query("temporal_blocking_min_level", temporal_blocking_min_level);
+
+    if (!temporal_blocking)
+        return;
+
+    // Only blocked levels get the wider halo, sim->nghost keeps the stencil
+    // width.
+    sim->blocked_nghost = nrhs * stencil_width;
+    sim->blocked_min_level = std::max(0, temporal_blocking_min_level);
+    amrex::Print() << "Temporal blocking enabled for levels >= "
+                   << temporal_blocking_min_level << ". Increasing number "
+                   << "of ghost cells of these levels from " << stencil_width
+                   << " to " << sim->blocked_nghost << "." << std::endl;
+
+    for (int lev = sim->blocked_min_level; lev <= sim->max_level; ++lev) {
+        if (sim->blocked_nghost >= sim->blockingFactor(lev)[0]) {
+            amrex::Abort("#error: Temporal blocking needs " +
+                         std::to_string(sim->blocked_nghost) +
+                         " ghost cells which has to be < amr.blocking_factor!");
+        }
+    }
+}
+
 /** @brief Wrapper function to advance a level by one time step. This function
  *         selects and swaps data appropriately in particular regarding to the
  *         shadow level.
@@ -10,8 +52,17 @@ namespace sledgehamr {
  */
 void Integrator::Advance(const int lev) {
     if (lev >= 0) {
-        sim->grid_old[lev].contains_truncation_errors = false;
+        sim->grid_old[lev].ClearTruncationErrors();
         std::swap(sim->grid_old[lev], sim->grid_new[lev]);
+
+        // The old state may have been released after the previous time step.
+        // In that case the swap left grid_new empty and we allocate it here.
+        if (!sim->grid_new[lev].isDefined()) {
+            sim->grid_new[lev].define(sim->grid_old[lev].boxArray(),
+                                      sim->grid_old[lev].DistributionMap(),
+                                      sim->grid_old[lev].nComp(),
+                                      sim->grid_old[lev].nGrow());
+        }
     }
 
     const double dt = lev < 0 ? sim->dt[0] * 2. : sim->dt[lev];
@@ -30,6 +81,62 @@ void Integrator::Advance(const int lev) {
     }
 }
 
+/** @brief Fills ghost cells of an intermediate state and computes its Rhs.
+ *         If overlap_communication is enabled the Rhs of interior cells is
+ *         computed while ghost cells are being exchanged, followed by the
+ *         remaining boundary cells once the exchange is complete.
+ * @param   rhs_mf      Container to fill the Rhs with.
+ * @param   state_mf    Intermediate state.
+ * @param   time        Time of intermediate state.
+ * @param   lev         Current level.
+ * @param   dt          Time step size.
+ * @param   dx          Grid spacing.
+ */
+void Integrator::FillIntermediatePatchAndRhs(RhsMultiFab &rhs_mf,
+                                             amrex::MultiFab &state_mf,
+                                             const double time, const int lev,
+                                             const double dt, const double dx) {
+    if (!overlap_communication) {
+        sim->level_synchronizer->FillIntermediatePatch(lev, time, state_mf);
+        sim->FillRhs(rhs_mf, state_mf, time, lev, dt, dx);
+        return;
+    }
+
+    sim->level_synchronizer->FillIntermediatePatchBegin(lev, time, state_mf);
+    sim->FillRhs(rhs_mf, state_mf, time, lev, dt, dx,
+                 utils::RhsRegion::InteriorCells);
+    sim->level_synchronizer->FillIntermediatePatchEnd(lev, time, state_mf);
+    sim->FillRhs(rhs_mf, state_mf, time, lev, dt, dx,
+                 utils::RhsRegion::BoundaryCells);
+}
+
+/** @brief Same as FillIntermediatePatchAndRhs but adds the Rhs to rhs_mf,
+ *         rhs_mf = weight*rhs_mf + rhs.
+ * @param   rhs_mf      Container to add the Rhs to.
+ * @param   state_mf    Intermediate state.
+ * @param   time        Time of intermediate state.
+ * @param   lev         Current level.
+ * @param   dt          Time step size.
+ * @param   dx          Grid spacing.
+ * @param   weight      Relative weight between values of rhs_mf and rhs.
+ */
+void Integrator::FillIntermediatePatchAndAddRhs(
+    RhsMultiFab &rhs_mf, amrex::MultiFab &state_mf, const double time,
+    const int lev, const double dt, const double dx, const double weight) {
+    if (!overlap_communication) {
+        sim->level_synchronizer->FillIntermediatePatch(lev, time, state_mf);
+        sim->FillAddRhs(rhs_mf, state_mf, time, lev, dt, dx, weight);
+        return;
+    }
+
+    sim->level_synchronizer->FillIntermediatePatchBegin(lev, time, state_mf);
+    sim->FillAddRhs(rhs_mf, state_mf, time, lev, dt, dx, weight,
+                    utils::RhsRegion::InteriorCells);
+    sim->level_synchronizer->FillIntermediatePatchEnd(lev, time, state_mf);
+    sim->FillAddRhs(rhs_mf, state_mf, time, lev, dt, dx, weight,
+                    utils::RhsRegion::BoundaryCells);
+}
+
 /** @brief Creates a display name containing the selected integrator type.
  * @param   type    Integrator type.
  * @return Display name.
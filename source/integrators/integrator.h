@@ -29,11 +29,18 @@ class Sledgehamr;
  */
 class Integrator {
   public:
-    Integrator(Sledgehamr *owner) : sim(owner){};
+    Integrator(Sledgehamr *owner);
     virtual void Advance(const int lev);
     static std::string Name(IntegratorType type);
     static void DebugMessage(amrex::MultiFab &mf, std::string msg);
 
+    /** @brief Whether the integration scheme reads the state of the previous
+     *         time step, i.e. sim->grid_old, in between two time steps of a
+     *         level. Multi-step schemes need to override this such that
+     *         grid_old is never released.
+     */
+    virtual bool NeedsOldState() const { return false; }
+
   protected:
     /** @brief Purely virtual function that advances one level by one time step
      *         using an integration scheme of your choice.
@@ -46,9 +53,80 @@ class Integrator {
     virtual void Integrate(LevelData &mf_old, LevelData &mf_new, const int lev,
                            const double dt, const double dx) = 0;
 
+    void SetUpTemporalBlocking(const int nrhs);
+
+    /** @brief Whether a level is advanced with temporal blocking.
+     * @param   lev Level.
+     */
+    bool UseTemporalBlocking(const int lev) const {
+        return temporal_blocking && lev >= temporal_blocking_min_level;
+    }
+
+    void FillIntermediatePatchAndRhs(RhsMultiFab &rhs_mf,
+                                     amrex::MultiFab &state_mf,
+                                     const double time, const int lev,
+                                     const double dt, const double dx);
+    void FillIntermediatePatchAndAddRhs(RhsMultiFab &rhs_mf,
+                                        amrex::MultiFab &state_mf,
+                                        const double time, const int lev,
+                                        const double dt, const double dx,
+                                        const double weight);
+
+    /** @brief Computes dst = x + b*y on the valid cells in double precision.
+     *         Same as amrex::MultiFab::LinComb with a unit weight of x, but x,
+     *         y and dst may be either a state or a Rhs container.
+     * @param   dst     Destination.
+     * @param   x       First source.
+     * @param   xcomp   First component of x.
+     * @param   b       Weight of y.
+     * @param   y       Second source.
+     * @param   ycomp   First component of y.
+     * @param   dcomp   First component of dst.
+     * @param   ncomp   Number of components.
+     */
+    template <class D, class X, class Y>
+    static void LinComb(D &dst, const X &x, const int xcomp, const double b,
+                        const Y &y, const int ycomp, const int dcomp,
+                        const int ncomp) {
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+        for (amrex::MFIter mfi(dst, amrex::TilingIfNotGPU()); mfi.isValid();
+             ++mfi) {
+            const amrex::Box &bx = mfi.tilebox();
+            const auto &dst_fab = dst.array(mfi);
+            const auto &x_fab = x.const_array(mfi);
+            const auto &y_fab = y.const_array(mfi);
+            amrex::ParallelFor(
+                bx, ncomp,
+                [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept {
+                    dst_fab(i, j, k, dcomp + n) =
+                        static_cast<double>(x_fab(i, j, k, xcomp + n)) +
+                        b * static_cast<double>(y_fab(i, j, k, ycomp + n));
+                });
+        }
+    }
+
     /** @brief Pointer to the simulation.
      */
     Sledgehamr *sim;
+
+    /** @brief Whether to compute the Rhs of interior cells while ghost cells
+     *         are being exchanged.
+     */
+    bool overlap_communication = false;
+
+    /** @brief Whether to advance tiles through all stages of a time step at
+     *         once using widened ghost regions instead of one level-wide
+     *         pass per stage.
+     */
+    bool temporal_blocking = false;
+
+    /** @brief Coarsest level that uses temporal blocking.
+     */
+    int temporal_blocking_min_level = 1;
+
+    /** @brief Number of ghost cells needed by a single Rhs evaluation.
+     */
+    int stencil_width = 0;
 };
 
 }; // namespace sledgehamr
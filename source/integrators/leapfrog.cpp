@@ -2,6 +2,13 @@
 
 namespace sledgehamr {
 
+/** @brief Sets up temporal blocking if requested.
+ * @param   owner   Pointer to simulation.
+ */
+IntegratorLeapfrog::IntegratorLeapfrog(Sledgehamr *owner) : Integrator{owner} {
+    SetUpTemporalBlocking(2);
+}
+
 /** @brief Advances one level by one time step using leap-frog algorithm in the
  * kick-drift-kick form.
  * @param   mf_old  Current state.
@@ -13,6 +20,11 @@ namespace sledgehamr {
 void IntegratorLeapfrog::Integrate(LevelData &mf_old, LevelData &mf_new,
                                    const int lev, const double dt,
                                    const double dx) {
+    if (UseTemporalBlocking(lev)) {
+        IntegrateBlocked(mf_old, mf_new, lev, dt, dx);
+        return;
+    }
+
     const double t0 = mf_old.t;
     const double t1 = t0 + dt;
 
@@ -33,33 +45,115 @@ void IntegratorLeapfrog::Integrate(LevelData &mf_old, LevelData &mf_new,
     const int gN1 = gN0 + gN;
 
     // temp states.
-    amrex::MultiFab a(mf_old.boxArray(), mf_old.DistributionMap(), N,
-                      sim->nghost);
-    amrex::MultiFab vh(mf_old.boxArray(), mf_old.DistributionMap(), N,
-                       sim->nghost);
+    std::unique_ptr<RhsMultiFab> a_ptr = sim->scratch_pool->Get(
+        mf_old.boxArray(), mf_old.DistributionMap(), N, sim->NGhost(lev), lev);
+    std::unique_ptr<RhsMultiFab> vh_ptr = sim->scratch_pool->Get(
+        mf_old.boxArray(), mf_old.DistributionMap(), N, sim->NGhost(lev), lev);
+    RhsMultiFab &a = *a_ptr;
+    RhsMultiFab &vh = *vh_ptr;
 
     // integrate.
     sim->FillRhs(a, mf_old, t0, lev, dt, dx);
-    amrex::MultiFab::LinComb(vh, 1, mf_old, 0, dt / 2., a, 0, 0, N, 0);
-    amrex::MultiFab::LinComb(mf_new, 1, mf_old, uN0, dt, vh, uN1, uN0, uN, 0);
-    if (Ngrav > 0) {
-        amrex::MultiFab::LinComb(mf_new, 1, mf_old, gN0, dt, vh, gN1, gN0, gN,
-                                 0);
-    }
+    LinComb(vh, mf_old, 0, dt / 2., a, 0, 0, N);
+    LinComb(mf_new, mf_old, uN0, dt, vh, uN1, uN0, uN);
+    if (Ngrav > 0)
+        LinComb(mf_new, mf_old, gN0, dt, vh, gN1, gN0, gN);
+    FillIntermediatePatchAndRhs(a, mf_new, t1, lev, dt, dx);
+    LinComb(mf_new, vh, uN1, dt / 2., a, uN1, uN1, uN);
+    if (Ngrav > 0)
+        LinComb(mf_new, vh, gN1, dt / 2., a, gN1, gN1, gN);
     sim->level_synchronizer->FillIntermediatePatch(lev, t1, mf_new);
-    sim->FillRhs(a, mf_new, t1, lev, dt, dx);
-    amrex::MultiFab::LinComb(mf_new, 1, vh, uN1, dt / 2., a, uN1, uN1, uN, 0);
-    if (Ngrav > 0) {
-        amrex::MultiFab::LinComb(mf_new, 1, vh, gN1, dt / 2., a, gN1, gN1, gN,
-                                 0);
+    sim->scratch_pool->Release(std::move(a_ptr), lev);
+    sim->scratch_pool->Release(std::move(vh_ptr), lev);
+}
+
+/** @brief Same as Integrate but advances one tile at a time through the full
+ *         kick-drift-kick sequence while its data is cache-resident. The first
+ *         kick and the drift are computed on the tile grown by the stencil
+ *         width instead of exchanging ghost cells in between, which requires
+ *         mf_old to have 2*stencil_width ghost cells. Velocities of the
+ *         intermediate state are set to the half-step velocities. Identical
+ *         to Integrate away from coarse-fine boundaries for Rhs that do not
+ *         depend on velocities.
+ * @param   mf_old  Current state.
+ * @param   mf_new  New state after advancement.
+ * @param   lev     Current level.
+ * @param   dt      Time step size.
+ * @param   dx      Grid spacing.
+ */
+void IntegratorLeapfrog::IntegrateBlocked(LevelData &mf_old, LevelData &mf_new,
+                                          const int lev, const double dt,
+                                          const double dx) {
+    const double t0 = mf_old.t;
+    const double t1 = t0 + dt;
+    const int w = stencil_width;
+
+    const int N = mf_old.nComp();
+    const int Ngrav = sim->with_gravitational_waves ? 12 : 0;
+    const int Nf = N - Ngrav;
+    const int uN = Nf / 2;
+    const int uN1 = uN;
+    const int gN = Ngrav / 2;
+    const int gN0 = Nf;
+    const int gN1 = gN0 + gN;
+
+    // Rhs and linear combinations are fused, so the whole tile loop is timed
+    // as Rhs to keep the per-level cost comparable to Integrate.
+    sim->performance_monitor->Start(sim->performance_monitor->idx_rhs, lev);
+    RhsBoxParams params_t0, params_t1;
+    sim->SetUpRhsBoxParams(params_t0, t0, lev);
+    sim->SetUpRhsBoxParams(params_t1, t1, lev);
+
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+    for (amrex::MFIter mfi(mf_new, amrex::TilingIfNotGPU()); mfi.isValid();
+         ++mfi) {
+        const amrex::Box &bx = mfi.tilebox();
+        const amrex::Box bx1 = amrex::grow(bx, w);
+        const amrex::Array4<amrex::Real const> &old_fab =
+            mf_old.const_array(mfi);
+        const amrex::Array4<amrex::Real> &new_fab = mf_new.array(mfi);
+
+        RhsFab a(bx1, N, amrex::The_Async_Arena());
+        RhsFab vh(bx1, N, amrex::The_Async_Arena());
+        amrex::FArrayBox st(bx1, N, amrex::The_Async_Arena());
+        const amrex::Array4<double> &a_fab = a.array();
+        const amrex::Array4<double> &vh_fab = vh.array();
+        const amrex::Array4<amrex::Real> &st_fab = st.array();
+
+        sim->FillRhsBox(bx1, a_fab, old_fab, params_t0, lev, dt, dx);
+        amrex::ParallelFor(
+            bx1, N, [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept {
+                vh_fab(i, j, k, n) =
+                    old_fab(i, j, k, n) + dt / 2. * a_fab(i, j, k, n);
+            });
+        amrex::ParallelFor(
+            bx1, N, [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept {
+                // Offset to the conjugate momentum if n is a position.
+                const int off = n < uN1 ? uN : (n >= gN0 && n < gN1 ? gN : 0);
+                st_fab(i, j, k, n) =
+                    off > 0
+                        ? old_fab(i, j, k, n) + dt * vh_fab(i, j, k, n + off)
+                        : vh_fab(i, j, k, n);
+            });
+
+        sim->FillRhsBox(bx, a_fab, st_fab, params_t1, lev, dt, dx);
+        amrex::ParallelFor(
+            bx, N, [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept {
+                const bool pos = n < uN1 || (n >= gN0 && n < gN1);
+                new_fab(i, j, k, n) =
+                    pos ? st_fab(i, j, k, n)
+                        : vh_fab(i, j, k, n) + dt / 2. * a_fab(i, j, k, n);
+            });
     }
+    sim->performance_monitor->Stop(sim->performance_monitor->idx_rhs, lev);
+
     sim->level_synchronizer->FillIntermediatePatch(lev, t1, mf_new);
 }
 
 void IntegratorLeapfrog::DebugPrint(amrex::MultiFab &mf, const char *msg) {
 #pragma omp parallel
     for (amrex::MFIter mfi(mf, true); mfi.isValid(); ++mfi) {
-        const amrex::Array4<double> &state_arr = mf.array(mfi);
+        const amrex::Array4<amrex::Real> &state_arr = mf.array(mfi);
         const amrex::Box &bx = mfi.tilebox();
 
         const amrex::Dim3 lo = amrex::lbound(bx);
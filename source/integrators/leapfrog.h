@@ -8,13 +8,16 @@ namespace sledgehamr {
 /** @brief Implementation of the leap-frog integration scheme (kick-drift-kick).
  */
 class IntegratorLeapfrog : public Integrator {
-    using Integrator::Integrator;
+  public:
+    IntegratorLeapfrog(Sledgehamr *owner);
 
   protected:
     virtual void Integrate(LevelData &mf_old, LevelData &mf_new, const int lev,
                            const double dt, const double dx) override;
 
   private:
+    void IntegrateBlocked(LevelData &mf_old, LevelData &mf_new, const int lev,
+                          const double dt, const double dx);
     void DebugPrint(amrex::MultiFab &mf, const char *msg);
 };
 
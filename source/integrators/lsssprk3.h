@@ -9,11 +9,16 @@ namespace sledgehamr {
  *         order Runge-Kutta integration scheme (LSSSPRK3).
  */
 class IntegratorLsssprk3 : public Integrator {
-    using Integrator::Integrator;
+  public:
+    IntegratorLsssprk3(Sledgehamr* owner);
 
   protected:
     virtual void Integrate(LevelData& mf_old, LevelData& mf_new, const int lev,
                            const double dt, const double dx) override;
+
+  private:
+    void IntegrateBlocked(LevelData& mf_old, LevelData& mf_new, const int lev,
+                          const double dt, const double dx);
 };
 
 }; // namespace sledgehamr
@@ -25,7 +25,7 @@ IntegratorRkn::IntegratorRkn(Sledgehamr* owner, const IntegratorType id)
 void IntegratorRkn::Integrate(LevelData& mf_old, LevelData& mf_new,
         const int lev, const double dt, const double dx) {
         const double t = mf_old.t;
-        const int nghost = sim->nghost;
+        const int nghost = sim->NGhost(lev);
 
         // Total number of fields, gravitational field components and
         // user-defined fields (includes conjugate momenta).
@@ -43,82 +43,161 @@ void IntegratorRkn::Integrate(LevelData& mf_old, LevelData& mf_new,
         const int gN0 = Nf;
         const int gN1 = gN0 + gN;
 
-        std::vector<std::unique_ptr<amrex::MultiFab> > F_nodes;
+        // Fab memory allocated during this step. Read back below.
+        const bool measure = sim->performance_monitor->IsActive();
+        amrex::Long bytes_before = 0;
+        if (measure) {
+            amrex::ResetTotalBytesAllocatedInFabsHWM();
+            bytes_before = amrex::TotalBytesAllocatedInFabs();
+        }
+
+        // Rhs of each stage. Only valid cells are read, so no ghost cells.
+        std::vector<std::unique_ptr<RhsMultiFab> > F;
         for (int i = 0; i < number_nodes; ++i) {
-            F_nodes.emplace_back( std::make_unique<amrex::MultiFab>(
-                    mf_old.boxArray(), mf_old.DistributionMap(), N, nghost) );
+            F.emplace_back( sim->scratch_pool->Get(
+                    mf_old.boxArray(), mf_old.DistributionMap(), N, 0, lev) );
         }
 
+        // Velocity-like coefficients are not needed during the stages.
+        const std::vector<double> no_vel;
+
         for (int i = 0; i < number_nodes; ++i) {
             // stage_time = x_0 + c_i*h
             double stage_time = t + dt * nodes[i];
 
-            // mf_new = (y_0, y'_0)
-            amrex::MultiFab::Copy(mf_new, mf_old, 0, 0, N, nghost);
-
-            // mf_new = (y_0 + c_i * h * y'_0, y'_0)
-            amrex::MultiFab::Saxpy(mf_new, dt * nodes[i], mf_old,
-                                   uN1, uN0, uN, nghost);
-            if (Ngrav > 0)
-                amrex::MultiFab::Saxpy(mf_new, dt * nodes[i], mf_old,
-                                       gN1, gN0 , gN, nghost);
-
-            if (i > 0) {
-                // mf_new = (y_0 + c_i * h * y'_0 + sum_j( h^2 * a_ij * k'_j ),
-                //           y'_0)
-                for (int j = 0; j < i; ++j) {
-                    amrex::MultiFab::Saxpy(
-                            mf_new, dt*dt * tableau[i][j], *F_nodes[j],
-                            uN1, uN0 , uN, nghost);
+            // mf_new = (y_0 + c_i * h * y'_0 + sum_j( h^2 * a_ij * k'_j ),
+            //           y'_0)
+            std::vector<double> a_pos(i);
+            for (int j = 0; j < i; ++j)
+                a_pos[j] = dt*dt * tableau[i][j];
 
-                    if (Ngrav == 0) continue;
+            FusedUpdate(mf_new, mf_old, F, i, dt * nodes[i], a_pos, no_vel,
+                        uN1, gN0, gN1);
 
-                    amrex::MultiFab::Saxpy(
-                            mf_new, dt*dt * tableau[i][j], *F_nodes[j],
-                            gN1, gN0 , gN, nghost);
-                }
-
-            }
-
-            sim->level_synchronizer->FillIntermediatePatch(
-                    lev, stage_time, mf_new);
-
-            // F_nodes[i] = (null, f(stage_time, mf_new)
-            //            = (null, k'_i)
-            sim->FillRhs(*F_nodes[i], mf_new, stage_time, lev, dt, dx);
+            // F[i] = (null, f(stage_time, mf_new)
+            //      = (null, k'_i)
+            FillIntermediatePatchAndRhs(*F[i], mf_new, stage_time, lev, dt,
+                                        dx);
         }
 
-        // mf_new = (y_0, y'_0)
-        amrex::MultiFab::Copy(mf_new, mf_old, 0, 0, N, nghost);
-
-        // mf_new = (y_0 + h * y'_0, y'_0)
-        amrex::MultiFab::Saxpy(mf_new, dt, mf_new, uN1, uN0, uN, nghost);
-        if( Ngrav > 0 )
-             amrex::MultiFab::Saxpy(mf_new, dt, mf_new, gN1, gN0, gN, nghost);
-
         // mf_new = (y_0 + h * y'_0 + sum_i(h^2*\bar[b_i]*k'_i),
         //           y'_0 + sum_i(b_i*k'_i))
+        std::vector<double> a_pos(number_nodes), a_vel(number_nodes);
         for (int i = 0; i < number_nodes; ++i) {
-            amrex::MultiFab::Saxpy(mf_new, dt * dt * weights_bar_b[i],
-                                   *F_nodes[i],
-                                   uN1, uN0, uN, nghost);
-            amrex::MultiFab::Saxpy(mf_new, dt * weights_b[i], *F_nodes[i],
-                                   uN1, uN1, uN, nghost);
-
-            if (Ngrav == 0) continue;
-
-            amrex::MultiFab::Saxpy(mf_new, dt * dt * weights_bar_b[i],
-                                   *F_nodes[i],
-                                   gN1, gN0, gN, nghost);
-            amrex::MultiFab::Saxpy(mf_new, dt * weights_b[i], *F_nodes[i],
-                                   gN1, gN1, gN, nghost);
+            a_pos[i] = dt * dt * weights_bar_b[i];
+            a_vel[i] = dt * weights_b[i];
+        }
+
+        FusedUpdate(mf_new, mf_old, F, number_nodes, dt, a_pos, a_vel,
+                    uN1, gN0, gN1);
+
+        // Per valid cell of this rank: Fab memory newly allocated during the
+        // step, which vanishes once the stage buffers are pooled, and the
+        // allocations the stage updates stream through.
+        double ncells = 0;
+        for (amrex::MFIter mfi(mf_old); mfi.isValid(); ++mfi)
+            ncells += mfi.validbox().numPts();
+
+        if (measure && ncells > 0) {
+            const amrex::Long peak = std::max(
+                    amrex::TotalBytesAllocatedInFabsHWM(), bytes_before);
+
+            double resident = ScratchPool::Bytes(mf_old)
+                            + ScratchPool::Bytes(mf_new);
+            for (int i = 0; i < number_nodes; ++i)
+                resident += ScratchPool::Bytes(*F[i]);
+
+            sim->performance_monitor->Count(
+                    sim->performance_monitor->idx_rkn_bytes_allocated,
+                    (peak - bytes_before) / ncells, lev);
+            sim->performance_monitor->Count(
+                    sim->performance_monitor->idx_rkn_bytes_resident,
+                    resident / ncells, lev);
         }
 
+        for (int i = 0; i < number_nodes; ++i)
+            sim->scratch_pool->Release(std::move(F[i]), lev);
+
         // Call the post-update hook for S_new
         sim->level_synchronizer->FillIntermediatePatch(
                         lev, t + dt, mf_new);
 }
 
+/** @brief Performs a complete stage update in a single pass over the valid
+ *         cells instead of a copy followed by one saxpy per stage. Computes
+ *         y   = y_0  + c_pos * y'_0 + sum_j a_pos[j] * F_j'
+ *         y'  = y'_0 + sum_j a_vel[j] * F_j'
+ *         for all field pairs, where F_j' are the velocity components of the
+ *         first nstages stage buffers. The order of operations per cell
+ *         matches the unfused sequence of MultiFab::Saxpy calls. Ghost cells
+ *         are not touched and need to be filled afterwards.
+ * @param   mf_new  Updated state.
+ * @param   mf_old  State at the beginning of the time step.
+ * @param   F       Stage buffers.
+ * @param   nstages Number of stage buffers involved.
+ * @param   c_pos   Weight of y'_0 in the position update.
+ * @param   a_pos   Weights of F_j' in the position update.
+ * @param   a_vel   Weights of F_j' in the velocity update. Velocities are
+ *                  copied unchanged if empty.
+ * @param   uN1     First velocity component of user-defined fields.
+ * @param   gN0     First position component of gravitational waves.
+ * @param   gN1     First velocity component of gravitational waves.
+ */
+void IntegratorRkn::FusedUpdate(
+        amrex::MultiFab& mf_new, const amrex::MultiFab& mf_old,
+        const std::vector<std::unique_ptr<RhsMultiFab> >& F,
+        const int nstages, const double c_pos, const std::vector<double>& a_pos,
+        const std::vector<double>& a_vel, const int uN1, const int gN0,
+        const int gN1) {
+    const int N = mf_old.nComp();
+    const int uN = uN1;
+    const int gN = gN1 - gN0;
+    const bool update_vel = !a_vel.empty();
+
+    // Pad so that device arrays are never empty.
+    std::vector<double> coeffs(2 * nstages + 2, 0.);
+    for (int s = 0; s < nstages; ++s) {
+        coeffs[s] = a_pos[s];
+        if (update_vel)
+            coeffs[nstages + s] = a_vel[s];
+    }
+    amrex::Gpu::AsyncArray<double> async_coeffs(coeffs.data(), coeffs.size());
+    const double* l_coeffs = async_coeffs.data();
+
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+    for (amrex::MFIter mfi(mf_new, amrex::TilingIfNotGPU()); mfi.isValid();
+         ++mfi) {
+        const amrex::Box& bx = mfi.tilebox();
+        const amrex::Array4<amrex::Real>& new_fab = mf_new.array(mfi);
+        const amrex::Array4<amrex::Real const>& old_fab =
+                mf_old.const_array(mfi);
+
+        std::vector<amrex::Array4<double const> > F_fabs(nstages + 1);
+        for (int s = 0; s < nstages; ++s)
+            F_fabs[s] = F[s]->const_array(mfi);
+        amrex::Gpu::AsyncArray<amrex::Array4<double const> > async_F_fabs(
+                F_fabs.data(), F_fabs.size());
+        const amrex::Array4<double const>* l_F = async_F_fabs.data();
+
+        amrex::ParallelFor(bx, N,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept {
+            // Offset to the conjugate momentum if n is a position component.
+            const int off = n < uN1 ? uN : (n >= gN0 && n < gN1 ? gN : 0);
+
+            double val = old_fab(i, j, k, n);
+            if (off > 0) {
+                val += c_pos * old_fab(i, j, k, n + off);
+                for (int s = 0; s < nstages; ++s)
+                    val += l_coeffs[s] * l_F[s](i, j, k, n + off);
+            } else if (update_vel) {
+                for (int s = 0; s < nstages; ++s)
+                    val += l_coeffs[nstages + s] * l_F[s](i, j, k, n);
+            }
+            new_fab(i, j, k, n) = val;
+        });
+    }
+}
+
 /** @brief Sets up the correct Butcher Tableau given an integration scheme.
  */
 void IntegratorRkn::SetButcherTableau() {
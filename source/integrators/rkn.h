@@ -20,6 +20,12 @@ class IntegratorRkn : public Integrator {
   private:
     void SetButcherTableau();
     void ReadUserDefinedButcherTableau();
+    void FusedUpdate(amrex::MultiFab& mf_new, const amrex::MultiFab& mf_old,
+                     const std::vector<std::unique_ptr<RhsMultiFab> >& F,
+                     const int nstages, const double c_pos,
+                     const std::vector<double>& a_pos,
+                     const std::vector<double>& a_vel, const int uN1,
+                     const int gN0, const int gN1);
 
     /** @brief Number of nodes involved.
      */
@@ -10,6 +10,7 @@
 #include "slices.h"
 #include "level_writer.h"
 #include "amrex_plotfile.h"
+#include "fft.h"
 
 namespace sledgehamr {
 
@@ -50,6 +51,19 @@ void IOModule::ParseParams() {
     warning_msg = "Restart checkpoint will be deleted!";
     utils::AssessParam(validity, param_name, delete_restart_checkpoint,
                        "", warning_msg, sim->nerrors, sim->do_thorough_checks);
+
+    param_name = "output.fft_cache_size";
+    pp.query(param_name.c_str(), utils::FftContext::max_size);
+    validity = utils::FftContext::max_size < 0 ?
+                utils::ErrorState::ERROR : utils::ErrorState::OK;
+    std::string error_msg = "Cache size needs to be non-negative.";
+    utils::AssessParam(validity, param_name, utils::FftContext::max_size,
+                       error_msg, "", sim->nerrors, sim->do_thorough_checks);
+
+    param_name = "output.release_fft_cache";
+    pp.query(param_name.c_str(), release_fft_cache);
+    utils::AssessParamOK(param_name, release_fft_cache,
+                         sim->do_thorough_checks);
 }
 
 /** @brief Will set up all pre-defined output types.
@@ -186,6 +200,22 @@ void IOModule::Write(bool force) {
     output[idx_checkpoints].Write(sim->grid_new[0].t, force);
     sim->performance_monitor->Stop(
             sim->performance_monitor->idx_output, idx_checkpoints);
+
+    // Padded fields and plans are large and not needed until the next
+    // output step.
+    if (release_fft_cache)
+        utils::FftContext::Release();
+}
+
+/** @brief Checks whether any output that contains truncation errors is going
+ *         to be written at a given time.
+ * @param   time    Current time.
+ * @return  Whether truncation errors need to be kept.
+ */
+bool IOModule::TruncationErrorOutputDue(double time) const {
+    return output[idx_slices_truncation_error].IsDue(time) ||
+           output[idx_coarse_box_truncation_error].IsDue(time) ||
+           output[idx_full_box_truncation_error].IsDue(time);
 }
 
 /** @brief Will write slices on all levels.
@@ -244,7 +274,8 @@ bool IOModule::WriteCoarseBoxTruncationError(double time, std::string prefix) {
  * @return  Whether the write was successfull or not.
  */
 bool IOModule::WriteFullBox(double time, std::string prefix) {
-    if (!sim->grid_old[0].contains_truncation_errors)
+    if (!sim->grid_old[0].contains_truncation_errors &&
+        !sim->grid_old[0].truncation_tags)
         return false;
 
     LevelWriter writer(sim, prefix, idx_full_box);
@@ -311,20 +342,37 @@ bool IOModule::WriteSpectra(double time, std::string prefix) {
     if (spectra.empty())
         return false;
 
-    sim->ReadSpectrumKs();
+    const int lev = 0;
+    SpectrumBins *bins = sim->spectrum_bins.get();
+    bins->Build(sim->dimN[lev]);
+    const int kmax = bins->NBins();
+
+    std::vector<double> data(spectra.size() * kmax, 0.);
+    for (int p = 0; p < spectra.size(); ++p)
+        spectra[p].Compute(&data[p * kmax], sim);
+
+    // A single reduction for all spectra of this output step.
+    amrex::ParallelDescriptor::ReduceRealSum(
+        data.data(), data.size(),
+        amrex::ParallelDescriptor::IOProcessorNumber());
 
-    hid_t file_id;
     if (amrex::ParallelDescriptor::IOProcessor()) {
         std::string filename = prefix + "/spectra.hdf5";
-        file_id = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT,
-                            H5P_DEFAULT);
-    }
+        hid_t file_id = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC,
+                                  H5P_DEFAULT, H5P_DEFAULT);
 
-    for (int p = 0; p < spectra.size(); ++p)
-        spectra[p].Compute(p, file_id, sim);
+        const int nparams = 3;
+        double header_data[nparams] = {sim->grid_new[lev].t,
+                                       (double)sim->dimN[lev], (double)kmax};
+        utils::hdf5::Write(file_id, "Header", header_data, nparams);
+        utils::hdf5::Write(file_id, "k_sq", bins->ks.data(), kmax);
+
+        for (int p = 0; p < spectra.size(); ++p)
+            utils::hdf5::Write(file_id, spectra[p].ident, &data[p * kmax],
+                               kmax);
 
-    if (amrex::ParallelDescriptor::IOProcessor())
         H5Fclose(file_id);
+    }
 
     return true;
 }
@@ -338,8 +386,6 @@ bool IOModule::WriteGravitationalWaveSpectrum(double time, std::string prefix) {
     if (!sim->with_gravitational_waves)
         return false;
 
-    sim->ReadSpectrumKs();
-
     hid_t file_id;
     if (amrex::ParallelDescriptor::IOProcessor()) {
         std::string filename = prefix + "/spectra.hdf5";
@@ -498,6 +544,18 @@ void IOModule::UpdateOutputModules() {
     chk.UpdateOutputModules();
 }
 
+/** @brief Builds the binning of all enabled spectra upfront, such that the
+ *         |k|^2 shells are not generated during the first output step.
+ */
+void IOModule::BuildSpectrumBins() {
+    const int lev = 0;
+    if (output[idx_spectra].IsEnabled() && !spectra.empty())
+        sim->spectrum_bins->Build(sim->dimN[lev]);
+
+    if (output[idx_gw_spectra].IsEnabled() && sim->with_gravitational_waves)
+        sim->gravitational_waves->BuildBins();
+}
+
 /** @brief Locates the latest checkpoint within a parent folder.
  * @param   folder  Parent folder containing checkpoints.
  * @return  ID of the latest checkpoint.
@@ -22,7 +22,9 @@ class IOModule {
     void Write(bool force=false);
     void RestartSim();
     void UpdateOutputModules();
+    void BuildSpectrumBins();
     void WriteBoxArray(amrex::BoxArray& ba);
+    bool TruncationErrorOutputDue(double time) const;
 
     /** @brief Vectors containing instructions for projections.
      */
@@ -102,6 +104,10 @@ class IOModule {
      */
     bool delete_restart_checkpoint = false;
 
+    /** @brief Whether cached FFT contexts are freed after each output step.
+     */
+    bool release_fft_cache = true;
+
     /** @brief Pointer to the simulation.
      */
     Sledgehamr* sim;
@@ -16,10 +16,11 @@ namespace kernels {
  *                  fine.
  */
 AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
-void AverageDownWithTruncationError(int i, int j, int k, const int ncomp,
-                                    amrex::Array4<double> const& crse,
-                                    amrex::Array4<double const> const& fine,
-                                    amrex::Array4<double> const& te) {
+void AverageDownWithTruncationError(
+        int i, int j, int k, const int ncomp,
+        amrex::Array4<amrex::Real> const& crse,
+        amrex::Array4<amrex::Real const> const& fine,
+        amrex::Array4<amrex::Real> const& te) {
     const int ratio = 2;
     const double volfrac = 1.0/(double)(ratio*ratio*ratio);
     const int ii = i*ratio;
@@ -54,7 +55,7 @@ void AverageDownWithTruncationError(int i, int j, int k, const int ncomp,
  * @return Dissipation value.
  */
 template<int> AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
-double KreissOligerDissipation(const amrex::Array4<double const>& state,
+double KreissOligerDissipation(const amrex::Array4<amrex::Real const>& state,
                               const int i, const int j, const int k,
                               const int c, const double dx,
                               const double dissipation_strength);
@@ -63,7 +64,7 @@ double KreissOligerDissipation(const amrex::Array4<double const>& state,
  *         declartion of kernels::KreissOligerDissipation for more details.
  */
 template<> AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
-double KreissOligerDissipation<2>(const amrex::Array4<double const>& state,
+double KreissOligerDissipation<2>(const amrex::Array4<amrex::Real const>& state,
                                  const int i, const int j, const int k,
                                  const int c, const double dx,
                                  const double dissipation_strength) {
@@ -86,7 +87,7 @@ double KreissOligerDissipation<2>(const amrex::Array4<double const>& state,
  *         declartion of kernels::KreissOligerDissipation for more details.
  */
 template<> AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
-double KreissOligerDissipation<3>(const amrex::Array4<double const>& state,
+double KreissOligerDissipation<3>(const amrex::Array4<amrex::Real const>& state,
                                  const int i, const int j, const int k,
                                  const int c, const double dx,
                                  const double dissipation_strength) {
@@ -2,9 +2,22 @@
 #define SLEDGEHAMR_LEVEL_DATA_H
 
 #include <AMReX_MultiFab.H>
+#include <AMReX_TagBox.H>
 
 namespace sledgehamr {
 
+/** @brief Containers for Rhs evaluations and integrator stages. Kept in double
+ *         precision even if the state is stored in single precision, such
+ *         that stages are accumulated without additional rounding.
+ */
+#ifdef AMREX_USE_FLOAT
+using RhsMultiFab = amrex::FabArray<amrex::BaseFab<double>>;
+using RhsFab = amrex::BaseFab<double>;
+#else
+using RhsMultiFab = amrex::MultiFab;
+using RhsFab = amrex::FArrayBox;
+#endif
+
 /** @brief Class that holds the MultiFab data while also keeping track of time
  *         and step numbers.
  */
@@ -40,6 +53,14 @@ class LevelData : public amrex::MultiFab {
 
     using amrex::MultiFab::define;
 
+    /** @brief Discards truncation errors and truncation error tags.
+     */
+    void ClearTruncationErrors() {
+        contains_truncation_errors = false;
+        truncation_tags.reset();
+        ntruncation_tags.clear();
+    }
+
     /** @brief Static method that returns vector of times from a given LevelData
      *         vector.
      * @param   mfs Vector of pointers to MultiFab objects. MultiFab needs to be
@@ -69,6 +90,17 @@ class LevelData : public amrex::MultiFab {
      *         into it.
      */
     bool contains_truncation_errors = false;
+
+    /** @brief Truncation error tags if they have been computed together with
+     *         the truncation errors. Defined on the coarsened BoxArray of the
+     *         level, one tag per coarse cell. Kept even if the MultiFab itself
+     *         is cleared.
+     */
+    std::unique_ptr<amrex::TagBoxArray> truncation_tags;
+
+    /** @brief Number of truncation error tags per scalar field on this rank.
+     */
+    std::vector<long> ntruncation_tags;
 };
 
 }; // namespace sledgehamr
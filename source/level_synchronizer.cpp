@@ -28,6 +28,7 @@ LevelSynchronizer::LevelSynchronizer(Sledgehamr *owner) : sim(owner) {
     amrex::ParmParse pp("amr");
     int interpolation_type = InterpType::CellQuadratic;
     pp.query("interpolation_type", interpolation_type);
+    pp.query("coarse_fine_ghost_cache", use_ghost_cache);
 
     switch (interpolation_type) {
     case InterpType::PCInterp:
@@ -75,7 +76,7 @@ void LevelSynchronizer::FillCoarsePatch(const int lev, const double time,
 #endif
 
     // Interpolate lev from lev-1.
-    amrex::InterpFromCoarseLevel(mf, amrex::IntVect(sim->nghost), time, *cmf[0],
+    amrex::InterpFromCoarseLevel(mf, mf.nGrowVect(), time, *cmf[0],
                                  0, 0, mf.nComp(), sim->geom[lev - 1],
                                  sim->geom[lev], cphysbc, 0, fphysbc, 0,
                                  sim->refRatio(lev - 1), mapper, bcs, 0);
@@ -133,19 +134,28 @@ void LevelSynchronizer::FillPatch(const int lev, const double time,
                                                            bcs, bndry_func);
 #endif
 
-        amrex::FillPatchTwoLevels(mf, time, cmfs, ctime, fmfs, ftime, scomp,
-                                  dcomp, ncomp, sim->geom[lev - 1], geom,
-                                  cphysbc, 0, fphysbc, 0,
-                                  sim->refRatio(lev - 1), mapper, bcs, 0);
+        CoarseFineGhostCache* cache = GetGhostCache(lev, mf);
+        if (cache != nullptr) {
+            amrex::FillPatchSingleLevel(mf, time, fmfs, ftime, scomp, dcomp,
+                                        ncomp, geom, fphysbc, 0);
+            cache->Fill(mf, time, cmfs, ctime, scomp, dcomp, ncomp,
+                        sim->geom[lev - 1], geom, cphysbc, bcs);
+        } else {
+            amrex::FillPatchTwoLevels(mf, time, cmfs, ctime, fmfs, ftime,
+                                      scomp, dcomp, ncomp, sim->geom[lev - 1],
+                                      geom, cphysbc, 0, fphysbc, 0,
+                                      sim->refRatio(lev - 1), mapper, bcs, 0);
+        }
     }
 
     sim->performance_monitor->Stop(sim->performance_monitor->idx_fill_patch,
                                    lev);
 }
 
-/** @brief Fills MultiFab with data from valid regions and fills ghost cells
- *         during intermediate time steps. Works for single level and
- *         2-level cases (interpolating from coarse).
+/** @brief Fills ghost cells during intermediate time steps. Works for single
+ *         level and 2-level cases (interpolating from coarse). The valid
+ *         region of mf is used as the fine level source and is left in place,
+ *         only ghost cells are touched.
  * @param   lev     (Fine) Level to be filled.
  * @param   time    Time of level.
  * @param   mf      MultiFab to be filled.
@@ -189,10 +199,6 @@ void LevelSynchronizer::FillIntermediatePatch(const int lev, const double time,
         amrex::Vector<amrex::MultiFab *> cmfs = GetLevelData(lev - 1, time);
         amrex::Vector<double> ctime = LevelData::getTimes(cmfs);
 
-        // TODO check if copy is really needed.
-        amrex::MultiFab mf_tmp(mf.boxArray(), mf.DistributionMap(), mf.nComp(),
-                               sim->nghost);
-
 #ifdef AMREX_USE_GPU
         amrex::PhysBCFunct<amrex::GpuBndryFuncFab<NullFill>> cphysbc(
             sim->geom[lev - 1], bcs, gpu_bndry_func);
@@ -201,12 +207,92 @@ void LevelSynchronizer::FillIntermediatePatch(const int lev, const double time,
                                                            bcs, bndry_func);
 #endif
 
-        amrex::FillPatchTwoLevels(mf_tmp, time, cmfs, ctime, fmfs, ftime, scomp,
-                                  dcomp, ncomp, sim->geom[lev - 1], geom,
-                                  cphysbc, 0, fphysbc, 0,
-                                  sim->refRatio(lev - 1), mapper, bcs, 0);
+        // mf is its own fine level source. Ghost cells are filled in place
+        // from same-level neighbours and interpolated coarse data, without a
+        // copy of the valid region.
+        CoarseFineGhostCache* cache = GetGhostCache(lev, mf);
+        if (cache != nullptr) {
+            amrex::FillPatchSingleLevel(mf, time, fmfs, ftime, scomp, dcomp,
+                                        ncomp, geom, fphysbc, 0);
+            cache->Fill(mf, time, cmfs, ctime, scomp, dcomp, ncomp,
+                        sim->geom[lev - 1], geom, cphysbc, bcs);
+        } else {
+            amrex::FillPatchTwoLevels(mf, time, cmfs, ctime, fmfs, ftime,
+                                      scomp, dcomp, ncomp, sim->geom[lev - 1],
+                                      geom, cphysbc, 0, fphysbc, 0,
+                                      sim->refRatio(lev - 1), mapper, bcs, 0);
+        }
+    }
 
-        std::swap(mf, mf_tmp);
+    sim->performance_monitor->Stop(
+        sim->performance_monitor->idx_fill_intermediate_patch, lev);
+}
+
+/** @brief Non-blocking version of FillIntermediatePatch. Starts the exchange
+ *         of ghost cells between boxes of the same level. Valid cells of mf
+ *         can be read but no ghost cells until FillIntermediatePatchEnd has
+ *         been called.
+ * @param   lev     (Fine) Level to be filled.
+ * @param   time    Time of level.
+ * @param   mf      MultiFab to be filled.
+ */
+void LevelSynchronizer::FillIntermediatePatchBegin(const int lev,
+                                                   const double time,
+                                                   amrex::MultiFab &mf) {
+    // Without a coarse-fine ghost cache everything is done within
+    // amrex::FillPatchTwoLevels in FillIntermediatePatchEnd.
+    if (lev > 0 && GetGhostCache(lev, mf) == nullptr)
+        return;
+
+    sim->performance_monitor->Start(
+        sim->performance_monitor->idx_fill_intermediate_patch, lev);
+
+    amrex::Geometry &geom = lev < 0 ? sim->shadow_level_geom : sim->geom[lev];
+    mf.FillBoundary_nowait(geom.periodicity());
+
+    sim->performance_monitor->Stop(
+        sim->performance_monitor->idx_fill_intermediate_patch, lev);
+}
+
+/** @brief Completes a ghost cell fill started by FillIntermediatePatchBegin.
+ *         Result is identical to FillIntermediatePatch.
+ * @param   lev     (Fine) Level to be filled.
+ * @param   time    Time of level.
+ * @param   mf      MultiFab to be filled.
+ */
+void LevelSynchronizer::FillIntermediatePatchEnd(const int lev,
+                                                 const double time,
+                                                 amrex::MultiFab &mf) {
+    CoarseFineGhostCache *cache =
+        lev > 0 ? GetGhostCache(lev, mf) : nullptr;
+    if (lev > 0 && cache == nullptr) {
+        FillIntermediatePatch(lev, time, mf);
+        return;
+    }
+
+    sim->performance_monitor->Start(
+        sim->performance_monitor->idx_fill_intermediate_patch, lev);
+
+    // Physical boundary conditions are not needed since all boundaries are
+    // periodic.
+    mf.FillBoundary_finish();
+
+    if (cache != nullptr) {
+        amrex::Vector<amrex::MultiFab *> cmfs = GetLevelData(lev - 1, time);
+        amrex::Vector<double> ctime = LevelData::getTimes(cmfs);
+
+#ifdef AMREX_USE_GPU
+        amrex::GpuBndryFuncFab<NullFill> gpu_bndry_func(NullFill{});
+        amrex::PhysBCFunct<amrex::GpuBndryFuncFab<NullFill>> cphysbc(
+            sim->geom[lev - 1], bcs, gpu_bndry_func);
+#else
+        amrex::CpuBndryFuncFab bndry_func(nullptr);
+        amrex::PhysBCFunct<amrex::CpuBndryFuncFab> cphysbc(sim->geom[lev - 1],
+                                                           bcs, bndry_func);
+#endif
+
+        cache->Fill(mf, time, cmfs, ctime, 0, 0, mf.nComp(),
+                    sim->geom[lev - 1], sim->geom[lev], cphysbc, bcs);
     }
 
     sim->performance_monitor->Stop(
@@ -226,7 +312,7 @@ void LevelSynchronizer::AverageDownTo(const int lev) {
 
     // Since we averaged down we do not have truncation errors available at
     // lev+1.
-    sim->grid_old[lev + 1].contains_truncation_errors = false;
+    sim->grid_old[lev + 1].ClearTruncationErrors();
 
     sim->performance_monitor->Stop(sim->performance_monitor->idx_average_down,
                                    lev);
@@ -234,7 +320,9 @@ void LevelSynchronizer::AverageDownTo(const int lev) {
 
 /** @brief Compute truncation errors for level lev and saves them in
  *         sim->grid_old[lev]. Also averages down lev onto lev-1 at the
- *         same time.
+ *         same time. On CPUs the truncation error tags are computed in the
+ *         same pass instead and truncation errors are only saved if an output
+ *         requires them.
  * @param   lev Level for which truncation errors are to be computed.
  */
 void LevelSynchronizer::ComputeTruncationErrors(int lev) {
@@ -257,11 +345,28 @@ void LevelSynchronizer::ComputeTruncationErrors(int lev) {
     amrex::MultiFab &S_fine = sim->grid_new[lev];
     amrex::MultiFab &S_te = sim->grid_old[lev];
     const int ncomp = sim->scalar_fields.size();
+    const double time = sim->grid_new[lev].t;
 
     // Coarsen() the fine stuff on processors owning the fine data.
     amrex::BoxArray crse_S_fine_BA = S_fine.boxArray();
     crse_S_fine_BA.coarsen(2);
 
+    // Tag while averaging down such that truncation errors do not have to be
+    // re-read during tagging.
+    const bool fuse = sim->fuse_truncation_error_tagging &&
+                      !sim->tagging_on_gpu && amrex::Gpu::notInLaunchRegion();
+    const bool materialize =
+        !fuse || sim->io_module->TruncationErrorOutputDue(time);
+
+    std::unique_ptr<amrex::TagBoxArray> te_tags;
+    std::vector<long> ntags_trunc(ncomp, 0);
+    std::vector<double> params_mod;
+    if (fuse) {
+        te_tags = std::make_unique<amrex::TagBoxArray>(
+            crse_S_fine_BA, S_fine.DistributionMap());
+        sim->SetParamsTruncationModifier(params_mod, time, lev);
+    }
+
     if (crse_S_fine_BA == S_crse.boxArray() &&
         S_fine.DistributionMap() == S_crse.DistributionMap()) {
 #ifdef AMREX_USE_GPU
@@ -283,14 +388,26 @@ void LevelSynchronizer::ComputeTruncationErrors(int lev) {
         } else
 #endif
         {
-#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())                      \
+    reduction(vec_long_plus : ntags_trunc)
             for (amrex::MFIter mfi(S_crse, amrex::TilingIfNotGPU());
                  mfi.isValid(); ++mfi) {
                 const amrex::Box &bx = mfi.tilebox();
-                amrex::Array4<double> const &crsearr = S_crse.array(mfi);
-                amrex::Array4<double const> const &finearr =
+                amrex::Array4<amrex::Real> const &crsearr = S_crse.array(mfi);
+                amrex::Array4<amrex::Real const> const &finearr =
                     S_fine.const_array(mfi);
-                amrex::Array4<double> const &tearr = S_te.array(mfi);
+
+                if (fuse) {
+                    sim->AverageDownWithTruncationTagsCpu(
+                        crsearr, finearr,
+                        materialize ? S_te.array(mfi)
+                                    : amrex::Array4<amrex::Real>(),
+                        te_tags->array(mfi), bx, time, lev, materialize,
+                        &(ntags_trunc[0]), params_mod);
+                    continue;
+                }
+
+                amrex::Array4<amrex::Real> const &tearr = S_te.array(mfi);
 
                 AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bx, i, j, k, {
                     sledgehamr::kernels::AverageDownWithTruncationError(
@@ -323,14 +440,27 @@ void LevelSynchronizer::ComputeTruncationErrors(int lev) {
         } else
 #endif
         {
-#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())                      \
+    reduction(vec_long_plus : ntags_trunc)
             for (amrex::MFIter mfi(crse_S_fine, amrex::TilingIfNotGPU());
                  mfi.isValid(); ++mfi) {
                 const amrex::Box &bx = mfi.tilebox();
-                amrex::Array4<double> const &crsearr = crse_S_fine.array(mfi);
-                amrex::Array4<double const> const &finearr =
+                amrex::Array4<amrex::Real> const &crsearr =
+                    crse_S_fine.array(mfi);
+                amrex::Array4<amrex::Real const> const &finearr =
                     S_fine.const_array(mfi);
-                amrex::Array4<double> const &tearr = S_te.array(mfi);
+
+                if (fuse) {
+                    sim->AverageDownWithTruncationTagsCpu(
+                        crsearr, finearr,
+                        materialize ? S_te.array(mfi)
+                                    : amrex::Array4<amrex::Real>(),
+                        te_tags->array(mfi), bx, time, lev, materialize,
+                        &(ntags_trunc[0]), params_mod);
+                    continue;
+                }
+
+                amrex::Array4<amrex::Real> const &tearr = S_te.array(mfi);
 
                 // We copy from component scomp of the fine fab into
                 // component 0 of the crse fab because the crse fab is a
@@ -346,8 +476,12 @@ void LevelSynchronizer::ComputeTruncationErrors(int lev) {
         S_crse.ParallelCopy(crse_S_fine, 0, 0, crse_S_fine.nComp());
     }
 
-    // We now have saved truncation errors.
-    sim->grid_old[lev].contains_truncation_errors = true;
+    // We now have saved truncation errors or truncation error tags.
+    sim->grid_old[lev].contains_truncation_errors = materialize;
+    if (fuse) {
+        sim->grid_old[lev].truncation_tags = std::move(te_tags);
+        sim->grid_old[lev].ntruncation_tags = ntags_trunc;
+    }
 
     if (lev == 0)
         sim->shadow_level.clear();
@@ -449,8 +583,6 @@ void LevelSynchronizer::IncreaseCoarseLevelResolution() {
         sim->grid_new.erase(sim->grid_new.begin() + 1);
         sim->grid_old.erase(sim->grid_old.begin() + 1);
     }
-
-    sim->ReadSpectrumKs(true);
 }
 
 /** @brief Same as FillLevel::FromArray, but the array only covers the local
@@ -530,11 +662,15 @@ void LevelSynchronizer::FromArrayChunksAndUpsample(const int lev,
                                  amrex::IntVect(up, up, up), mapper, bcs, 0);
 }
 
-/** @brief Changes the the number of ghost cells at all levels.
- * @param   new_nghost  New number of ghost cells.
+/** @brief Changes the number of ghost cells of all levels to
+ *         sim->NGhost(lev) where it differs.
  */
-void LevelSynchronizer::ChangeNGhost(int new_nghost) {
+void LevelSynchronizer::ChangeNGhost() {
     for (int lev = 0; lev <= sim->finest_level; ++lev) {
+        const int new_nghost = sim->NGhost(lev);
+        if (sim->grid_new[lev].nGrow() == new_nghost)
+            continue;
+
         LevelData &ld_old = sim->grid_new[lev];
         const amrex::BoxArray &ba = ld_old.boxArray();
         const amrex::DistributionMapping &dm = ld_old.DistributionMap();
@@ -559,8 +695,6 @@ void LevelSynchronizer::ChangeNGhost(int new_nghost) {
 
         std::swap(sim->grid_new[lev], ld_new);
     }
-
-    sim->nghost = new_nghost;
 }
 
 /** @brief Forces to regrid the coarse level. This is needed whenever the number
@@ -583,7 +717,7 @@ void LevelSynchronizer::RegridCoarse() {
     amrex::DistributionMapping dm(ba, amrex::ParallelDescriptor::NProcs());
 
     // Allocate and fill.
-    LevelData ld_new(ba, dm, ncomp, sim->nghost, time);
+    LevelData ld_new(ba, dm, ncomp, sim->NGhost(lev), time);
 
     amrex::CpuBndryFuncFab bndry_func(nullptr);
     amrex::PhysBCFunct<amrex::CpuBndryFuncFab> physbc(
@@ -598,11 +732,55 @@ void LevelSynchronizer::RegridCoarse() {
                                 0);
 
     std::swap(sim->grid_new[lev], ld_new);
-    sim->grid_old[lev] = LevelData(ba, dm, ncomp, sim->nghost, time);
+    sim->grid_old[lev] = LevelData(ba, dm, ncomp, sim->NGhost(lev), time);
     sim->SetBoxArray(lev, ba);
     sim->SetDistributionMap(lev, dm);
 }
 
+/** @brief Returns the coarse-fine ghost cell cache of a level and (re)builds
+ *         it if the layout of the level has changed.
+ * @param   lev Fine level.
+ * @param   mf  MultiFab to be filled.
+ * @return  Pointer to cache. nullptr if caching is disabled or mf does not
+ *          have the current layout of the level.
+ */
+CoarseFineGhostCache* LevelSynchronizer::GetGhostCache(
+        const int lev, const amrex::MultiFab& mf) {
+    if (!use_ghost_cache)
+        return nullptr;
+
+    // Only the current layout of a level is cached, temporaries e.g. during
+    // a regrid use amrex::FillPatchTwoLevels.
+    if (mf.boxArray() != sim->grid_new[lev].boxArray() ||
+        mf.DistributionMap() != sim->grid_new[lev].DistributionMap())
+        return nullptr;
+
+    if (static_cast<int>(ghost_cache.size()) < lev + 1)
+        ghost_cache.resize(lev + 1);
+
+    if (ghost_cache[lev] == nullptr || !ghost_cache[lev]->Matches(mf)) {
+        sim->performance_monitor->Start(
+            sim->performance_monitor->idx_ghost_cache_build, lev);
+
+        ghost_cache[lev] = std::make_unique<CoarseFineGhostCache>(
+                mf.boxArray(), mf.DistributionMap(), mf.nComp(), mf.nGrow(),
+                sim->geom[lev], sim->refRatio(lev - 1), mapper);
+
+        sim->performance_monitor->Stop(
+            sim->performance_monitor->idx_ghost_cache_build, lev);
+    }
+
+    return ghost_cache[lev].get();
+}
+
+/** @brief Frees the coarse-fine ghost cell cache of a level.
+ * @param   lev Level.
+ */
+void LevelSynchronizer::ClearGhostCache(const int lev) {
+    if (lev < static_cast<int>(ghost_cache.size()))
+        ghost_cache[lev].reset();
+}
+
 /** @brief Fetches level data at a given level and time. Needs to be
  *         amrex::Vector not std::vector.
  * @param   lev     Level at which data is to be fetched.
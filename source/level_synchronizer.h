@@ -4,6 +4,7 @@
 #include <AMReX_BCUtil.H>
 #include <AMReX_Interpolater.H>
 
+#include "coarse_fine_ghost_cache.h"
 #include "sledgehamr.h"
 #include "level_data.h"
 
@@ -38,6 +39,10 @@ class LevelSynchronizer {
     void FillIntermediatePatch(const int lev, const double time,
                                amrex::MultiFab& mf, const int scomp = 0,
                                const int dcomp = 0, const int ncomp = -1);
+    void FillIntermediatePatchBegin(const int lev, const double time,
+                                    amrex::MultiFab& mf);
+    void FillIntermediatePatchEnd(const int lev, const double time,
+                                  amrex::MultiFab& mf);
 
     void AverageDownTo(const int lev);
     void ComputeTruncationErrors(const int lev);
@@ -45,8 +50,9 @@ class LevelSynchronizer {
     void IncreaseCoarseLevelResolution();
     void FromArrayChunksAndUpsample(const int lev, const int comp, double* data,
                                     int up);
-    void ChangeNGhost(int new_nghost);
+    void ChangeNGhost();
     void RegridCoarse();
+    void ClearGhostCache(const int lev);
 
     /** @brief Integer array containing the type of boundary condition at each
      *         boundary edge. Needs to be amrex::Vector not std::vector.
@@ -56,11 +62,22 @@ class LevelSynchronizer {
   private:
     amrex::Vector<amrex::MultiFab*> GetLevelData(const int lev,
                                                  const double time);
+    CoarseFineGhostCache* GetGhostCache(const int lev,
+                                        const amrex::MultiFab& mf);
 
     /** @brief Pointer to AMReX interpolator to be used between levels.
      */
     amrex::Interpolater* mapper = nullptr;
 
+    /** @brief Whether to use a CoarseFineGhostCache instead of
+     *         amrex::FillPatchTwoLevels when filling fine ghost cells.
+     */
+    bool use_ghost_cache = true;
+
+    /** @brief Coarse-fine ghost cell caches for each level.
+     */
+    std::vector<std::unique_ptr<CoarseFineGhostCache> > ghost_cache;
+
     /** @brief Pointer to the simulation.
      */
     Sledgehamr* sim;
@@ -0,0 +1,308 @@
+#include "load_balancer.h"
+#include "sledgehamr.h"
+
+namespace sledgehamr {
+
+/** @brief Reads load balancing parameters.
+ * @param   owner   Pointer to the simulation.
+ */
+LoadBalancer::LoadBalancer(Sledgehamr *owner) : sim(owner) {
+    amrex::ParmParse pp("load_balance");
+    pp.query("strategy", strategy);
+    pp.query("imbalance_threshold", imbalance_threshold);
+    pp.query("only_new_boxes", only_new_boxes);
+    pp.query("smoothing", smoothing);
+    pp.query("verbose", verbose);
+
+    if (strategy < LoadBalanceStrategy::AmrexDefault ||
+        strategy > LoadBalanceStrategy::Knapsack) {
+        amrex::Abort("#error: Unknown load balancing strategy: " +
+                     std::to_string(strategy));
+    }
+
+    cost_per_cell.resize(sim->max_level + 1, 1.);
+    measured.resize(sim->max_level + 1, false);
+}
+
+/** @brief Updates the cost estimate of a level with the duration of a time
+ *         step.
+ * @param   lev     Level that has been advanced.
+ * @param   ncells  Number of cells on that level.
+ * @param   seconds Wall time of the time step.
+ */
+void LoadBalancer::RecordStep(const int lev, const long ncells,
+                              const double seconds) {
+    if (lev < 0 || ncells == 0 || seconds <= 0)
+        return;
+
+    const double cost = seconds / static_cast<double>(ncells);
+    if (measured[lev]) {
+        cost_per_cell[lev] =
+            (1. - smoothing) * cost_per_cell[lev] + smoothing * cost;
+    } else {
+        cost_per_cell[lev] = cost;
+        measured[lev] = true;
+    }
+}
+
+/** @brief Creates a DistributionMapping for a new layout. Starts from the
+ *         AMReX default and rebalances it if needed. Used by global regrids.
+ * @param   lev Level.
+ * @param   ba  BoxArray of the level.
+ * @return  DistributionMapping.
+ */
+amrex::DistributionMapping
+LoadBalancer::MakeDistributionMap(const int lev, const amrex::BoxArray &ba) {
+    amrex::DistributionMapping dm(ba, amrex::ParallelDescriptor::NProcs());
+
+    if (strategy == LoadBalanceStrategy::AmrexDefault || ba.size() == 0)
+        return dm;
+
+    return Rebalance(lev, ba, dm);
+}
+
+/** @brief Rebalances a layout using the selected strategy if its imbalance
+ *         exceeds the threshold.
+ * @param   lev Level.
+ * @param   ba  BoxArray of the level.
+ * @param   dm  Current DistributionMapping.
+ * @return  New DistributionMapping, or dm if it could not be improved upon.
+ */
+amrex::DistributionMapping
+LoadBalancer::Rebalance(const int lev, const amrex::BoxArray &ba,
+                        const amrex::DistributionMapping &dm) {
+    if (strategy == LoadBalanceStrategy::AmrexDefault || ba.size() == 0)
+        return dm;
+
+    // All ranks have to agree on the costs to make the same decision.
+    SyncCosts();
+
+    const double before = Imbalance(lev, ba, dm);
+    if (before <= imbalance_threshold) {
+        Report(lev, before, before, false);
+        return dm;
+    }
+
+    std::vector<double> costs = BoxCosts(lev, ba);
+    std::vector<double> load = OtherLevelsLoad(lev);
+    amrex::DistributionMapping balanced(
+        strategy == LoadBalanceStrategy::Knapsack
+            ? Knapsack(costs, std::move(load))
+            : SpaceFillingCurve(ba, costs, std::move(load)));
+
+    const double after = Imbalance(lev, ba, balanced);
+    if (after >= before) {
+        Report(lev, before, before, false);
+        return dm;
+    }
+
+    Report(lev, before, after, true);
+    return balanced;
+}
+
+/** @brief Assigns owners to boxes that are about to be added to a level
+ *         without migrating any of the existing boxes. Boxes are handed out
+ *         in order of decreasing cost to the least loaded rank.
+ * @param   lev Level.
+ * @param   ba  Boxes to be added.
+ * @return  DistributionMapping of the boxes to be added.
+ */
+amrex::DistributionMapping
+LoadBalancer::DistributeNewBoxes(const int lev, const amrex::BoxArray &ba) {
+    const int nprocs = amrex::ParallelDescriptor::NProcs();
+    amrex::DistributionMapping naive(ba, nprocs);
+
+    if (strategy == LoadBalanceStrategy::AmrexDefault || ba.size() == 0)
+        return naive;
+
+    SyncCosts();
+
+    const amrex::BoxArray &ba_old = sim->grid_new[lev].boxArray();
+    const amrex::DistributionMapping &dm_old = sim->dmap[lev];
+
+    std::vector<double> load = OtherLevelsLoad(lev);
+    std::vector<double> costs_old = BoxCosts(lev, ba_old);
+    for (int b = 0; b < ba_old.size(); ++b)
+        load[dm_old[b]] += costs_old[b];
+
+    amrex::Vector<int> pmap = Knapsack(BoxCosts(lev, ba), std::move(load));
+    amrex::DistributionMapping dm(pmap);
+
+    // Compare the imbalance of the joint layouts.
+    amrex::BoxList bl = ba_old.boxList();
+    bl.join(ba.boxList());
+    amrex::BoxArray ba_joint(std::move(bl));
+
+    amrex::Vector<int> pmap_naive = dm_old.ProcessorMap();
+    amrex::Vector<int> pmap_new = dm_old.ProcessorMap();
+    for (int b = 0; b < ba.size(); ++b) {
+        pmap_naive.push_back(naive[b]);
+        pmap_new.push_back(pmap[b]);
+    }
+
+    const double before =
+        Imbalance(lev, ba_joint, amrex::DistributionMapping(pmap_naive));
+    const double after =
+        Imbalance(lev, ba_joint, amrex::DistributionMapping(pmap_new));
+    Report(lev, before, after, false);
+
+    return dm;
+}
+
+/** @brief Computes the imbalance of a layout, i.e. the estimated total cost
+ *         across all levels of the most loaded rank over the mean cost per
+ *         rank.
+ * @param   lev Level.
+ * @param   ba  BoxArray of the level.
+ * @param   dm  DistributionMapping of the level.
+ * @return  Imbalance. 1 corresponds to a perfectly balanced layout.
+ */
+double LoadBalancer::Imbalance(const int lev, const amrex::BoxArray &ba,
+                               const amrex::DistributionMapping &dm) {
+    const int nprocs = amrex::ParallelDescriptor::NProcs();
+    std::vector<double> load = OtherLevelsLoad(lev);
+    std::vector<double> costs = BoxCosts(lev, ba);
+
+    for (int b = 0; b < ba.size(); ++b)
+        load[dm[b]] += costs[b];
+
+    const double total = std::accumulate(load.begin(), load.end(), 0.);
+    if (total <= 0)
+        return 1.;
+
+    return *std::max_element(load.begin(), load.end()) /
+           (total / static_cast<double>(nprocs));
+}
+
+/** @brief Estimates the cost of each box per coarse level time step.
+ * @param   lev Level.
+ * @param   ba  BoxArray.
+ * @return  Cost of each box.
+ */
+std::vector<double> LoadBalancer::BoxCosts(const int lev,
+                                           const amrex::BoxArray &ba) {
+    const double multiplicity = std::pow(2., lev);
+    std::vector<double> costs(ba.size());
+
+    for (int b = 0; b < ba.size(); ++b) {
+        const double ncells = amrex::grow(ba[b], sim->NGhost(lev)).numPts();
+        costs[b] = ncells * cost_per_cell[lev] * multiplicity;
+    }
+
+    return costs;
+}
+
+/** @brief Computes the load of each rank per coarse level time step summed
+ *         over all current levels except one.
+ * @param   lev Level to be left out.
+ * @return  Load of each rank.
+ */
+std::vector<double> LoadBalancer::OtherLevelsLoad(const int lev) {
+    std::vector<double> load(amrex::ParallelDescriptor::NProcs(), 0.);
+
+    for (int l = 0; l <= sim->finest_level; ++l) {
+        const amrex::BoxArray &ba = sim->boxArray(l);
+        if (l == lev || ba.empty())
+            continue;
+
+        const amrex::DistributionMapping &dm = sim->DistributionMap(l);
+        std::vector<double> costs = BoxCosts(l, ba);
+        for (int b = 0; b < ba.size(); ++b)
+            load[dm[b]] += costs[b];
+    }
+
+    return load;
+}
+
+/** @brief Hands out boxes in order of decreasing cost to the least loaded
+ *         rank.
+ * @param   costs   Cost of each box.
+ * @param   load    Load each rank carries already.
+ * @return  Owner of each box.
+ */
+amrex::Vector<int> LoadBalancer::Knapsack(const std::vector<double> &costs,
+                                          std::vector<double> load) {
+    std::vector<int> order(costs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int a, int b) { return costs[a] > costs[b]; });
+
+    amrex::Vector<int> pmap(costs.size());
+    for (const int b : order) {
+        const int p = std::distance(
+            load.begin(), std::min_element(load.begin(), load.end()));
+        pmap[b] = p;
+        load[p] += costs[b];
+    }
+
+    return pmap;
+}
+
+/** @brief Sorts boxes along a Morton curve and cuts the curve into one
+ *         contiguous piece per rank such that every rank ends up with the
+ *         same total load including the load it carries already.
+ * @param   ba      BoxArray.
+ * @param   costs   Cost of each box.
+ * @param   load    Load each rank carries already.
+ * @return  Owner of each box.
+ */
+amrex::Vector<int> LoadBalancer::SpaceFillingCurve(
+        const amrex::BoxArray &ba, const std::vector<double> &costs,
+        std::vector<double> load) {
+    const int nprocs = load.size();
+    std::vector<std::uint64_t> keys(ba.size());
+    for (int b = 0; b < ba.size(); ++b)
+        keys[b] = MortonClustering::Encode(ba[b].smallEnd());
+
+    std::vector<int> order(ba.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int a, int b) { return keys[a] < keys[b]; });
+
+    const double target =
+        (std::accumulate(load.begin(), load.end(), 0.) +
+         std::accumulate(costs.begin(), costs.end(), 0.)) / nprocs;
+
+    amrex::Vector<int> pmap(ba.size());
+    int p = 0;
+    for (const int b : order) {
+        // Move on once the box would mostly end up above the target.
+        while (p < nprocs - 1 && load[p] + costs[b] / 2. > target)
+            ++p;
+        pmap[b] = p;
+        load[p] += costs[b];
+    }
+
+    return pmap;
+}
+
+/** @brief Broadcasts the cost estimates of the I/O rank. Timings differ
+ *         between ranks and all ranks need to compute the same layout.
+ */
+void LoadBalancer::SyncCosts() {
+    amrex::ParallelDescriptor::Bcast(
+        cost_per_cell.data(), cost_per_cell.size(),
+        amrex::ParallelDescriptor::IOProcessorNumber());
+}
+
+/** @brief Logs the imbalance of a level before and after balancing. Only
+ *         prints it if the level has been rebalanced or if verbose.
+ * @param   lev         Level.
+ * @param   before      Imbalance before balancing.
+ * @param   after       Imbalance after balancing.
+ * @param   rebalanced  Whether boxes have been migrated.
+ */
+void LoadBalancer::Report(const int lev, const double before,
+                          const double after, const bool rebalanced) {
+    if (rebalanced || verbose) {
+        amrex::Print() << "  Load imbalance on level " << lev << ": " << before
+                       << " -> " << after << std::endl;
+    }
+
+    sim->performance_monitor->Count(
+        sim->performance_monitor->idx_load_imbalance_before, before, lev);
+    sim->performance_monitor->Count(
+        sim->performance_monitor->idx_load_imbalance_after, after, lev);
+}
+
+}; // namespace sledgehamr
@@ -0,0 +1,101 @@
+#ifndef SLEDGEHAMR_LOAD_BALANCER_H_
+#define SLEDGEHAMR_LOAD_BALANCER_H_
+
+#include <AMReX_BoxArray.H>
+#include <AMReX_DistributionMapping.H>
+
+namespace sledgehamr {
+
+class Sledgehamr;
+
+/** @brief Enum containing all valid load balancing strategies. These are the
+ *         values that are being used in the inputs file under
+ *         'load_balance.strategy'.
+ */
+enum LoadBalanceStrategy {
+    AmrexDefault = 0,
+    SpaceFillingCurve = 1,
+    Knapsack = 2
+};
+
+/** @brief Distributes boxes across MPI ranks based on estimated costs. The
+ *         cost of a box is its number of cells including ghost cells times
+ *         the measured wall time per cell and time step of its level times the
+ *         number of time steps the level performs per coarse level time step.
+ *         Levels are advanced one after another, so a rank's total load is
+ *         the sum over all levels. When a level is distributed the load every
+ *         rank already carries on the other levels is taken into account.
+ *         A layout is only rebalanced if its imbalance, i.e. the ratio of the
+ *         most loaded rank to the mean load, exceeds a threshold.
+ */
+class LoadBalancer {
+  public:
+    LoadBalancer(Sledgehamr *owner);
+
+    void RecordStep(const int lev, const long ncells, const double seconds);
+
+    amrex::DistributionMapping MakeDistributionMap(const int lev,
+                                                   const amrex::BoxArray &ba);
+    amrex::DistributionMapping Rebalance(const int lev,
+                                         const amrex::BoxArray &ba,
+                                         const amrex::DistributionMapping &dm);
+    amrex::DistributionMapping DistributeNewBoxes(const int lev,
+                                                  const amrex::BoxArray &ba);
+
+    double Imbalance(const int lev, const amrex::BoxArray &ba,
+                     const amrex::DistributionMapping &dm);
+
+    /** @brief Whether a local regrid only assigns owners to the boxes it adds
+     *         or is allowed to migrate existing boxes as well.
+     */
+    bool only_new_boxes = true;
+
+  private:
+    std::vector<double> BoxCosts(const int lev, const amrex::BoxArray &ba);
+    std::vector<double> OtherLevelsLoad(const int lev);
+    amrex::Vector<int> Knapsack(const std::vector<double> &costs,
+                                std::vector<double> load);
+    amrex::Vector<int> SpaceFillingCurve(const amrex::BoxArray &ba,
+                                         const std::vector<double> &costs,
+                                         std::vector<double> load);
+    void SyncCosts();
+    void Report(const int lev, const double before, const double after,
+                const bool rebalanced);
+
+    /** @brief Selected load balancing strategy, see LoadBalanceStrategy.
+     *         Defaults to the AMReX distribution, cost-based strategies are
+     *         opt-in.
+     */
+    int strategy = LoadBalanceStrategy::AmrexDefault;
+
+    /** @brief Imbalance above which a layout is rebalanced.
+     */
+    double imbalance_threshold = 1.1;
+
+    /** @brief Weight of the most recent measurement in the running average of
+     *         the cost per cell.
+     */
+    double smoothing = 0.2;
+
+    /** @brief Whether the imbalance is printed on every regrid or only if a
+     *         level has been rebalanced.
+     */
+    bool verbose = false;
+
+    /** @brief Running average of the wall time per cell and time step on each
+     *         level. Unit cost until the level has been measured.
+     */
+    std::vector<double> cost_per_cell;
+
+    /** @brief Whether the cost of a level has been measured yet.
+     */
+    std::vector<bool> measured;
+
+    /** @brief Pointer to the simulation.
+     */
+    Sledgehamr *sim;
+};
+
+}; // namespace sledgehamr
+
+#endif // SLEDGEHAMR_LOAD_BALANCER_H_
@@ -0,0 +1,96 @@
+#include "legacy_unique_layout.h"
+
+namespace sledgehamr {
+
+/** @brief  Set up empty layout structure.
+ * @param   N   Number of potential boxes along one dimension
+ *              = dimN / blocking_factor.
+ */
+LegacyUniqueLayout::LegacyUniqueLayout(const int N) : Np(N) {
+    p = std::make_unique<plane[]>(Np);
+}
+
+/** @brief  Add location.
+ * @param   i   i-th index.
+ * @param   j   j-th index.
+ * @param   k   k-th index.
+ */
+void LegacyUniqueLayout::Add(const uit i, const uit j, const uit k) const {
+    if (!p[i].count(j))
+        p[i][j] = std::set<uit>();
+
+    p[i][j].insert(k);
+}
+
+/** @brief Creates one unique layout structure from an array of layouts.
+ * @param   uls Array of layouts.
+ */
+void LegacyUniqueLayout::Merge(
+        std::vector<std::unique_ptr<LegacyUniqueLayout> >& uls) {
+    // Merge all planes. Inner loop parallelized to maintain thread-safety.
+    for (int l = 1; l < uls.size(); ++l) {
+#pragma omp parallel for
+        for (uit cp = 0; cp < Np; ++cp) {
+            MergePlane(cp, &(uls[l]->p[cp]));
+        }
+    }
+}
+
+/** @brief Constructs BoxList from layout structure.
+ * @param   blocking_factor Blocking factor for BoxList.
+ * @return BoxList.
+ */
+amrex::BoxList LegacyUniqueLayout::BoxList(const int blocking_factor) {
+    amrex::BoxList bl;
+    int j,k0,km;
+
+    for (uit i=0; i<Np; ++i) {
+        for (const std::pair<const uit, row>& n : p[i]) {
+            j = n.first;
+
+            k0=-1;
+            for (const int &k : n.second) {
+                if (k0 == -1) {
+                    k0 = k;
+                    km = k;
+                } else if (k == km + 1) {
+                     km = k;
+                } else {
+                    amrex::IntVect sm(i,   j,   k0);
+                    amrex::IntVect bg(i+1, j+1, km+1);
+                    bl.push_back(amrex::Box(sm*blocking_factor,
+                                            bg*blocking_factor-1));
+                    k0 = k;
+                    km = k;
+                }
+            }
+
+            if (k0 != -1) {
+                amrex::IntVect sm(i,   j,   k0);
+                amrex::IntVect bg(i+1, j+1, km+1);
+                bl.push_back(amrex::Box(sm*blocking_factor,
+                                        bg*blocking_factor-1));
+            }
+        }
+    }
+
+    return bl;
+}
+
+/** @brief Merges individual planes to ensure uniqueness.
+ * @param   cp  Current plane.
+ * @param   pm  Plane to merge.
+ */
+void LegacyUniqueLayout::MergePlane(const uit cp, plane* pm) {
+    p[cp].merge(*pm);
+
+    for (const std::pair<const uit,row>& n : *pm) {
+        row r;
+        std::merge(p[cp][n.first].begin(), p[cp][n.first].end(),
+                   n.second.begin(), n.second.end(),
+                   std::inserter(r, r.begin()));
+        p[cp][n.first] = r;
+    }
+}
+
+}; // namespace sledgehamr
@@ -0,0 +1,42 @@
+#ifndef SLEDGEHAMR_LEGACY_UNIQUE_LAYOUT_H_
+#define SLEDGEHAMR_LEGACY_UNIQUE_LAYOUT_H_
+
+#include <set>
+#include <unordered_map>
+
+#include "unique_layout.h"
+
+namespace sledgehamr {
+
+/** @brief Previous implementation of UniqueLayout in which each plane is an
+ *         unordered_map of std::set rows. Only kept as a reference to
+ *         benchmark UniqueLayout against on recorded tags, see
+ *         LocalRegrid::BenchmarkLayout. Works on a single MPI rank only.
+ */
+class LegacyUniqueLayout {
+  public:
+    typedef std::set<uit> row;
+    typedef std::unordered_map<uit, row> plane;
+
+    LegacyUniqueLayout(const int N);
+
+    void Add(const uit i, const uit j, const uit k) const;
+    void Merge(std::vector<std::unique_ptr<LegacyUniqueLayout> >& uls);
+
+    amrex::BoxList BoxList(const int blocking_factor);
+
+  private:
+    void MergePlane(const uit cp, plane* pm);
+
+    /** Total number of planes.
+     */
+    const uit Np;
+
+    /** Array of Np planes.
+     */
+    std::unique_ptr<plane[]> p;
+};
+
+}; // namespace sledgehamr
+
+#endif // SLEDGEHAMR_LEGACY_UNIQUE_LAYOUT_H_
@@ -1,7 +1,33 @@
 #include "local_regrid.h"
+#include "fft.h"
+#include "legacy_unique_layout.h"
 
 namespace sledgehamr {
 
+namespace {
+
+/** @brief Adds the fine level blocks that contain recorded tags to one layout
+ *         per OpenMP thread.
+ * @param   runs    Runs of tagged cells along the x-axis.
+ * @param   bff     Blocking factor of the fine level.
+ * @param   layouts Layout of each thread.
+ */
+template <typename T>
+void AddRecordedTags(const amrex::BoxArray &runs, const int bff,
+                     std::vector<std::unique_ptr<T>> &layouts) {
+#pragma omp parallel for
+    for (int r = 0; r < runs.size(); ++r) {
+        const T *layout = layouts[omp_get_thread_num()].get();
+        const amrex::Box &run = runs[r];
+        const int j = 2 * run.smallEnd(1) / bff;
+        const int k = 2 * run.smallEnd(2) / bff;
+        for (int i = run.smallEnd(0); i <= run.bigEnd(0); ++i)
+            layout->Add(2 * i / bff, j, k);
+    }
+}
+
+}; // namespace
+
 /** @brief Initalize all needed structures.
  * @param   owner   Pointer to simulation.
  */
@@ -40,8 +66,11 @@ void LocalRegrid::DidGlobalRegrid(const int lev) {
 
     for (int l = lev + 1; l < last_numPts.size(); ++l) {
         last_numPts[l] = sim->grid_new[l].boxArray().numPts();
-        sim->grid_old[l].contains_truncation_errors = false;
+        sim->grid_old[l].ClearTruncationErrors();
     }
+
+    for (int l = lev + 1; l <= sim->max_level; ++l)
+        sim->time_stepper->scheduler->InvalidateFront(l);
 }
 
 /** @brief Creates all layout structures needed for the local regrid.
@@ -93,8 +122,17 @@ void LocalRegrid::AddToLayout(const int lev, const int thread, const int i,
  * @param   lev Corresponding level.
  */
 void LocalRegrid::FinalizeLayout(const int lev) {
+    sim->performance_monitor->Start(
+        sim->performance_monitor->idx_local_regrid_merge, regrid_lev);
     layouts[lev][0]->Merge(layouts[lev]);
+    sim->performance_monitor->Stop(
+        sim->performance_monitor->idx_local_regrid_merge, regrid_lev);
+
+    sim->performance_monitor->Start(
+        sim->performance_monitor->idx_local_regrid_distribute, regrid_lev);
     layouts[lev][0]->Distribute();
+    sim->performance_monitor->Stop(
+        sim->performance_monitor->idx_local_regrid_distribute, regrid_lev);
 }
 
 /** @brief Checks pre-conditions whether we even need to attempt a local
@@ -170,8 +208,35 @@ void LocalRegrid::DetermineAllBoxArrays(const int lev) {
     // nesting at this point.
     min_distance.clear();
     min_distance.resize(sim->finest_level + 1, -1.);
+    distance_measured.clear();
+    distance_measured.resize(sim->finest_level + 1, false);
     for (int l = lev; l < sim->finest_level && !no_local_regrid[l]; ++l) {
         min_distance[l + 1] = DetermineNewBoxArray(l);
+        distance_measured[l + 1] = true;
+    }
+}
+
+/** @brief Passes the measured distances between tagged cells and coarse/fine
+ *         boundaries on to the regrid scheduler.
+ * @param   lev         Coarsest level for tagging.
+ * @param   box_arrays  Array of BoxArray's to be added to each level.
+ */
+void LocalRegrid::RecordFronts(const int lev,
+                               std::vector<amrex::BoxArray> &box_arrays) {
+    for (int l = lev + 1; l <= sim->finest_level; ++l) {
+        if (!distance_measured[l]) {
+            sim->time_stepper->scheduler->InvalidateFront(l);
+            continue;
+        }
+
+        // No tagged cell within a blocking factor of the boundary.
+        double distance = min_distance[l] >= 0
+                              ? min_distance[l]
+                              : sim->blocking_factor[l][0];
+
+        sim->time_stepper->scheduler->RecordFront(
+            l, sim->grid_new[l].t, distance, box_arrays[l].size() > 0,
+            sim->time_stepper->regrid_dt[l], n_error_buf);
     }
 }
 
@@ -376,8 +441,11 @@ bool LocalRegrid::DoAttemptRegrid(const int lev) {
                    << "Attempting local regrid at level " << lev + 1
                    << " and higher." << std::endl;
 
+    regrid_lev = lev;
     InitializeLocalRegrid();
+    sim->regrid_recorder->Begin(lev);
     DetermineAllBoxArrays(lev);
+    sim->regrid_recorder->Finish(last_numPts);
     FixAllNesting();
     std::vector<amrex::BoxArray> box_arrays(sim->finest_level + 1);
     JoinAllBoxArrays(box_arrays);
@@ -387,6 +455,7 @@ bool LocalRegrid::DoAttemptRegrid(const int lev) {
         case VetoResult::DoGlobalRegrid:
             return false;
         case VetoResult::DoNoRegrid:
+            RecordFronts(lev, box_arrays);
             return true;
         case VetoResult::DoLocalRegrid:
             //[[fallthrough]];
@@ -396,10 +465,184 @@ bool LocalRegrid::DoAttemptRegrid(const int lev) {
     }
 
     AddAllBoxes(box_arrays);
+    RecordFronts(lev, box_arrays);
 
     return true;
 }
 
+/** @brief Replays all recorded local regrids without touching any data, see
+ *         RegridRecorder. Prints the boxes that would have been added, the
+ *         resulting tagging efficiency and timings of each stage.
+ */
+void LocalRegrid::Replay() {
+    for (int id = 0; sim->regrid_recorder->Load(id); ++id) {
+        const RegridRecord &record = sim->regrid_recorder->GetRecord();
+        amrex::Print() << std::endl
+                       << "Replaying regrid " << id << " at level "
+                       << record.lev + 1 << " and higher, t = "
+                       << record.time[record.lev] << std::endl;
+
+        ApplyRecord(record);
+        DryRun(record);
+
+        if (benchmark_layout > 0)
+            BenchmarkLayout(record);
+    }
+}
+
+/** @brief Sets up the grid hierarchy of a record without allocating any data.
+ * @param   record  Record to be replayed.
+ */
+void LocalRegrid::ApplyRecord(const RegridRecord &record) {
+    sim->finest_level = record.finest_level;
+
+    for (int l = 0; l <= record.finest_level; ++l) {
+        const amrex::BoxArray &ba = record.grids[l];
+        amrex::DistributionMapping dm =
+            sim->load_balancer->MakeDistributionMap(l, ba);
+
+        sim->grid_new[l] =
+            LevelData(ba, dm, sim->scalar_fields.size(), sim->NGhost(l),
+                      amrex::MFInfo().SetAlloc(false));
+        sim->grid_new[l].t = record.time[l];
+        sim->grid_new[l].istep = record.istep[l];
+        sim->SetBoxArray(l, ba);
+        sim->SetDistributionMap(l, dm);
+    }
+
+    last_numPts = record.last_numPts;
+    for (int l = wrapped_index.size(); l <= record.finest_level; ++l)
+        WrapIndices(l);
+}
+
+/** @brief Runs the local regrid on a recorded hierarchy without adding any
+ *         boxes.
+ * @param   record  Record to be replayed.
+ */
+void LocalRegrid::DryRun(const RegridRecord &record) {
+    const int lev = record.lev;
+    regrid_lev = lev;
+    veto_level = -1;
+
+    utils::sctp timer = utils::StartTimer();
+    InitializeLayout(sim->finest_level);
+    DetermineAllBoxArrays(lev);
+    const double t_determine = utils::DurationSeconds(timer);
+
+    timer = utils::StartTimer();
+    FixAllNesting();
+    const double t_nesting = utils::DurationSeconds(timer);
+
+    timer = utils::StartTimer();
+    std::vector<amrex::BoxArray> box_arrays(sim->finest_level + 1);
+    JoinAllBoxArrays(box_arrays);
+    const double t_join = utils::DurationSeconds(timer);
+
+    const bool veto = CheckForVeto(lev, box_arrays);
+    ClearLayout();
+
+    for (int l = lev + 1; l <= sim->finest_level; ++l) {
+        // Tagged cells of the coarse level in units of fine cells.
+        const double ntags =
+            8. * static_cast<double>(record.tags[l - 1].numPts());
+        const double ncells = static_cast<double>(
+            sim->grid_new[l].boxArray().numPts() + box_arrays[l].numPts());
+
+        amrex::Print() << "  Level " << l << ": " << box_arrays[l].size()
+                       << " boxes added, tagging efficiency "
+                       << (ncells > 0 ? ntags / ncells : 0.) << std::endl;
+    }
+
+    if (veto) {
+        amrex::Print() << "  Local regrid vetoed. Global regrid on level "
+                       << veto_level << " deemed optimal." << std::endl;
+    }
+
+    amrex::Print() << "  Timings: DetermineNewBoxArray " << t_determine
+                   << "s, FixNesting " << t_nesting << "s, JoinBoxArrays "
+                   << t_join << "s" << std::endl;
+}
+
+/** @brief Times adding, merging and converting the recorded tags of each
+ *         level with UniqueLayout and with the previous node-based
+ *         LegacyUniqueLayout, and checks that both yield the same boxes.
+ *         Each tagged cell is added as the fine level block containing it.
+ * @param   record  Record to be replayed.
+ */
+void LocalRegrid::BenchmarkLayout(const RegridRecord &record) {
+    const int nthreads = omp_get_max_threads();
+
+    for (int l = record.lev; l < record.finest_level; ++l) {
+        const amrex::BoxArray &runs = record.tags[l];
+        if (runs.empty())
+            continue;
+
+        const int bff = sim->blocking_factor[l + 1][0];
+        const int N = sim->dimN[l + 1] / bff;
+
+        // Add, Merge and BoxList.
+        double t_new[3] = {0, 0, 0};
+        double t_old[3] = {0, 0, 0};
+        amrex::BoxList bl_new, bl_old;
+
+        for (int r = 0; r < benchmark_layout; ++r) {
+            std::vector<std::unique_ptr<UniqueLayout>> uls;
+            std::vector<std::unique_ptr<LegacyUniqueLayout>> lls;
+            for (int t = 0; t < nthreads; ++t) {
+                uls.emplace_back(std::make_unique<UniqueLayout>(this, N));
+                lls.emplace_back(std::make_unique<LegacyUniqueLayout>(N));
+            }
+
+            utils::sctp timer = utils::StartTimer();
+            AddRecordedTags(runs, bff, uls);
+            t_new[0] += utils::DurationSeconds(timer);
+
+            timer = utils::StartTimer();
+            uls[0]->Merge(uls);
+            uls[0]->Distribute();
+            t_new[1] += utils::DurationSeconds(timer);
+
+            timer = utils::StartTimer();
+            bl_new = uls[0]->BoxList(bff);
+            t_new[2] += utils::DurationSeconds(timer);
+
+            timer = utils::StartTimer();
+            AddRecordedTags(runs, bff, lls);
+            t_old[0] += utils::DurationSeconds(timer);
+
+            timer = utils::StartTimer();
+            lls[0]->Merge(lls);
+            t_old[1] += utils::DurationSeconds(timer);
+
+            timer = utils::StartTimer();
+            bl_old = lls[0]->BoxList(bff);
+            t_old[2] += utils::DurationSeconds(timer);
+        }
+
+        const amrex::BoxArray ba_new(bl_new);
+        const amrex::BoxArray ba_old(bl_old);
+        if (ba_new.numPts() != ba_old.numPts() || !ba_new.contains(ba_old)) {
+            amrex::Abort("#error: UniqueLayout and LegacyUniqueLayout "
+                         "disagree on level " + std::to_string(l + 1) + ".");
+        }
+
+        const double total_new = t_new[0] + t_new[1] + t_new[2];
+        const double total_old = t_old[0] + t_old[1] + t_old[2];
+        amrex::Print() << "  Layout benchmark level " << l + 1 << ": "
+                       << runs.size() << " tagged runs, " << ba_new.size()
+                       << " boxes, " << benchmark_layout << " repetitions"
+                       << std::endl
+                       << "    UniqueLayout:       Add " << t_new[0]
+                       << "s, Merge " << t_new[1] << "s, BoxList "
+                       << t_new[2] << "s" << std::endl
+                       << "    LegacyUniqueLayout: Add " << t_old[0]
+                       << "s, Merge " << t_old[1] << "s, BoxList "
+                       << t_old[2] << "s" << std::endl
+                       << "    Speedup " << total_old / total_new
+                       << std::endl;
+    }
+}
+
 /** @brief Parses all input parameters related to a local regrid.
  */
 void LocalRegrid::ParseInput() {
@@ -410,6 +653,12 @@ void LocalRegrid::ParseInput() {
     pp_amr.query("max_local_regrids", max_local_regrids);
     pp_amr.query("volume_threshold_strong", volume_threshold_single);
     pp_amr.query("volume_threshold_weak", volume_threshold_accumulated);
+    pp_amr.query("benchmark_unique_layout", benchmark_layout);
+
+    if (benchmark_layout > 0 && amrex::ParallelDescriptor::NProcs() > 1) {
+        amrex::Abort("#error: amr.benchmark_unique_layout needs to be run on "
+                     "a single MPI rank.");
+    }
 }
 
 /** @brief Creates a N x N communication matrix M_{ij} between N MPI ranks. The
@@ -454,40 +703,64 @@ void LocalRegrid::WrapIndices(const int lev) {
     wrapped_index.push_back(indices);
 }
 
-/** @brief Determines whether a box has neighbouring coarse/fine boundaries.
- * @param   tilebox Current box to check.
- * @param   c0      Tilebox lower box index.
- * @param   c1      Tilebox upper box index.
- * @param   lev     Current level.
- * @param   border  Boolean map indicating whether a coarse/fine boundary is
- *                  present.
- * @return Total number of neighbouring coarse fine boundaries.
+/** @brief Builds a mask on the lattice of blocks of level lev+1, i.e. one
+ *         cell per blocking_factor^3 fine cells, which indicates whether a
+ *         block is covered by lev+1. The mask lives on the layout of level lev
+ *         coarsened onto that lattice and has one ghost cell which is filled
+ *         across periodic boundaries.
+ * @param   lev Coarse level.
+ * @return Coverage mask. 1 if covered and 0 otherwise.
  */
-inline int
-LocalRegrid::GetBoxCoarseFineBorders(const amrex::Box &tilebox,
-                                     const amrex::IntVect &c0,
-                                     const amrex::IntVect &c1, const int lev,
-                                     boost::multi_array<bool, 3> &border) {
-    const amrex::BoxArray &ba = sim->grid_new[lev + 1].boxArray();
+amrex::iMultiFab LocalRegrid::BuildCoverageMask(const int lev) {
+    const int ibff = sim->blocking_factor[lev + 1][0];
+    const int N = sim->dimN[lev + 1] / ibff;
 
-    const amrex::IntVect xs = c1 - c0 + 1;
-    const amrex::IntVect xsb = xs + 2;
+    amrex::BoxArray fine_blocks = sim->grid_new[lev + 1].boxArray();
+    fine_blocks.coarsen(ibff);
+    amrex::BoxArray blocks = sim->grid_new[lev].boxArray();
+    blocks.coarsen(ibff / 2);
 
-    int remaining = 0;
-    border.resize(boost::extents[xsb[0]][xsb[1]][xsb[2]]);
-    for (int k = -1; k <= xs[2]; ++k) {
-        for (int j = -1; j <= xs[1]; ++j) {
-            for (int i = -1; i <= xs[0]; ++i) {
-                border[i + 1][j + 1][k + 1] = !ba.contains(
-                    amrex::IntVect(wrapped_index[lev + 1][c0[0] + i],
-                                   wrapped_index[lev + 1][c0[1] + j],
-                                   wrapped_index[lev + 1][c0[2] + k]));
-
-                remaining += border[i + 1][j + 1][k + 1];
-            }
+    // Blocks outside of lev cannot be covered by lev+1 due to proper nesting
+    // so ghost cells not filled by FillBoundary remain zero.
+    amrex::iMultiFab coverage(blocks, sim->grid_new[lev].DistributionMap(), 1,
+                              1);
+    coverage.setVal(0);
+
+#pragma omp parallel
+    for (amrex::MFIter mfi(coverage, false); mfi.isValid(); ++mfi) {
+        const amrex::Array4<int> &coverage_arr = coverage.array(mfi);
+
+        std::vector<std::pair<int, amrex::Box>> isects =
+            fine_blocks.intersections(mfi.validbox());
+        for (const std::pair<int, amrex::Box> &isect : isects) {
+            amrex::LoopOnCpu(isect.second, [&](int i, int j, int k) noexcept {
+                coverage_arr(i, j, k) = 1;
+            });
         }
     }
 
+    coverage.FillBoundary(amrex::Periodicity(amrex::IntVect(N, N, N)));
+    return coverage;
+}
+
+/** @brief Determines whether a box has neighbouring coarse/fine boundaries.
+ * @param   block_box   Blocks touched by the current box including one block
+ *                      in each direction.
+ * @param   coverage    Coverage mask of the fine level.
+ * @param   border      Map indicating whether a coarse/fine boundary is
+ *                      present.
+ * @return Total number of neighbouring coarse fine boundaries.
+ */
+inline int
+LocalRegrid::GetBoxCoarseFineBorders(const amrex::Box &block_box,
+                                     const amrex::Array4<int const> &coverage,
+                                     const amrex::Array4<int> &border) {
+    int remaining = 0;
+    amrex::LoopOnCpu(block_box, [&](int i, int j, int k) noexcept {
+        border(i, j, k) = 1 - coverage(i, j, k);
+        remaining += border(i, j, k);
+    });
+
     return remaining;
 }
 
@@ -498,8 +771,6 @@ LocalRegrid::GetBoxCoarseFineBorders(const amrex::Box &tilebox,
  * @param   remaining   Number of adjecent coarse/fine boundaries that could
  *                      still be pushed further.
  * @param   tag_arr     TagArray containing all tags.
- * @param   c0          Lower box index of current box.
- * @param   c1          Upper box index of current box.
  * @param   lev         Current coarse level.
  * @param   ibff        Fine coarse level blocking factor of type int.
  * @param   bff         Fine coarse level blocking factor but cast to double.
@@ -513,9 +784,8 @@ LocalRegrid::GetBoxCoarseFineBorders(const amrex::Box &tilebox,
 inline void
 LocalRegrid::TagAndMeasure(const amrex::Dim3 &lo, const amrex::Dim3 &hi,
                            int remaining, const amrex::Array4<char> &tag_arr,
-                           const amrex::IntVect &c0, const amrex::IntVect &c1,
                            const int lev, const int ibff, const double bff,
-                           boost::multi_array<bool, 3> &border,
+                           const amrex::Array4<int> &border,
                            std::vector<Location> &closest_locations,
                            const double threshold, const int omp_thread_num) {
     // Now find tags and determine distances.
@@ -530,7 +800,7 @@ LocalRegrid::TagAndMeasure(const amrex::Dim3 &lo, const amrex::Dim3 &hi,
                     continue;
 
                 amrex::IntVect ci(i, j, k);
-                CheckBorders(ci, c0, c1, ibff, bff, remaining, lev, border,
+                CheckBorders(ci, ibff, bff, remaining, lev, border,
                              closest_locations, threshold, omp_thread_num);
             }
         }
@@ -540,9 +810,7 @@ LocalRegrid::TagAndMeasure(const amrex::Dim3 &lo, const amrex::Dim3 &hi,
 /** @brief Given a location we measure the distance to all adjacent coarse/fine
  *         boundaries. We add to our layout structure if the location is too
  *         close.
- * @param   ci  Index to be checked.
- * @param   c0          Lower box index of current box.
- * @param   c1          Upper box index of current box.
+ * @param   ci          Index to be checked.
  * @param   ibff        Fine coarse level blocking factor of type int.
  * @param   bff         Fine coarse level blocking factor but cast to double.
  * @param   remaining   Number of adjecent coarse/fine boundaries that could
@@ -556,10 +824,9 @@ LocalRegrid::TagAndMeasure(const amrex::Dim3 &lo, const amrex::Dim3 &hi,
  * @param   omp_thread_num      Current OpenMP thread.
  */
 inline void
-LocalRegrid::CheckBorders(const amrex::IntVect &ci, const amrex::IntVect &c0,
-                          const amrex::IntVect &c1, const int ibff,
+LocalRegrid::CheckBorders(const amrex::IntVect &ci, const int ibff,
                           const double bff, int remaining, const int lev,
-                          boost::multi_array<bool, 3> &border,
+                          const amrex::Array4<int> &border,
                           std::vector<Location> &closest_locations,
                           const double threshold, const int omp_thread_num) {
     amrex::IntVect fi = ci * 2;
@@ -572,9 +839,9 @@ LocalRegrid::CheckBorders(const amrex::IntVect &ci, const amrex::IntVect &c0,
         for (int jj = -1; jj <= 1; ++jj) {
             for (int ii = -1; ii <= 1; ++ii) {
                 amrex::IntVect cii(ii, jj, kk);
-                amrex::IntVect ref = cfi - c0 + cii + 1;
+                amrex::IntVect ref = cfi + cii - 1;
 
-                if (!border[ref[0]][ref[1]][ref[2]])
+                if (!border(ref[0], ref[1], ref[2]))
                     continue;
 
                 amrex::IntVect smt = ibff * (cfi + cii - 1);
@@ -593,7 +860,7 @@ LocalRegrid::CheckBorders(const amrex::IntVect &ci, const amrex::IntVect &c0,
 
                 // Add new box if below threshold.
                 if (d_sq < threshold) {
-                    border[ref[0]][ref[1]][ref[2]] = false;
+                    border(ref[0], ref[1], ref[2]) = 0;
                     remaining--;
                     layouts[lev + 1][omp_thread_num]->Add(
                         static_cast<int>(
@@ -634,14 +901,25 @@ double LocalRegrid::DetermineNewBoxArray(const int lev) {
     const double bff = static_cast<double>(ibff);
 
     // Tag cells.
+    sim->performance_monitor->Start(
+        sim->performance_monitor->idx_local_regrid_tag, regrid_lev);
     amrex::TagBoxArray tags(state.boxArray(), state.DistributionMap());
-    sim->ErrorEst(lev, tags, state.t, 0);
+    if (sim->regrid_recorder->replaying) {
+        sim->regrid_recorder->FillTags(lev, tags);
+    } else {
+        sim->ErrorEst(lev, tags, state.t, 0);
+        sim->regrid_recorder->RecordTags(lev, tags);
+    }
+    sim->performance_monitor->Stop(
+        sim->performance_monitor->idx_local_regrid_tag, regrid_lev);
 
+    sim->performance_monitor->Start(
+        sim->performance_monitor->idx_local_regrid_border, regrid_lev);
+    const amrex::iMultiFab coverage = BuildCoverageMask(lev);
     std::vector<Location> closest_locations(omp_get_max_threads());
 
 #pragma omp parallel
     for (amrex::MFIter mfi(state, false); mfi.isValid(); ++mfi) {
-        const amrex::Array4<double const> &state_fab = state.array(mfi);
         const amrex::Array4<char> &tag_arr = tags.array(mfi);
 
         const amrex::Box &tilebox = mfi.tilebox();
@@ -657,15 +935,19 @@ double LocalRegrid::DetermineNewBoxArray(const int lev) {
             static_cast<int>(static_cast<double>(hi.z * 2) / bff) + 1);
 
         // Determine if tilebox is near a C/F border.
-        boost::multi_array<bool, 3> border;
-        int remaining = GetBoxCoarseFineBorders(tilebox, c0, c1, lev, border);
+        const amrex::Box block_box = amrex::grow(amrex::Box(c0 - 1, c1 - 1), 1);
+        amrex::IArrayBox border(block_box, 1, amrex::The_Cpu_Arena());
+        int remaining = GetBoxCoarseFineBorders(
+            block_box, coverage.const_array(mfi), border.array());
         if (remaining == 0)
             continue;
 
-        TagAndMeasure(lo, hi, remaining, tag_arr, c0, c1, lev, ibff, bff,
-                      border, closest_locations, threshold,
+        TagAndMeasure(lo, hi, remaining, tag_arr, lev, ibff, bff,
+                      border.array(), closest_locations, threshold,
                       omp_get_thread_num());
     }
+    sim->performance_monitor->Stop(
+        sim->performance_monitor->idx_local_regrid_border, regrid_lev);
 
     // Combine box layouts.
     FinalizeLayout(lev + 1);
@@ -697,39 +979,32 @@ double LocalRegrid::DetermineNewBoxArray(const int lev) {
 void LocalRegrid::FixNesting(const int lev) {
     amrex::BoxArray nest_ba =
         layouts[lev][0]->BoxArray(sim->blocking_factor[lev][0]);
-    nest_ba.growcoarsen(sim->nghost + 4, amrex::IntVect(2, 2, 2));
+    nest_ba.growcoarsen(sim->NGhost(lev) + 4, amrex::IntVect(2, 2, 2));
     nest_ba = WrapBoxArray(nest_ba, sim->dimN[lev - 1]);
-    amrex::BoxArray bak = sim->grid_new[lev - 1].boxArray();
-    const double bfc = static_cast<double>(sim->blocking_factor[lev - 1][0]);
+    const amrex::BoxArray &bak = sim->grid_new[lev - 1].boxArray();
+    const int bfc = sim->blocking_factor[lev - 1][0];
 
 #pragma omp parallel for
     for (int b = 0; b < nest_ba.size(); ++b) {
-        amrex::Box box = nest_ba.boxList().data()[b];
-        const int cxl = static_cast<double>(box.smallEnd(0)) / bfc + 1.;
-        const int cyl = static_cast<double>(box.smallEnd(1)) / bfc + 1.;
-        const int czl = static_cast<double>(box.smallEnd(2)) / bfc + 1.;
-        const int cxh = static_cast<double>(box.bigEnd(0)) / bfc + 2.;
-        const int cyh = static_cast<double>(box.bigEnd(1)) / bfc + 2.;
-        const int czh = static_cast<double>(box.bigEnd(2)) / bfc + 2.;
-
-        for (int cxi = cxl; cxi <= cxh; ++cxi) {
-            for (int cyi = cyl; cyi <= cyh; ++cyi) {
-                for (int czi = czl; czi <= czh; ++czi) {
-                    amrex::IntVect ct(wrapped_index[lev - 1][cxi],
-                                      wrapped_index[lev - 1][cyi],
-                                      wrapped_index[lev - 1][czi]);
-
-                    if (!bak.contains(ct)) {
-                        layouts[lev - 1][omp_get_thread_num()]->Add(
-                            static_cast<double>(wrapped_index[lev - 1][cxi]) /
-                                    bfc -
-                                0.5,
-                            static_cast<double>(wrapped_index[lev - 1][cyi]) /
-                                    bfc -
-                                0.5,
-                            static_cast<double>(wrapped_index[lev - 1][czi]) /
-                                    bfc -
-                                0.5);
+        // Blocks touched by the box plus one block in the upper direction.
+        const amrex::Box &box = nest_ba[b];
+        const amrex::Box region((box.smallEnd() / bfc) * bfc,
+                                (box.bigEnd() / bfc + 2) * bfc - 1);
+        const amrex::BoxArray pieces =
+            WrapBoxArray(amrex::BoxArray(region), sim->dimN[lev - 1]);
+
+        // Only blocks not covered by the coarse level need to be added. Both
+        // are aligned to blocks so the complement consists of whole blocks.
+        for (int p = 0; p < pieces.size(); ++p) {
+            for (const amrex::Box &gap : bak.complementIn(pieces[p])) {
+                const amrex::IntVect lo = gap.smallEnd() / bfc;
+                const amrex::IntVect hi = gap.bigEnd() / bfc;
+                for (int cxi = lo[0]; cxi <= hi[0]; ++cxi) {
+                    for (int cyi = lo[1]; cyi <= hi[1]; ++cyi) {
+                        for (int czi = lo[2]; czi <= hi[2]; ++czi) {
+                            layouts[lev - 1][omp_get_thread_num()]->Add(
+                                cxi, cyi, czi);
+                        }
                     }
                 }
             }
@@ -739,31 +1014,92 @@ void LocalRegrid::FixNesting(const int lev) {
     FinalizeLayout(lev - 1);
 }
 
-/** @brief Wraps a box array accross periodic boundary conditions.
+/** @brief Wraps a box array accross periodic boundary conditions. Boxes
+ *         inside the domain are kept as they are. Only boxes crossing the
+ *         domain boundary are split into the periodic images they overlap,
+ *         such that the cost scales with the number of boxes and not with
+ *         the number of images. Boxes may extend by at most one domain length
+ *         beyond the domain.
  * @param   ba  BoxArray.
  * @param   N   Total number of potential boxes along an axis.
  */
-amrex::BoxArray LocalRegrid::WrapBoxArray(amrex::BoxArray &ba, int N) {
+amrex::BoxArray LocalRegrid::WrapBoxArray(const amrex::BoxArray &ba, int N) {
+    const amrex::Box domain(amrex::IntVect(0), amrex::IntVect(N - 1));
     amrex::BoxList new_bl;
+    new_bl.reserve(ba.size());
+
+    for (int b = 0; b < ba.size(); ++b) {
+        const amrex::Box box = ba[b];
+        if (domain.contains(box)) {
+            new_bl.push_back(box);
+            continue;
+        }
+
+        // Range of images touched by the box. Only direct neighbours of the
+        // domain are considered.
+        amrex::IntVect ilo, ihi;
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            const double lo = static_cast<double>(box.smallEnd(d)) / N;
+            const double hi = static_cast<double>(box.bigEnd(d)) / N;
+            ilo[d] = std::max(-1, static_cast<int>(std::floor(lo)));
+            ihi[d] = std::min(1, static_cast<int>(std::floor(hi)));
+        }
 
-    for (int i = -1; i <= 1; ++i) {
-        for (int j = -1; j <= 1; ++j) {
-            for (int k = -1; k <= 1; ++k) {
-                amrex::Box bO(amrex::IntVect(i * N, j * N, k * N),
-                              amrex::IntVect((i + 1) * N - 1, (j + 1) * N - 1,
-                                             (k + 1) * N - 1));
-                amrex::BoxList bl2w = ba.boxList().intersect(bO);
-                if (bl2w.isNotEmpty()) {
-                    bl2w.shift(0, -i * N);
-                    bl2w.shift(1, -j * N);
-                    bl2w.shift(2, -k * N);
-                    new_bl.join(bl2w);
+        for (int i = ilo[0]; i <= ihi[0]; ++i) {
+            for (int j = ilo[1]; j <= ihi[1]; ++j) {
+                for (int k = ilo[2]; k <= ihi[2]; ++k) {
+                    const amrex::IntVect shift(i * N, j * N, k * N);
+                    amrex::Box piece = box & (domain + shift);
+                    if (piece.ok())
+                        new_bl.push_back(piece - shift);
                 }
             }
         }
     }
 
-    return amrex::BoxArray(new_bl);
+    return amrex::BoxArray(std::move(new_bl));
+}
+
+/** @brief Tests WrapBoxArray on boxes inside the domain and on boxes that
+ *         cross a face, an edge or a corner of the periodic domain. Each
+ *         result has to consist of disjoint boxes inside the domain that
+ *         cover the periodic image of every cell of the original box exactly
+ *         once.
+ * @return  Whether all tests passed.
+ */
+bool LocalRegrid::CheckWrapBoxArray() {
+    const int N = 16;
+    const amrex::Box domain(amrex::IntVect(0), amrex::IntVect(N - 1));
+    const std::vector<amrex::Box> boxes = {
+        amrex::Box(amrex::IntVect(2, 3, 4), amrex::IntVect(9, 9, 9)),
+        amrex::Box(amrex::IntVect(-3, 2, 2), amrex::IntVect(4, 5, 5)),
+        amrex::Box(amrex::IntVect(2, 12, 2), amrex::IntVect(5, 18, 5)),
+        amrex::Box(amrex::IntVect(-2, 13, 5), amrex::IntVect(3, 17, 8)),
+        amrex::Box(amrex::IntVect(5, -4, 14), amrex::IntVect(8, 1, 16)),
+        amrex::Box(amrex::IntVect(-2, -3, -1), amrex::IntVect(1, 2, 3)),
+        amrex::Box(amrex::IntVect(14, 13, 15), amrex::IntVect(17, 18, 16)),
+        amrex::Box(amrex::IntVect(-2, 14, -1), amrex::IntVect(2, 17, 1))};
+
+    bool all_passed = true;
+    for (const amrex::Box &box : boxes) {
+        const amrex::BoxArray wrapped = WrapBoxArray(amrex::BoxArray(box), N);
+        bool passed = wrapped.numPts() == box.numPts() && wrapped.isDisjoint();
+
+        for (int b = 0; b < wrapped.size(); ++b)
+            passed = passed && domain.contains(wrapped[b]);
+
+        amrex::LoopOnCpu(box, [&](int i, int j, int k) {
+            const amrex::IntVect image((i + N) % N, (j + N) % N, (k + N) % N);
+            passed = passed && wrapped.contains(image);
+        });
+
+        amrex::Print() << "  WrapBoxArray " << box << ": " << wrapped.size()
+                       << " boxes, " << (passed ? "passed" : "failed")
+                       << std::endl;
+        all_passed = all_passed && passed;
+    }
+
+    return all_passed;
 }
 
 /** @brief Explicitly add boxes to a given level and fill it with data.
@@ -771,15 +1107,25 @@ amrex::BoxArray LocalRegrid::WrapBoxArray(amrex::BoxArray &ba, int N) {
  * @param   ba  BoxArray to be added to level.
  */
 void LocalRegrid::AddBoxes(const int lev, amrex::BoxArray &ba) {
+    // The old state is not extended if it has been released. It will be
+    // allocated with the new layout during the next time step.
+    const bool with_old_state = sim->grid_old[lev].isDefined();
+
     // Create temporary distribution mapping, box array and multifab with only
     // the new boxes.
-    amrex::DistributionMapping dm(ba, amrex::ParallelDescriptor::NProcs());
-    amrex::MultiFab mf_new_tmp(ba, dm, sim->scalar_fields.size(), sim->nghost);
-    amrex::MultiFab mf_old_tmp(ba, dm, sim->scalar_fields.size(), sim->nghost);
+    amrex::DistributionMapping dm =
+        sim->load_balancer->DistributeNewBoxes(lev, ba);
+    const int nghost = sim->NGhost(lev);
+    amrex::MultiFab mf_new_tmp(ba, dm, sim->scalar_fields.size(), nghost);
+    amrex::MultiFab mf_old_tmp(ba, dm, sim->scalar_fields.size(), nghost,
+                               amrex::MFInfo().SetAlloc(with_old_state));
 
     // Fill temporary mf with data.
     sim->level_synchronizer->FillPatch(lev, sim->grid_new[lev].t, mf_new_tmp);
-    sim->level_synchronizer->FillPatch(lev, sim->grid_old[lev].t, mf_old_tmp);
+    if (with_old_state) {
+        sim->level_synchronizer->FillPatch(lev, sim->grid_old[lev].t,
+                                           mf_old_tmp);
+    }
 
     // Create new joint box array.
     amrex::BoxList new_bl = sim->grid_new[lev].boxArray().boxList();
@@ -793,9 +1139,9 @@ void LocalRegrid::AddBoxes(const int lev, amrex::BoxArray &ba) {
     amrex::DistributionMapping new_dm(new_pmap);
 
     // Create new MultiFab and fill it with data.
-    LevelData new_mf(new_ba, new_dm, sim->scalar_fields.size(), sim->nghost,
+    LevelData new_mf(new_ba, new_dm, sim->scalar_fields.size(), nghost,
                      amrex::MFInfo().SetAlloc(false));
-    LevelData old_mf(new_ba, new_dm, sim->scalar_fields.size(), sim->nghost,
+    LevelData old_mf(new_ba, new_dm, sim->scalar_fields.size(), nghost,
                      amrex::MFInfo().SetAlloc(false));
 
     const int offset = new_ba.size() - ba.size();
@@ -804,14 +1150,20 @@ void LocalRegrid::AddBoxes(const int lev, amrex::BoxArray &ba) {
             amrex::FArrayBox &new_old_fab = sim->grid_new[lev][mfi.index()];
             new_mf.setFab(mfi, std::move(new_old_fab));
 
-            amrex::FArrayBox &old_old_fab = sim->grid_old[lev][mfi.index()];
-            old_mf.setFab(mfi, std::move(old_old_fab));
+            if (with_old_state) {
+                amrex::FArrayBox &old_old_fab =
+                    sim->grid_old[lev][mfi.index()];
+                old_mf.setFab(mfi, std::move(old_old_fab));
+            }
         } else {
             amrex::FArrayBox &new_old_fab = mf_new_tmp[mfi.index() - offset];
             new_mf.setFab(mfi, std::move(new_old_fab));
 
-            amrex::FArrayBox &old_old_fab = mf_old_tmp[mfi.index() - offset];
-            old_mf.setFab(mfi, std::move(old_old_fab));
+            if (with_old_state) {
+                amrex::FArrayBox &old_old_fab =
+                    mf_old_tmp[mfi.index() - offset];
+                old_mf.setFab(mfi, std::move(old_old_fab));
+            }
         }
     }
 
@@ -821,10 +1173,44 @@ void LocalRegrid::AddBoxes(const int lev, amrex::BoxArray &ba) {
     new_mf.istep = sim->grid_new[lev].istep;
     old_mf.istep = sim->grid_old[lev].istep;
     std::swap(sim->grid_new[lev], new_mf);
-    std::swap(sim->grid_old[lev], old_mf);
+    if (with_old_state)
+        std::swap(sim->grid_old[lev], old_mf);
     sim->SetBoxArray(lev, new_ba);
     sim->SetDistributionMap(lev, new_dm);
-    sim->grid_old[lev].contains_truncation_errors = false;
+    sim->grid_old[lev].ClearTruncationErrors();
+    sim->scratch_pool->Invalidate(lev);
+    utils::FftContext::Release();
+
+    if (!sim->load_balancer->only_new_boxes)
+        RebalanceLevel(lev);
+}
+
+/** @brief Migrates boxes of a level between MPI ranks if the load balancer
+ *         finds a better distribution.
+ * @param   lev Level.
+ */
+void LocalRegrid::RebalanceLevel(const int lev) {
+    const amrex::BoxArray ba = sim->grid_new[lev].boxArray();
+    const amrex::DistributionMapping dm_old = sim->dmap[lev];
+    amrex::DistributionMapping dm =
+        sim->load_balancer->Rebalance(lev, ba, dm_old);
+
+    if (dm == dm_old)
+        return;
+
+    for (LevelData *state : {&sim->grid_new[lev], &sim->grid_old[lev]}) {
+        if (!state->isDefined())
+            continue;
+
+        LevelData moved(ba, dm, state->nComp(), state->nGrow(), state->t);
+        moved.istep = state->istep;
+        moved.ParallelCopy(*state, 0, 0, state->nComp());
+        std::swap(*state, moved);
+    }
+
+    sim->SetDistributionMap(lev, dm);
+    sim->scratch_pool->Invalidate(lev);
+    utils::FftContext::Release();
 }
 
 }; // namespace sledgehamr
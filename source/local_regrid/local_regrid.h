@@ -1,11 +1,12 @@
 #ifndef SLEDGEHAMR_LOCAL_REGRID_H_
 #define SLEDGEHAMR_LOCAL_REGRID_H_
 
-#include "boost/multi_array.hpp"
+#include <AMReX_iMultiFab.H>
 
 #include "sledgehamr.h"
 #include "unique_layout.h"
 #include "location.h"
+#include "regrid_recorder.h"
 
 namespace sledgehamr {
 
@@ -29,9 +30,14 @@ class LocalRegrid {
 
     void JoinBoxArrays(const int lev, amrex::BoxArray& ba);
     void AddBoxes(const int lev, amrex::BoxArray& ba);
+    void RebalanceLevel(const int lev);
     void FixNesting(const int lev);
     void AddToLayout(const int lev, const int thread, const int i, const int j,
                      const int k);
+    void Replay();
+
+    static amrex::BoxArray WrapBoxArray(const amrex::BoxArray& ba, int N);
+    static bool CheckWrapBoxArray();
 
     /** @brief Flag that will be checked the TimeStepper module to force a
      *         global regrid.
@@ -56,6 +62,9 @@ class LocalRegrid {
     void InitializeLocalRegrid();
     void ParseInput();
     void CreateCommMatrix();
+    void ApplyRecord(const RegridRecord &record);
+    void DryRun(const RegridRecord &record);
+    void BenchmarkLayout(const RegridRecord &record);
 
     bool DoAttemptRegrid(const int lev);
     void DetermineAllBoxArrays(const int lev);
@@ -63,25 +72,26 @@ class LocalRegrid {
     void FixAllNesting();
     void JoinAllBoxArrays(std::vector<amrex::BoxArray>& box_arrays);
     void AddAllBoxes(std::vector<amrex::BoxArray>& box_arrays);
-    amrex::BoxArray WrapBoxArray(amrex::BoxArray& ba, int N);
+    void RecordFronts(const int lev,
+                      std::vector<amrex::BoxArray>& box_arrays);
+
+    amrex::iMultiFab BuildCoverageMask(const int lev);
 
     inline int GetBoxCoarseFineBorders(
-        const amrex::Box& tilebox, const amrex::IntVect& c0,
-        const amrex::IntVect& c1, const int lev,
-        boost::multi_array<bool, 3>& border);
+        const amrex::Box& block_box,
+        const amrex::Array4<int const>& coverage,
+        const amrex::Array4<int>& border);
 
     inline void TagAndMeasure(
         const amrex::Dim3& lo, const amrex::Dim3& hi, int remaining,
-        const amrex::Array4<char>& tag_arr, const amrex::IntVect& c0,
-        const amrex::IntVect& c1, const int lev, const int ibff,
-        const double bff, boost::multi_array<bool, 3>& border,
+        const amrex::Array4<char>& tag_arr, const int lev, const int ibff,
+        const double bff, const amrex::Array4<int>& border,
         std::vector<Location>& closest_locations, const double threshold,
         const int omp_thread_num);
 
     inline void CheckBorders(
-        const amrex::IntVect& ci, const amrex::IntVect& c0,
-        const amrex::IntVect& c1, const int ibff, const double bff,
-        int remaining, const int lev, boost::multi_array<bool, 3>& border,
+        const amrex::IntVect& ci, const int ibff, const double bff,
+        int remaining, const int lev, const amrex::Array4<int>& border,
         std::vector<Location>& closest_locations, const double threshold,
         const int omp_thread_num);
 
@@ -105,6 +115,11 @@ class LocalRegrid {
      */
     int veto_level = -1;
 
+    /** @brief Coarsest level for tagging of the current local regrid. All of
+     *         its phases are timed under this level.
+     */
+    int regrid_lev = 0;
+
     /** @brief If flag set to true we will skip the local regrid once.
      */
     bool force_global_regrid_at_restart = 0;
@@ -121,6 +136,12 @@ class LocalRegrid {
      */
     int n_error_buf = 1;
 
+    /** @brief Number of repetitions when benchmarking UniqueLayout against
+     *         LegacyUniqueLayout on replayed regrids. 0 disables the
+     *         benchmark.
+     */
+    int benchmark_layout = 0;
+
     /** @brief Number of cells contained in each level after the last global
      *         regrid.
      */
@@ -144,6 +165,11 @@ class LocalRegrid {
      */
     std::vector<double> min_distance;
 
+    /** @brief Whether min_distance has been measured on a level during the
+     *         current local regrid.
+     */
+    std::vector<bool> distance_measured;
+
     /** @brief Vector of UniqueLayouts for each level and each core.
      */
     std::vector< std::vector< std::unique_ptr<UniqueLayout> > > layouts;
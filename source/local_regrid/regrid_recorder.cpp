@@ -0,0 +1,271 @@
+#include "regrid_recorder.h"
+#include "hdf5_utils.h"
+#include "sledgehamr.h"
+
+namespace sledgehamr {
+
+/** @brief Reads recording and replay parameters.
+ * @param   owner   Pointer to the simulation.
+ */
+RegridRecorder::RegridRecorder(Sledgehamr *owner) : sim(owner) {
+    amrex::ParmParse pp("amr");
+    pp.query("record_regrids", recording);
+    pp.query("regrid_replay_folder", replay_folder);
+    replaying = !replay_folder.empty();
+
+    if (recording && replaying) {
+        amrex::Abort("#error: amr.record_regrids and amr.regrid_replay_folder "
+                     "are mutually exclusive!");
+    }
+
+    if (recording) {
+        record_folder = sim->io_module->output_folder + "/regrid_records";
+        if (amrex::ParallelDescriptor::IOProcessor())
+            amrex::UtilCreateDirectory(record_folder, 0755);
+    }
+}
+
+/** @brief Starts a new record.
+ * @param   lev Coarsest level for tagging.
+ */
+void RegridRecorder::Begin(const int lev) {
+    if (!recording)
+        return;
+
+    const int finest_level = sim->GetFinestLevel();
+    current = RegridRecord();
+    current.lev = lev;
+    current.finest_level = finest_level;
+    current.tags.resize(finest_level + 1);
+
+    for (int l = 0; l <= finest_level; ++l) {
+        const LevelData &state = sim->GetLevelData(l);
+        current.grids.push_back(state.boxArray());
+        current.time.push_back(state.t);
+        current.istep.push_back(state.istep);
+    }
+}
+
+/** @brief Adds the tags of a level to the current record. Tags are gathered
+ *         on the IO rank only.
+ * @param   lev     Level.
+ * @param   tags    Tags.
+ */
+void RegridRecorder::RecordTags(const int lev,
+                                const amrex::TagBoxArray &tags) {
+    if (!recording)
+        return;
+
+    // Runs as (i, j, k, n).
+    std::vector<int> runs;
+
+#pragma omp parallel
+    {
+        std::vector<int> my_runs;
+
+        for (amrex::MFIter mfi(tags, true); mfi.isValid(); ++mfi) {
+            const amrex::Array4<char const> &tag_arr = tags.const_array(mfi);
+            const amrex::Box &tilebox = mfi.tilebox();
+            const amrex::Dim3 lo = amrex::lbound(tilebox);
+            const amrex::Dim3 hi = amrex::ubound(tilebox);
+
+            for (int k = lo.z; k <= hi.z; ++k) {
+                for (int j = lo.y; j <= hi.y; ++j) {
+                    int i = lo.x;
+                    while (i <= hi.x) {
+                        if (tag_arr(i, j, k) != amrex::TagBox::SET) {
+                            ++i;
+                            continue;
+                        }
+
+                        const int i0 = i;
+                        while (i <= hi.x &&
+                               tag_arr(i, j, k) == amrex::TagBox::SET)
+                            ++i;
+
+                        my_runs.insert(my_runs.end(), {i0, j, k, i - i0});
+                    }
+                }
+            }
+        }
+
+#pragma omp critical
+        runs.insert(runs.end(), my_runs.begin(), my_runs.end());
+    }
+
+    // Only the IO rank writes the record.
+    const int root = amrex::ParallelDescriptor::IOProcessorNumber();
+    const int nprocs = amrex::ParallelDescriptor::NProcs();
+    int nlocal = runs.size();
+    std::vector<int> counts(nprocs), displs(nprocs, 0);
+    amrex::ParallelDescriptor::Gather(&nlocal, 1, counts.data(), 1, root);
+
+    int ntotal = 0;
+    if (amrex::ParallelDescriptor::IOProcessor()) {
+        for (int p = 0; p < nprocs; ++p) {
+            displs[p] = ntotal;
+            ntotal += counts[p];
+        }
+    }
+
+    std::vector<int> all_runs(ntotal);
+    amrex::ParallelDescriptor::Gatherv(runs.data(), nlocal, all_runs.data(),
+                                       counts, displs, root);
+
+    amrex::BoxList bl;
+    for (int r = 0; r < ntotal; r += AMREX_SPACEDIM + 1) {
+        const int *x = &all_runs[r];
+        bl.push_back(amrex::Box(amrex::IntVect(x[0], x[1], x[2]),
+                                amrex::IntVect(x[0] + x[3] - 1, x[1], x[2])));
+    }
+    current.tags[lev] = amrex::BoxArray(std::move(bl));
+}
+
+/** @brief Writes the current record to disk.
+ * @param   last_numPts Number of cells of each level after the last global
+ *                      regrid.
+ */
+void RegridRecorder::Finish(const std::vector<long long> &last_numPts) {
+    if (!recording)
+        return;
+
+    const int id = nrecords++;
+    if (!amrex::ParallelDescriptor::IOProcessor())
+        return;
+
+    const int nlevels = current.finest_level + 1;
+    std::vector<double> numPts(nlevels, 0);
+    for (int l = 0; l < nlevels && l < last_numPts.size(); ++l)
+        numPts[l] = last_numPts[l];
+
+    const std::string filename = Filename(record_folder, id);
+    hid_t file_id =
+        H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+
+    int header[2] = {current.lev, current.finest_level};
+    utils::hdf5::Write(file_id, "header", header, 2, true);
+    utils::hdf5::Write(file_id, "time", current.time.data(), nlevels);
+    utils::hdf5::Write(file_id, "istep", current.istep.data(), nlevels, true);
+    utils::hdf5::Write(file_id, "last_numPts", numPts.data(), nlevels);
+
+    for (int l = 0; l < nlevels; ++l) {
+        // Boxes as (x0, y0, z0, x1, y1, z1) and runs of tags as (i, j, k, n).
+        const amrex::BoxArray &ba = current.grids[l];
+        std::vector<int> boxes;
+        for (int b = 0; b < ba.size(); ++b) {
+            for (int d = 0; d < AMREX_SPACEDIM; ++d)
+                boxes.push_back(ba[b].smallEnd(d));
+            for (int d = 0; d < AMREX_SPACEDIM; ++d)
+                boxes.push_back(ba[b].bigEnd(d));
+        }
+
+        const amrex::BoxArray &runs = current.tags[l];
+        std::vector<int> tags;
+        for (int r = 0; r < runs.size(); ++r) {
+            for (int d = 0; d < AMREX_SPACEDIM; ++d)
+                tags.push_back(runs[r].smallEnd(d));
+            tags.push_back(runs[r].length(0));
+        }
+
+        std::string post = std::to_string(l);
+        int sizes[2] = {ba.size(), runs.size()};
+        utils::hdf5::Write(file_id, "sizes_" + post, sizes, 2, true);
+        utils::hdf5::Write(file_id, "boxes_" + post, boxes.data(),
+                           boxes.size(), true);
+        utils::hdf5::Write(file_id, "tags_" + post, tags.data(), tags.size(),
+                           true);
+    }
+
+    H5Fclose(file_id);
+    amrex::Print() << "  Recorded regrid to " << filename << std::endl;
+}
+
+/** @brief Reads a record from the replay folder. It can be accessed through
+ *         GetRecord afterwards.
+ * @param   id  Record number.
+ * @return  Whether the record exists.
+ */
+bool RegridRecorder::Load(const int id) {
+    const std::string filename = Filename(replay_folder, id);
+
+    int header[2];
+    if (!utils::hdf5::Read(filename, {"header"}, header))
+        return false;
+
+    const int nlevels = header[1] + 1;
+    RegridRecord &record = current;
+    record = RegridRecord();
+    record.lev = header[0];
+    record.finest_level = header[1];
+    record.time.resize(nlevels);
+    record.istep.resize(nlevels);
+    record.last_numPts.resize(nlevels);
+    record.grids.resize(nlevels);
+    record.tags.resize(nlevels);
+
+    std::vector<double> numPts(nlevels);
+    if (!utils::hdf5::Read(filename, {"time"}, record.time.data()) ||
+        !utils::hdf5::Read(filename, {"istep"}, record.istep.data()) ||
+        !utils::hdf5::Read(filename, {"last_numPts"}, numPts.data())) {
+        amrex::Abort("#error: Corrupted regrid record: " + filename);
+    }
+
+    for (int l = 0; l < nlevels; ++l) {
+        record.last_numPts[l] = numPts[l];
+
+        std::string post = std::to_string(l);
+        int sizes[2];
+        if (!utils::hdf5::Read(filename, {"sizes_" + post}, sizes))
+            amrex::Abort("#error: Corrupted regrid record: " + filename);
+
+        std::vector<int> boxes(2 * AMREX_SPACEDIM * sizes[0]);
+        std::vector<int> tags((AMREX_SPACEDIM + 1) * sizes[1]);
+        if ((sizes[0] > 0 &&
+             !utils::hdf5::Read(filename, {"boxes_" + post}, boxes.data())) ||
+            (sizes[1] > 0 &&
+             !utils::hdf5::Read(filename, {"tags_" + post}, tags.data()))) {
+            amrex::Abort("#error: Corrupted regrid record: " + filename);
+        }
+
+        amrex::BoxList bl;
+        for (int b = 0; b < sizes[0]; ++b) {
+            const int *x = &boxes[2 * AMREX_SPACEDIM * b];
+            bl.push_back(amrex::Box(amrex::IntVect(x[0], x[1], x[2]),
+                                    amrex::IntVect(x[3], x[4], x[5])));
+        }
+        record.grids[l] = amrex::BoxArray(std::move(bl));
+
+        amrex::BoxList runs;
+        for (int r = 0; r < sizes[1]; ++r) {
+            const int *x = &tags[(AMREX_SPACEDIM + 1) * r];
+            runs.push_back(
+                amrex::Box(amrex::IntVect(x[0], x[1], x[2]),
+                           amrex::IntVect(x[0] + x[3] - 1, x[1], x[2])));
+        }
+        record.tags[l] = amrex::BoxArray(std::move(runs));
+    }
+
+    return true;
+}
+
+/** @brief Sets the recorded tags of a level.
+ * @param   lev     Level.
+ * @param   tags    Tags to be filled.
+ */
+void RegridRecorder::FillTags(const int lev, amrex::TagBoxArray &tags) const {
+    tags.setVal(amrex::TagBox::CLEAR);
+
+    if (lev < current.tags.size() && current.tags[lev].size() > 0)
+        tags.setVal(current.tags[lev], amrex::TagBox::SET);
+}
+
+/** @brief Name of a record file.
+ * @param   folder  Folder.
+ * @param   id      Record number.
+ */
+std::string RegridRecorder::Filename(const std::string &folder,
+                                     const int id) const {
+    return folder + "/regrid_" + std::to_string(id) + ".h5";
+}
+
+}; // namespace sledgehamr
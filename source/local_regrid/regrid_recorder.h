@@ -0,0 +1,94 @@
+#ifndef SLEDGEHAMR_REGRID_RECORDER_H_
+#define SLEDGEHAMR_REGRID_RECORDER_H_
+
+#include <AMReX_BoxArray.H>
+#include <AMReX_TagBox.H>
+
+namespace sledgehamr {
+
+class Sledgehamr;
+
+/** @brief Grid hierarchy and tags of a single local regrid attempt.
+ */
+struct RegridRecord {
+    /** @brief Coarsest level for tagging.
+     */
+    int lev = 0;
+
+    /** @brief Finest level at the time of the regrid.
+     */
+    int finest_level = 0;
+
+    /** @brief BoxArray, time and time step of each level.
+     */
+    std::vector<amrex::BoxArray> grids;
+    std::vector<double> time;
+    std::vector<int> istep;
+
+    /** @brief Number of cells of each level after the last global regrid.
+     */
+    std::vector<long long> last_numPts;
+
+    /** @brief Tagged cells of each level stored as runs of consecutive cells
+     *         along the x-axis. Empty for levels that have not been tagged.
+     *         Only held by the IO rank while recording.
+     */
+    std::vector<amrex::BoxArray> tags;
+};
+
+/** @brief Dumps the tags and grids of every local regrid attempt into one
+ *         compact HDF5 file each, such that the local regrid can be replayed
+ *         offline with different parameters and MPI rank counts. Tags are
+ *         stored run-length encoded along the x-axis.
+ */
+class RegridRecorder {
+  public:
+    RegridRecorder(Sledgehamr *owner);
+
+    void Begin(const int lev);
+    void RecordTags(const int lev, const amrex::TagBoxArray &tags);
+    void Finish(const std::vector<long long> &last_numPts);
+
+    bool Load(const int id);
+    void FillTags(const int lev, amrex::TagBoxArray &tags) const;
+
+    /** @brief Returns the record currently being written or replayed.
+     */
+    const RegridRecord &GetRecord() const { return current; }
+
+    /** @brief Whether tags and grids are dumped at each local regrid.
+     */
+    bool recording = false;
+
+    /** @brief Whether we replay previously recorded local regrids instead of
+     *         running a simulation.
+     */
+    bool replaying = false;
+
+  private:
+    std::string Filename(const std::string &folder, const int id) const;
+
+    /** @brief Folder containing the records to be replayed.
+     */
+    std::string replay_folder = "";
+
+    /** @brief Folder the records are written to.
+     */
+    std::string record_folder = "";
+
+    /** @brief Number of records written so far.
+     */
+    int nrecords = 0;
+
+    /** @brief Record currently being written or replayed.
+     */
+    RegridRecord current;
+
+    /** @brief Pointer to the simulation.
+     */
+    Sledgehamr *sim;
+};
+
+}; // namespace sledgehamr
+
+#endif // SLEDGEHAMR_REGRID_RECORDER_H_
@@ -34,20 +34,21 @@ UniqueLayout::UniqueLayout(LocalRegrid* local_regrid, const int N)
  * @param   k   k-th index.
  */
 void UniqueLayout::Add(const uit i, const uit j, const uit k) const {
-    if (!p[i].count(j))
-        p[i][j] = std::set<uit>();
-
-    p[i][j].insert(k);
+    p[i].push_back(Key(j, k));
 }
 
 /** @brief Creates one unique layout structure from an array of layouts.
- * @param   uls Array of layouts.
+ *         Sorts and removes duplicates from all planes on the way.
+ * @param   uls Array of layouts. Needs to contain this layout at index 0.
  */
 void UniqueLayout::Merge(std::vector<std::unique_ptr<UniqueLayout> >& uls) {
-    // Merge all planes. Inner loop parallelized to maintain thread-safety.
-    for (int l = 1; l < uls.size(); ++l) {
+    // Planes are independent of each other so we can parallelize over them.
 #pragma omp parallel for
-        for (uit cp = 0; cp < Np; ++cp) {
+    for (uit cp = 0; cp < Np; ++cp) {
+        Compact(p[cp]);
+
+        for (int l = 1; l < uls.size(); ++l) {
+            Compact(uls[l]->p[cp]);
             MergePlane(cp, &(uls[l]->p[cp]));
         }
     }
@@ -55,7 +56,7 @@ void UniqueLayout::Merge(std::vector<std::unique_ptr<UniqueLayout> >& uls) {
 
 /** @brief Distributes any chunks that are not owned by this MPI rank but where
  *         added to it to the owning MPI rank. Will also receive any chunks by
- *         other ranks as well.
+ *         other ranks as well. Needs to be called after UniqueLayout::Merge.
  */
 void UniqueLayout::Distribute() {
     // Send/receive relevant planes according to communication matrix.
@@ -89,17 +90,15 @@ void UniqueLayout::Clear() {
     }
 }
 
-/** @brief Checks if location has been added to layout structure.
+/** @brief Checks if location has been added to layout structure. Only valid
+ *         after UniqueLayout::Merge.
  * @param   i   i-th index of location.
  * @param   j   j-th index of location.
  * @param   k   k-th index of location.
  * @return  Whether location has been added.
  */
 bool UniqueLayout::Contains(const uit i, const uit j, const uit k) const {
-    if (p[i].count(j))
-        return p[i][j].count(k);
-
-    return false;
+    return std::binary_search(p[i].begin(), p[i].end(), Key(j, k));
 }
 
 /** @brief Returns the number of locations added to the local chunks.
@@ -109,9 +108,7 @@ int UniqueLayout::Size() {
 
     for (uit cp = 0; cp < Np_this; ++cp) {
         int i = owner_of[mpi_mp][cp];
-        for (const std::pair<const uit,row>& n : p[i]) {
-            size += n.second.size();
-        }
+        size += p[i].size();
     }
 
     return size;
@@ -124,9 +121,7 @@ int UniqueLayout::SizeAll() {
     int size = 0;
 
     for (uit cp = 0; cp < Np; ++cp) {
-        for (const std::pair<const uit,row>& n : p[cp]) {
-            size += n.second.size();
-        }
+        size += p[cp].size();
     }
 
     return size;
@@ -138,36 +133,29 @@ int UniqueLayout::SizeAll() {
  */
 amrex::BoxList UniqueLayout::BoxList(const int blocking_factor) {
     amrex::BoxList bl;
-    int i,j,k0,km;
 
     for (uit cp=0; cp<Np_this; ++cp) {
-        i = owner_of[mpi_mp][cp];
-        for (const std::pair<const uit, row>& n : p[i]) {
-            j = n.first;
-
-            k0=-1;
-            for (const int &k : n.second) {
-                if (k0 == -1) {
-                    k0 = k;
-                    km = k;
-                } else if (k == km + 1) {
-                     km = k;
-                } else {
-                    amrex::IntVect sm(i,   j,   k0);
-                    amrex::IntVect bg(i+1, j+1, km+1);
-                    bl.push_back(amrex::Box(sm*blocking_factor,
-                                            bg*blocking_factor-1));
-                    k0 = k;
-                    km = k;
-                }
+        const int i = owner_of[mpi_mp][cp];
+        const plane& pl = p[i];
+
+        // Keys are sorted, so runs of consecutive keys within the same row
+        // form one box.
+        std::size_t n0 = 0;
+        while (n0 < pl.size()) {
+            std::size_t nm = n0;
+            while (nm + 1 < pl.size() && pl[nm + 1] == pl[nm] + 1 &&
+                   (pl[nm + 1] >> 16) == (pl[n0] >> 16)) {
+                ++nm;
             }
 
-            if (k0 != -1) {
-                amrex::IntVect sm(i,   j,   k0);
-                amrex::IntVect bg(i+1, j+1, km+1);
-                bl.push_back(amrex::Box(sm*blocking_factor,
-                                        bg*blocking_factor-1));
-            }
+            const int j  = pl[n0] >> 16;
+            const int k0 = pl[n0] & 0xFFFF;
+            const int km = pl[nm] & 0xFFFF;
+            amrex::IntVect sm(i,   j,   k0);
+            amrex::IntVect bg(i+1, j+1, km+1);
+            bl.push_back(amrex::Box(sm*blocking_factor,
+                                    bg*blocking_factor-1));
+            n0 = nm + 1;
         }
     }
 
@@ -182,20 +170,33 @@ amrex::BoxArray UniqueLayout::BoxArray(const int blocking_factor) {
     return amrex::BoxArray(BoxList(blocking_factor));
 }
 
-/** @brief Merges individual planes to ensure uniqueness.
+/** @brief Merges individual planes to ensure uniqueness. Both planes need to
+ *         be sorted and free of duplicates. Linear in the size of both planes.
  * @param   cp  Current plane.
  * @param   pm  Plane to merge.
  */
 void UniqueLayout::MergePlane(const uit cp, plane* pm) {
-    p[cp].merge(*pm);
-
-    for (const std::pair<const uit,row>& n : *pm) {
-        row r;
-        std::merge(p[cp][n.first].begin(), p[cp][n.first].end(),
-                   n.second.begin(), n.second.end(),
-                   std::inserter(r, r.begin()));
-        p[cp][n.first] = r;
+    if (pm->empty())
+        return;
+
+    if (p[cp].empty()) {
+        std::swap(p[cp], *pm);
+        return;
     }
+
+    plane r;
+    r.reserve(p[cp].size() + pm->size());
+    std::set_union(p[cp].begin(), p[cp].end(), pm->begin(), pm->end(),
+                   std::back_inserter(r));
+    std::swap(p[cp], r);
+}
+
+/** @brief Sorts a plane and removes duplicates.
+ * @param   pl  Plane.
+ */
+void UniqueLayout::Compact(plane& pl) {
+    std::sort(pl.begin(), pl.end());
+    pl.erase(std::unique(pl.begin(), pl.end()), pl.end());
 }
 
 /** @brief Wrap MPI rank index.
@@ -216,94 +217,45 @@ bool UniqueLayout::Owns(const uit cp) {
 }
 
 /** @brief Sends everthing we have of a chunk owned by another MPI rank to this
- *         rank.
+ *         rank. The size of all planes is sent first, followed by the content
+ *         of each non-empty plane straight from its storage.
  * @param   op  Other MPI rank.
  */
 void UniqueLayout::SendDistribution(const int op) {
-    for (uit cpo = 0; cpo < owner_of[op].size(); ++cpo) {
-        uit cp = owner_of[op][cpo];
-
-        // For each plane determine number of rows and their length.
-        std::vector<uit> r, length;
-        uit total_length = 0;
-        for (const std::pair<const uit,row>& n : p[cp]) {
-            r.push_back( n.first );
-            length.push_back( n.second.size() );
-            total_length += n.second.size();
-        }
+    std::vector<ukey> sizes;
+    sizes.reserve(owner_of[op].size());
+    for (const uit cp : owner_of[op])
+        sizes.push_back(p[cp].size());
 
-        // Collapse all data.
-        std::vector<uit> buf;
-        buf.reserve(total_length);
-        for (const std::pair<const uit,row>& n : p[cp]) {
-            buf.insert(buf.end(), std::make_move_iterator(n.second.begin()),
-                       std::make_move_iterator(n.second.end()));
-        }
+    MPI_Send(sizes.data(), sizes.size(), MPI_UNSIGNED, op, 501,
+             amrex::ParallelDescriptor::m_comm);
 
-        SendVector(op, r);
-        SendVector(op, length);
-        SendVector(op, buf);
+    for (const uit cp : owner_of[op]) {
+        if (!p[cp].empty()) {
+            MPI_Send(p[cp].data(), p[cp].size(), MPI_UNSIGNED, op, 502,
+                     amrex::ParallelDescriptor::m_comm);
+        }
     }
 }
 
 /** @brief Receives everthing another MPI rank has about our local chunk.
+ *         Data is received directly into the planes to be incorporated.
  * @param   op  Other MPI rank.
  */
 void UniqueLayout::RecvDistribution(const int op) {
-    nps.clear();
-
-    for (uit cpo=0; cpo<Np_this; ++cpo) {
-        std::vector<uit> r = RecvVector(op);
-        std::vector<uit> length = RecvVector(op);
-        std::vector<uit> buf = RecvVector(op);
-
-        // Unravel data according to metadata
-        plane np;
-        uit offset = 0;
-        for (int cr = 0; cr < r.size(); ++cr) {
-            std::set<uit> s{buf.begin() + offset,
-                            buf.begin() + offset + length[cr]};
-            np[r[cr]] = s;
-            offset += length[cr];
-        }
-
-        nps.push_back(np);
-    }
-}
-
-/** @brief  Sends data to another MPI rank.
- * @param   op  Other MPI rank.
- * @param   v   Data vector.
- */
-inline void UniqueLayout::SendVector(const int op, const std::vector<uit>& v) {
-    int size = v.size();
-    MPI_Send(&size, 1, MPI_UNSIGNED, op, 501,
-             amrex::ParallelDescriptor::m_comm);
-
-    if (size > 0) {
-        MPI_Send(&(v[0]), size, MPI_UNSIGNED_SHORT, op, 502,
-                 amrex::ParallelDescriptor::m_comm);
-    }
-}
-
-/** @brief Recevies data from another MPI rank.
- * @param   op  Other MPI rank.
- * @return  Received data vector.
- */
-inline std::vector<uit> UniqueLayout::RecvVector(const int op) {
-    int size;
-    std::vector<uit> v;
-
-    MPI_Recv(&size, 1, MPI_UNSIGNED, op, 501,
+    std::vector<ukey> sizes(Np_this);
+    MPI_Recv(sizes.data(), sizes.size(), MPI_UNSIGNED, op, 501,
              amrex::ParallelDescriptor::m_comm, MPI_STATUS_IGNORE);
 
-    if (size > 0) {
-        v.resize(size);
-        MPI_Recv(&(v[0]), size, MPI_UNSIGNED_SHORT, op, 502,
-                 amrex::ParallelDescriptor::m_comm, MPI_STATUS_IGNORE);
-    }
+    nps.resize(Np_this);
+    for (uit cpo = 0; cpo < Np_this; ++cpo) {
+        nps[cpo].resize(sizes[cpo]);
 
-    return v;
+        if (sizes[cpo] > 0) {
+            MPI_Recv(nps[cpo].data(), sizes[cpo], MPI_UNSIGNED, op, 502,
+                     amrex::ParallelDescriptor::m_comm, MPI_STATUS_IGNORE);
+        }
+    }
 }
 
 /** @brief Merge received planes with our own local structure.
@@ -8,14 +8,16 @@ namespace sledgehamr {
 class LocalRegrid;
 
 typedef unsigned short uit;
-typedef std::set<uit> row;
-typedef std::unordered_map<uit,row> plane;
+typedef unsigned int ukey;
+typedef std::vector<ukey> plane;
 
 /** @brief This class ensures the uniqueness of a grid by reducing the problem
  *         to sets of touples. Each core can work independently on its own
  *         UniqueLayout which can then be efficiently merged across cores and
  *         nodes to a global unique grid. Memory consumption scales with the
  *         number of boxes added, not with the potential number of boxes.
+ *         Each plane i is stored as a vector of keys j*2^16 + k which is
+ *         sorted and free of duplicates once the layout has been merged.
  */
 class UniqueLayout {
   public:
@@ -41,8 +43,16 @@ class UniqueLayout {
 
     void SendDistribution(const int op);
     void RecvDistribution(const int op);
-    inline void SendVector(const int op, const std::vector<uit>& v);
-    inline std::vector<uit> RecvVector(const int op);
+
+    static void Compact(plane& pl);
+
+    /** @brief Key of a location within a plane.
+     * @param   j   j-th index.
+     * @param   k   k-th index.
+     */
+    static ukey Key(const uit j, const uit k) {
+        return (static_cast<ukey>(j) << 16) | k;
+    }
 
     /** Total number of planes.
      */
@@ -111,9 +111,9 @@ namespace sledgehamr {
 #define SLEDGEHAMR_TRUNCATION_MODIFIER                                         \
     template <int>                                                             \
     AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE double TruncationModifier(        \
-        const amrex::Array4<const double> &state, const int i, const int j,    \
-        const int k, const int lev, const double time, const double dt,        \
-        const double dx, const double truncation_error,                        \
+        const amrex::Array4<const amrex::Real> &state, const int i,            \
+        const int j, const int k, const int lev, const double time,            \
+        const double dt, const double dx, const double truncation_error,       \
         const double *params) {                                                \
         return truncation_error;                                               \
     };
@@ -125,9 +125,9 @@ namespace sledgehamr {
 #define SLEDGEHAMR_TAG_CELL_FOR_REFINEMENT                                     \
     template <bool>                                                            \
     AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE bool TagCellForRefinement(        \
-        const amrex::Array4<const double> &state, const int i, const int j,    \
-        const int k, const int lev, const double time, const double dt,        \
-        const double dx, const double *params) {                               \
+        const amrex::Array4<const amrex::Real> &state, const int i,            \
+        const int j, const int k, const int lev, const double time,            \
+        const double dt, const double dx, const double *params) {              \
         return false;                                                          \
     };
 
@@ -138,9 +138,9 @@ namespace sledgehamr {
     template <bool>                                                            \
     AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE void GravitationalWavesRhs(       \
         const amrex::Array4<double> &rhs,                                      \
-        const amrex::Array4<const double> &state, const int i, const int j,    \
-        const int k, const int lev, const double time, const double dt,        \
-        const double dx, const double *params) {};
+        const amrex::Array4<const amrex::Real> &state, const int i,            \
+        const int j, const int k, const int lev, const double time,            \
+        const double dt, const double dx, const double *params) {};
 
 /* @brief Template declaration for computing the backreaction of the
  *        gravitational tensor onto our scalar fields.
@@ -150,9 +150,9 @@ namespace sledgehamr {
     AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE void                              \
     GravitationalWavesBackreaction(                                            \
         const amrex::Array4<double> &rhs,                                      \
-        const amrex::Array4<const double> &state, const int i, const int j,    \
-        const int k, const int lev, const double time, const double dt,        \
-        const double dx, const double *params_scalars,                         \
+        const amrex::Array4<const amrex::Real> &state, const int i,            \
+        const int j, const int k, const int lev, const double time,            \
+        const double dt, const double dx, const double *params_scalars,        \
         const double *params_gw) {};
 
 /** @brief Macro to add multiple scalar fields and default template functions to
@@ -199,8 +199,8 @@ namespace sledgehamr {
 #define SLEDGEHAMR_TRUNCATION_ERROR_TAG_CPU                                    \
     template <int NScalars>                                                    \
     AMREX_FORCE_INLINE bool TruncationErrorTagCpu(                             \
-        const amrex::Array4<const double> &state,                              \
-        const amrex::Array4<const double> &te, const int i, const int j,       \
+        const amrex::Array4<const amrex::Real> &state,                         \
+        const amrex::Array4<const amrex::Real> &te, const int i, const int j,  \
         const int k, const int lev, const double time, const double dt,        \
         const double dx, std::vector<double> &te_crit, long *ntags_trunc,      \
         const std::vector<double> &params) {                                   \
@@ -224,8 +224,8 @@ namespace sledgehamr {
 #define SLEDGEHAMR_TRUNCATION_ERROR_TAG_GPU                                    \
     template <int NScalars>                                                    \
     AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE bool TruncationErrorTagGpu(       \
-        const amrex::Array4<double const> &state,                              \
-        const amrex::Array4<double const> &te, const int i, const int j,       \
+        const amrex::Array4<amrex::Real const> &state,                         \
+        const amrex::Array4<amrex::Real const> &te, const int i, const int j,  \
         const int k, const int lev, const double time, const double dt,        \
         const double dx, double *te_crit, const double *params) {              \
         if (i % 2 != 0 || j % 2 != 0 || k % 2 != 0)                            \
@@ -241,12 +241,80 @@ namespace sledgehamr {
         return res;                                                            \
     };
 
+/** @brief Averages down a set of fine level cells onto a coarse level cell
+ *         and identifies at the same time whether the truncation error
+ *         threshold is violated. Fuses kernels::AverageDownWithTruncationError
+ *         and TruncationErrorTagCpu such that truncation errors do not have
+ *         to be stored. To be run on CPU code.
+ * @param   crse        Coarse level data.
+ * @param   fine        Fine level data.
+ * @param   te          Container to save truncation errors. Only written to
+ *                      if materialize is true.
+ * @param   i           i-th coarse cell index.
+ * @param   j           j-th coarse cell index.
+ * @param   k           k-th coarse cell index.
+ * @param   ncomp       Number of scalar fields.
+ * @param   lev         Fine level.
+ * @param   time        Current time.
+ * @param   dt          Time step size of the fine level.
+ * @param   dx          Grid spacing of the fine level.
+ * @param   te_crit     Array containing truncation error thresholds.
+ * @param   ntags_trunc Counts number of tags.
+ * @param   materialize Whether truncation errors are saved as well.
+ * @param   params      User-defined parameter.
+ * @return  If truncation error threshold has been exceeded.
+ */
+#define SLEDGEHAMR_AVERAGE_DOWN_WITH_TRUNCATION_TAG_CPU                        \
+    template <int NScalars>                                                    \
+    AMREX_FORCE_INLINE bool AverageDownWithTruncationTagCpu(                   \
+        const amrex::Array4<amrex::Real> &crse,                                \
+        const amrex::Array4<amrex::Real const> &fine,                          \
+        const amrex::Array4<amrex::Real> &te, const int i, const int j,        \
+        const int k, const int ncomp, const int lev, const double time,        \
+        const double dt, const double dx, std::vector<double> &te_crit,        \
+        long *ntags_trunc, const bool materialize,                             \
+        const std::vector<double> &params) {                                   \
+        const int ii = 2 * i;                                                  \
+        const int jj = 2 * j;                                                  \
+        const int kk = 2 * k;                                                  \
+        auto average = [&](const int n) {                                      \
+            double c = fine(ii, jj, kk, n);                                    \
+            c += fine(ii + 1, jj, kk, n);                                      \
+            c += fine(ii, jj + 1, kk, n);                                      \
+            c += fine(ii, jj, kk + 1, n);                                      \
+            c += fine(ii + 1, jj + 1, kk, n);                                  \
+            c += fine(ii + 1, jj, kk + 1, n);                                  \
+            c += fine(ii, jj + 1, kk + 1, n);                                  \
+            c += fine(ii + 1, jj + 1, kk + 1, n);                              \
+            c *= 0.125;                                                        \
+            const double truncation_error = fabs(crse(i, j, k, n) - c);        \
+            if (materialize)                                                   \
+                te(ii, jj, kk, n) = truncation_error;                          \
+            crse(i, j, k, n) = c;                                              \
+            return truncation_error;                                           \
+        };                                                                     \
+        bool res = false;                                                      \
+        sledgehamr::utils::constexpr_for<0, NScalars, 1>([&](auto n) {         \
+            double mte = TruncationModifier<n>(fine, ii, jj, kk, lev, time,    \
+                                               dt, dx, average(n),             \
+                                               params.data());                 \
+            if (mte >= te_crit[n]) {                                           \
+                res = true;                                                    \
+                ntags_trunc[n] += 8;                                           \
+            }                                                                  \
+        });                                                                    \
+        for (int n = NScalars; n < ncomp; ++n)                                 \
+            average(n);                                                        \
+        return res;                                                            \
+    };
+
 /** @brief Add functions to project namespace that depend on custom template
  *         specialisations.
  */
 #define SLEDGEHAMR_FINISH_SETUP                                                \
     SLEDGEHAMR_TRUNCATION_ERROR_TAG_CPU                                        \
-    SLEDGEHAMR_TRUNCATION_ERROR_TAG_GPU
+    SLEDGEHAMR_TRUNCATION_ERROR_TAG_GPU                                        \
+    SLEDGEHAMR_AVERAGE_DOWN_WITH_TRUNCATION_TAG_CPU
 
 /** @brief Constructor of project class to initialize scalar fields
  *         automatically.
@@ -260,14 +328,25 @@ namespace sledgehamr {
         amrex::Print() << std::endl;                                           \
     };
 
-/** @brief Initializes async arrays for Kreiss-Oliger meta data.
+/** @brief Initializes async arrays for Kreiss-Oliger meta data. Without a GPU
+ *         backend dissipation is added by the vectorized row kernels in
+ *         kernels::simd instead of pointwise.
  */
 #define SLEDGEHAMR_KO_LOCAL_SETUP                                              \
     amrex::Gpu::AsyncArray<double> async_dissipation_strength(                 \
         dissipation_strength.data(), dissipation_strength.size());             \
     double *l_dissipation_strength = async_dissipation_strength.data();        \
+    SLEDGEHAMR_KO_FLAGS_LOCAL_SETUP
+
+/** @brief Initializes the Kreiss-Oliger order and which of the two dissipation
+ *         paths is used.
+ */
+#define SLEDGEHAMR_KO_FLAGS_LOCAL_SETUP                                        \
     const int l_dissipation_order = dissipation_order;                         \
-    const bool l_with_dissipation = with_dissipation;
+    const bool l_with_dissipation =                                            \
+        with_dissipation && !sledgehamr::kernels::simd::kEnabled;              \
+    const bool l_with_simd_dissipation =                                       \
+        with_dissipation && sledgehamr::kernels::simd::kEnabled;
 
 /** @brief Initializes async arrays for meta data needed by Rhs computation.
  */
@@ -290,6 +369,175 @@ namespace sledgehamr {
                                                        params_gw_rhs.size());  \
     double *l_params_gw_rhs = async_params_gw_rhs.data();
 
+/** @brief Unpacks meta data of the Rhs computation that has been set up once
+ *         per level and stage by Sledgehamr::SetUpRhsBoxParams.
+ */
+#define SLEDGEHAMR_RHS_BOX_PARAMS_LOCAL_SETUP                                  \
+    const double time = params.time;                                           \
+    const double *l_params_rhs = params.params_rhs.data();                     \
+    const double *l_params_gw_rhs = params.params_gw_rhs.data();               \
+    const double *l_dissipation_strength =                                     \
+        params.dissipation_strength.data();                                    \
+    SLEDGEHAMR_KO_FLAGS_LOCAL_SETUP
+
+/** @brief Evaluates Rhs, Gw and Kreiss-Oliger dissipation kernels on all boxes
+ *         in bxs. Requires rhs_fab, state_fab and the local setup of the Rhs
+ *         parameters to be in scope. Without a GPU backend dissipation is
+ *         added in a separate vectorized pass.
+ */
+#define SLEDGEHAMR_RHS_KERNEL                                                  \
+    if (with_gravitational_waves) {                                            \
+        sledgehamr::utils::ParallelFor(                                        \
+            bxs, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {          \
+            Rhs(rhs_fab, state_fab, i, j, k, lev, time, dt, dx,                \
+                l_params_rhs);                                                 \
+            GravitationalWavesRhs<true>(rhs_fab, state_fab, i, j, k,           \
+                                        lev, time, dt, dx,                     \
+                                        l_params_gw_rhs);                      \
+            GravitationalWavesBackreaction<true>(                              \
+                rhs_fab, state_fab, i, j, k, lev, time, dt, dx,                \
+                l_params_rhs, l_params_gw_rhs);                                \
+            switch (l_with_dissipation * l_dissipation_order) {                \
+            case 2:                                                            \
+                sledgehamr::utils::constexpr_for<0, Gw::NGwScalars,            \
+                                                 1>([&](auto n) {              \
+                    rhs_fab(i, j, k, n) +=                                     \
+                        sledgehamr::kernels::KreissOligerDissipation<          \
+                            2>(state_fab, i, j, k, n, dx,                      \
+                               l_dissipation_strength[n]);                     \
+                });                                                            \
+                break;                                                         \
+            case 3:                                                            \
+                sledgehamr::utils::constexpr_for<0, Gw::NGwScalars,            \
+                                                 1>([&](auto n) {              \
+                    rhs_fab(i, j, k, n) +=                                     \
+                        sledgehamr::kernels::KreissOligerDissipation<          \
+                            3>(state_fab, i, j, k, n, dx,                      \
+                               l_dissipation_strength[n]);                     \
+                });                                                            \
+                break;                                                         \
+            }                                                                  \
+        });                                                                    \
+    } else {                                                                   \
+        sledgehamr::utils::ParallelFor(                                        \
+            bxs, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {          \
+            Rhs(rhs_fab, state_fab, i, j, k, lev, time, dt, dx,                \
+                l_params_rhs);                                                 \
+            switch (l_with_dissipation * l_dissipation_order) {                \
+            case 2:                                                            \
+                sledgehamr::utils::constexpr_for<0, Scalar::NScalars,          \
+                                                 1>([&](auto n) {              \
+                    rhs_fab(i, j, k, n) +=                                     \
+                        sledgehamr::kernels::KreissOligerDissipation<          \
+                            2>(state_fab, i, j, k, n, dx,                      \
+                               l_dissipation_strength[n]);                     \
+                });                                                            \
+                break;                                                         \
+            case 3:                                                            \
+                sledgehamr::utils::constexpr_for<0, Scalar::NScalars,          \
+                                                 1>([&](auto n) {              \
+                    rhs_fab(i, j, k, n) +=                                     \
+                        sledgehamr::kernels::KreissOligerDissipation<          \
+                            3>(state_fab, i, j, k, n, dx,                      \
+                               l_dissipation_strength[n]);                     \
+                });                                                            \
+                break;                                                         \
+            }                                                                  \
+        });                                                                    \
+    }                                                                          \
+    if (l_with_simd_dissipation) {                                             \
+        sledgehamr::kernels::simd::AddKreissOligerDissipation(                 \
+            bxs, rhs_fab, state_fab,                                           \
+            with_gravitational_waves ? static_cast<int>(Gw::NGwScalars)        \
+                                     : static_cast<int>(Scalar::NScalars),     \
+            dx, l_dissipation_order, l_dissipation_strength);                  \
+    }
+
+/** @brief Same as SLEDGEHAMR_RHS_KERNEL but adds the result weighted to the
+ *         existing values, rhs_fab = weight*rhs_fab + rhs.
+ */
+#define SLEDGEHAMR_ADD_RHS_KERNEL                                              \
+    if (with_gravitational_waves) {                                            \
+        sledgehamr::utils::ParallelFor(                                        \
+            bxs, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {          \
+            double tmp_rhs[Gw::NGwScalars];                                    \
+            sledgehamr::utils::constexpr_for<0, Gw::NGwScalars, 1>(            \
+                [&](auto n) { tmp_rhs[n] = rhs_fab(i, j, k, n); });            \
+            Rhs(rhs_fab, state_fab, i, j, k, lev, time, dt, dx,                \
+                l_params_rhs);                                                 \
+            GravitationalWavesRhs<true>(rhs_fab, state_fab, i, j, k,           \
+                                        lev, time, dt, dx,                     \
+                                        l_params_gw_rhs);                      \
+            GravitationalWavesBackreaction<true>(                              \
+                rhs_fab, state_fab, i, j, k, lev, time, dt, dx,                \
+                l_params_rhs, l_params_gw_rhs);                                \
+            switch (l_with_dissipation * l_dissipation_order) {                \
+            case 2:                                                            \
+                sledgehamr::utils::constexpr_for<0, Gw::NGwScalars,            \
+                                                 1>([&](auto n) {              \
+                    rhs_fab(i, j, k, n) +=                                     \
+                        sledgehamr::kernels::KreissOligerDissipation<          \
+                            2>(state_fab, i, j, k, n, dx,                      \
+                               l_dissipation_strength[n]);                     \
+                });                                                            \
+                break;                                                         \
+            case 3:                                                            \
+                sledgehamr::utils::constexpr_for<0, Gw::NGwScalars,            \
+                                                 1>([&](auto n) {              \
+                    rhs_fab(i, j, k, n) +=                                     \
+                        sledgehamr::kernels::KreissOligerDissipation<          \
+                            3>(state_fab, i, j, k, n, dx,                      \
+                               l_dissipation_strength[n]);                     \
+                });                                                            \
+                break;                                                         \
+            }                                                                  \
+            sledgehamr::utils::constexpr_for<0, Gw::NGwScalars, 1>(            \
+                [&](auto n) {                                                  \
+                    rhs_fab(i, j, k, n) += weight * tmp_rhs[n];                \
+                });                                                            \
+        });                                                                    \
+    } else {                                                                   \
+        sledgehamr::utils::ParallelFor(                                        \
+            bxs, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {          \
+            double tmp_rhs[Scalar::NScalars];                                  \
+            sledgehamr::utils::constexpr_for<0, Scalar::NScalars, 1>(          \
+                [&](auto n) { tmp_rhs[n] = rhs_fab(i, j, k, n); });            \
+            Rhs(rhs_fab, state_fab, i, j, k, lev, time, dt, dx,                \
+                l_params_rhs);                                                 \
+            switch (l_with_dissipation * l_dissipation_order) {                \
+            case 2:                                                            \
+                sledgehamr::utils::constexpr_for<0, Scalar::NScalars,          \
+                                                 1>([&](auto n) {              \
+                    rhs_fab(i, j, k, n) +=                                     \
+                        sledgehamr::kernels::KreissOligerDissipation<          \
+                            2>(state_fab, i, j, k, n, dx,                      \
+                               l_dissipation_strength[n]);                     \
+                });                                                            \
+                break;                                                         \
+            case 3:                                                            \
+                sledgehamr::utils::constexpr_for<0, Scalar::NScalars,          \
+                                                 1>([&](auto n) {              \
+                    rhs_fab(i, j, k, n) +=                                     \
+                        sledgehamr::kernels::KreissOligerDissipation<          \
+                            3>(state_fab, i, j, k, n, dx,                      \
+                               l_dissipation_strength[n]);                     \
+                });                                                            \
+                break;                                                         \
+            }                                                                  \
+            sledgehamr::utils::constexpr_for<0, Scalar::NScalars, 1>(          \
+                [&](auto n) {                                                  \
+                    rhs_fab(i, j, k, n) += weight * tmp_rhs[n];                \
+                });                                                            \
+        });                                                                    \
+    }                                                                          \
+    if (l_with_simd_dissipation) {                                             \
+        sledgehamr::kernels::simd::AddKreissOligerDissipation(                 \
+            bxs, rhs_fab, state_fab,                                           \
+            with_gravitational_waves ? static_cast<int>(Gw::NGwScalars)        \
+                                     : static_cast<int>(Scalar::NScalars),     \
+            dx, l_dissipation_order, l_dissipation_strength);                  \
+    }
+
 /** @brief Computes Rhs for the entire level.
  * @param   rhs_mf      Container to fill the Rhs with.
  * @param   state_mf    Current grid.
@@ -297,12 +545,15 @@ namespace sledgehamr {
  * @param   lev         Current level.
  * @param   dt          Time step size.
  * @param   dx          Grid spacing.
+ * @param   region      Only compute Rhs for cells in this region, see
+ *                      utils::RhsRegion. Interior cells do not depend on ghost
+ *                      cells and can be computed while those are being filled.
  */
 #define SLEDGEHAMR_PRJ_FILL_RHS                                                \
-    virtual void FillRhs(amrex::MultiFab &rhs_mf,                              \
+    virtual void FillRhs(sledgehamr::RhsMultiFab &rhs_mf,                      \
                          const amrex::MultiFab &state_mf, const double time,   \
-                         const int lev, const double dt, const double dx)      \
-        override {                                                             \
+                         const int lev, const double dt, const double dx,      \
+                         const int region) override {                          \
         performance_monitor->Start(performance_monitor->idx_rhs, lev);         \
         SLEDGEHAMR_KO_LOCAL_SETUP                                              \
         SLEDGEHAMR_RHS_PARAMS_LOCAL_SETUP                                      \
@@ -311,69 +562,12 @@ namespace sledgehamr {
             omp parallel if (amrex::Gpu::notInLaunchRegion()))                 \
         for (amrex::MFIter mfi(rhs_mf, amrex::TilingIfNotGPU());               \
              mfi.isValid(); ++mfi) {                                           \
-            const amrex::Box &bx = mfi.tilebox();                              \
+            const amrex::BoxList bxs = sledgehamr::utils::RhsRegionBoxes(      \
+                mfi.tilebox(), mfi.validbox(), state_mf.nGrow(), region);      \
             const amrex::Array4<double> &rhs_fab = rhs_mf.array(mfi);          \
-            const amrex::Array4<double const> &state_fab =                     \
+            const amrex::Array4<amrex::Real const> &state_fab =                \
                 state_mf.array(mfi);                                           \
-            if (with_gravitational_waves) {                                    \
-                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j,      \
-                                                            int k) noexcept {  \
-                    Rhs(rhs_fab, state_fab, i, j, k, lev, time, dt, dx,        \
-                        l_params_rhs);                                         \
-                    GravitationalWavesRhs<true>(rhs_fab, state_fab, i, j, k,   \
-                                                lev, time, dt, dx,             \
-                                                l_params_gw_rhs);              \
-                    GravitationalWavesBackreaction<true>(                      \
-                        rhs_fab, state_fab, i, j, k, lev, time, dt, dx,        \
-                        l_params_rhs, l_params_gw_rhs);                        \
-                    switch (l_with_dissipation * l_dissipation_order) {        \
-                    case 2:                                                    \
-                        sledgehamr::utils::constexpr_for<0, Gw::NGwScalars,    \
-                                                         1>([&](auto n) {      \
-                            rhs_fab(i, j, k, n) +=                             \
-                                sledgehamr::kernels::KreissOligerDissipation<  \
-                                    2>(state_fab, i, j, k, n, dx,              \
-                                       l_dissipation_strength[n]);             \
-                        });                                                    \
-                        break;                                                 \
-                    case 3:                                                    \
-                        sledgehamr::utils::constexpr_for<0, Gw::NGwScalars,    \
-                                                         1>([&](auto n) {      \
-                            rhs_fab(i, j, k, n) +=                             \
-                                sledgehamr::kernels::KreissOligerDissipation<  \
-                                    3>(state_fab, i, j, k, n, dx,              \
-                                       l_dissipation_strength[n]);             \
-                        });                                                    \
-                        break;                                                 \
-                    }                                                          \
-                });                                                            \
-            } else {                                                           \
-                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j,      \
-                                                            int k) noexcept {  \
-                    Rhs(rhs_fab, state_fab, i, j, k, lev, time, dt, dx,        \
-                        l_params_rhs);                                         \
-                    switch (l_with_dissipation * l_dissipation_order) {        \
-                    case 2:                                                    \
-                        sledgehamr::utils::constexpr_for<0, Scalar::NScalars,  \
-                                                         1>([&](auto n) {      \
-                            rhs_fab(i, j, k, n) +=                             \
-                                sledgehamr::kernels::KreissOligerDissipation<  \
-                                    2>(state_fab, i, j, k, n, dx,              \
-                                       l_dissipation_strength[n]);             \
-                        });                                                    \
-                        break;                                                 \
-                    case 3:                                                    \
-                        sledgehamr::utils::constexpr_for<0, Scalar::NScalars,  \
-                                                         1>([&](auto n) {      \
-                            rhs_fab(i, j, k, n) +=                             \
-                                sledgehamr::kernels::KreissOligerDissipation<  \
-                                    3>(state_fab, i, j, k, n, dx,              \
-                                       l_dissipation_strength[n]);             \
-                        });                                                    \
-                        break;                                                 \
-                    }                                                          \
-                });                                                            \
-            }                                                                  \
+            SLEDGEHAMR_RHS_KERNEL                                              \
         }                                                                      \
         performance_monitor->Stop(performance_monitor->idx_rhs, lev);          \
     };
@@ -388,12 +582,14 @@ namespace sledgehamr {
  * @param   dt          Time step size.
  * @param   dx          Grid spacing.
  * @param   weight      Relative weight between values of rhs_mf and rhs.
+ * @param   region      Only compute Rhs for cells in this region.
  */
 #define SLEDGEHAMR_PRJ_FILL_ADD_RHS                                            \
-    virtual void FillAddRhs(amrex::MultiFab &rhs_mf,                           \
+    virtual void FillAddRhs(sledgehamr::RhsMultiFab &rhs_mf,                   \
                             const amrex::MultiFab &state_mf,                   \
                             const double time, const int lev, const double dt, \
-                            const double dx, const double weight) override {   \
+                            const double dx, const double weight,              \
+                            const int region) override {                       \
         performance_monitor->Start(performance_monitor->idx_rhs, lev);         \
         const int ncomp = rhs_mf.nComp();                                      \
         SLEDGEHAMR_KO_LOCAL_SETUP                                              \
@@ -403,93 +599,70 @@ namespace sledgehamr {
             omp parallel if (amrex::Gpu::notInLaunchRegion()))                 \
         for (amrex::MFIter mfi(rhs_mf, amrex::TilingIfNotGPU());               \
              mfi.isValid(); ++mfi) {                                           \
-            const amrex::Box &bx = mfi.tilebox();                              \
+            const amrex::BoxList bxs = sledgehamr::utils::RhsRegionBoxes(      \
+                mfi.tilebox(), mfi.validbox(), state_mf.nGrow(), region);      \
             const amrex::Array4<double> &rhs_fab = rhs_mf.array(mfi);          \
-            const amrex::Array4<double const> &state_fab =                     \
+            const amrex::Array4<amrex::Real const> &state_fab =                \
                 state_mf.array(mfi);                                           \
-            if (with_gravitational_waves) {                                    \
-                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j,      \
-                                                            int k) noexcept {  \
-                    double tmp_rhs[Gw::NGwScalars];                            \
-                    sledgehamr::utils::constexpr_for<0, Gw::NGwScalars, 1>(    \
-                        [&](auto n) { tmp_rhs[n] = rhs_fab(i, j, k, n); });    \
-                    Rhs(rhs_fab, state_fab, i, j, k, lev, time, dt, dx,        \
-                        l_params_rhs);                                         \
-                    GravitationalWavesRhs<true>(rhs_fab, state_fab, i, j, k,   \
-                                                lev, time, dt, dx,             \
-                                                l_params_gw_rhs);              \
-                    GravitationalWavesBackreaction<true>(                      \
-                        rhs_fab, state_fab, i, j, k, lev, time, dt, dx,        \
-                        l_params_rhs, l_params_gw_rhs);                        \
-                    switch (l_with_dissipation * l_dissipation_order) {        \
-                    case 2:                                                    \
-                        sledgehamr::utils::constexpr_for<0, Gw::NGwScalars,    \
-                                                         1>([&](auto n) {      \
-                            rhs_fab(i, j, k, n) +=                             \
-                                sledgehamr::kernels::KreissOligerDissipation<  \
-                                    2>(state_fab, i, j, k, n, dx,              \
-                                       l_dissipation_strength[n]);             \
-                        });                                                    \
-                        break;                                                 \
-                    case 3:                                                    \
-                        sledgehamr::utils::constexpr_for<0, Gw::NGwScalars,    \
-                                                         1>([&](auto n) {      \
-                            rhs_fab(i, j, k, n) +=                             \
-                                sledgehamr::kernels::KreissOligerDissipation<  \
-                                    3>(state_fab, i, j, k, n, dx,              \
-                                       l_dissipation_strength[n]);             \
-                        });                                                    \
-                        break;                                                 \
-                    }                                                          \
-                    sledgehamr::utils::constexpr_for<0, Gw::NGwScalars, 1>(    \
-                        [&](auto n) {                                          \
-                            rhs_fab(i, j, k, n) += weight * tmp_rhs[n];        \
-                        });                                                    \
-                });                                                            \
-            } else {                                                           \
-                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j,      \
-                                                            int k) noexcept {  \
-                    double tmp_rhs[Scalar::NScalars];                          \
-                    sledgehamr::utils::constexpr_for<0, Scalar::NScalars, 1>(  \
-                        [&](auto n) { tmp_rhs[n] = rhs_fab(i, j, k, n); });    \
-                    Rhs(rhs_fab, state_fab, i, j, k, lev, time, dt, dx,        \
-                        l_params_rhs);                                         \
-                    switch (l_with_dissipation * l_dissipation_order) {        \
-                    case 2:                                                    \
-                        sledgehamr::utils::constexpr_for<0, Scalar::NScalars,  \
-                                                         1>([&](auto n) {      \
-                            rhs_fab(i, j, k, n) +=                             \
-                                sledgehamr::kernels::KreissOligerDissipation<  \
-                                    2>(state_fab, i, j, k, n, dx,              \
-                                       l_dissipation_strength[n]);             \
-                        });                                                    \
-                        break;                                                 \
-                    case 3:                                                    \
-                        sledgehamr::utils::constexpr_for<0, Scalar::NScalars,  \
-                                                         1>([&](auto n) {      \
-                            rhs_fab(i, j, k, n) +=                             \
-                                sledgehamr::kernels::KreissOligerDissipation<  \
-                                    3>(state_fab, i, j, k, n, dx,              \
-                                       l_dissipation_strength[n]);             \
-                        });                                                    \
-                        break;                                                 \
-                    }                                                          \
-                    sledgehamr::utils::constexpr_for<0, Scalar::NScalars, 1>(  \
-                        [&](auto n) {                                          \
-                            rhs_fab(i, j, k, n) += weight * tmp_rhs[n];        \
-                        });                                                    \
-                });                                                            \
-            }                                                                  \
+            SLEDGEHAMR_ADD_RHS_KERNEL                                          \
         }                                                                      \
         performance_monitor->Stop(performance_monitor->idx_rhs, lev);          \
     };
 
+/** @brief Computes Rhs on a single box only. Used by temporally blocked
+ *         integrators that work on one tile at a time.
+ * @param   bx          Box on which the Rhs is computed.
+ * @param   rhs_fab     Container to fill the Rhs with.
+ * @param   state_fab   Current state. Needs to be valid on bx grown by the
+ *                      stencil width.
+ * @param   params      Rhs parameters at the current time, see
+ *                      Sledgehamr::SetUpRhsBoxParams.
+ * @param   lev         Current level.
+ * @param   dt          Time step size.
+ * @param   dx          Grid spacing.
+ */
+#define SLEDGEHAMR_PRJ_FILL_RHS_BOX                                            \
+    virtual void FillRhsBox(const amrex::Box &bx,                              \
+                            const amrex::Array4<double> &rhs_fab,              \
+                            const amrex::Array4<amrex::Real const> &state_fab, \
+                            const sledgehamr::RhsBoxParams &params,            \
+                            const int lev, const double dt, const double dx)   \
+        override {                                                             \
+        SLEDGEHAMR_RHS_BOX_PARAMS_LOCAL_SETUP                                  \
+        const amrex::BoxList bxs(bx);                                          \
+        SLEDGEHAMR_RHS_KERNEL                                                  \
+    };
+
+/** @brief Same as SLEDGEHAMR_PRJ_FILL_RHS_BOX but adds the result weighted to
+ *         the existing values, rhs_fab = weight*rhs_fab + rhs.
+ * @param   bx          Box on which the Rhs is computed.
+ * @param   rhs_fab     Container to add the Rhs to.
+ * @param   state_fab   Current state. Needs to be valid on bx grown by the
+ *                      stencil width.
+ * @param   params      Rhs parameters at the current time, see
+ *                      Sledgehamr::SetUpRhsBoxParams.
+ * @param   lev         Current level.
+ * @param   dt          Time step size.
+ * @param   dx          Grid spacing.
+ * @param   weight      Relative weight between values of rhs_fab and rhs.
+ */
+#define SLEDGEHAMR_PRJ_FILL_ADD_RHS_BOX                                        \
+    virtual void FillAddRhsBox(                                                \
+        const amrex::Box &bx, const amrex::Array4<double> &rhs_fab,            \
+        const amrex::Array4<amrex::Real const> &state_fab,                     \
+        const sledgehamr::RhsBoxParams &params, const int lev,                 \
+        const double dt, const double dx, const double weight) override {      \
+        SLEDGEHAMR_RHS_BOX_PARAMS_LOCAL_SETUP                                  \
+        const amrex::BoxList bxs(bx);                                          \
+        SLEDGEHAMR_ADD_RHS_KERNEL                                              \
+    };
+
 /** @brief Overrides function in project class. Does tagging on CPUs.
  */
 #define SLEDGEHAMR_PRJ_TAG_WITH_TRUNCATION_CPU                                 \
     virtual void TagWithTruncationCpu(                                         \
-        const amrex::Array4<double const> &state_fab,                          \
-        const amrex::Array4<double const> &state_fab_te,                       \
+        const amrex::Array4<amrex::Real const> &state_fab,                     \
+        const amrex::Array4<amrex::Real const> &state_fab_te,                  \
         const amrex::Array4<char> &tagarr, const amrex::Box &tilebox,          \
         double time, int lev, long *ntags_total, long *ntags_user,             \
         long *ntags_trunc, const std::vector<double> &params_tag,              \
@@ -569,8 +742,8 @@ namespace sledgehamr {
  */
 #define SLEDGEHAMR_PRJ_TAG_WITH_TRUNCATION_GPU                                 \
     virtual void TagWithTruncationGpu(                                         \
-        const amrex::Array4<double const> &state_fab,                          \
-        const amrex::Array4<double const> &state_fab_te,                       \
+        const amrex::Array4<amrex::Real const> &state_fab,                     \
+        const amrex::Array4<amrex::Real const> &state_fab_te,                  \
         const amrex::Array4<char> &tagarr, const amrex::Box &tilebox,          \
         double time, int lev, const std::vector<double> &params_tag,           \
         const std::vector<double> &params_mod) override {                      \
@@ -634,12 +807,57 @@ namespace sledgehamr {
         }                                                                      \
     };
 
+/** @brief Overrides function in project class. Averages down onto the coarse
+ *         level and computes truncation error tags in a single pass on CPUs.
+ */
+#define SLEDGEHAMR_PRJ_AVERAGE_DOWN_WITH_TRUNCATION_TAGS_CPU                   \
+    virtual void AverageDownWithTruncationTagsCpu(                             \
+        const amrex::Array4<amrex::Real> &crse,                                \
+        const amrex::Array4<amrex::Real const> &fine,                          \
+        const amrex::Array4<amrex::Real> &te,                                  \
+        const amrex::Array4<char> &te_tags, const amrex::Box &tilebox,         \
+        double time, int lev, bool materialize, long *ntags_trunc,             \
+        const std::vector<double> &params_mod) override {                      \
+        const amrex::Dim3 lo = amrex::lbound(tilebox);                         \
+        const amrex::Dim3 hi = amrex::ubound(tilebox);                         \
+        const int ncomp = scalar_fields.size();                                \
+        if (with_gravitational_waves) {                                        \
+            for (int k = lo.z; k <= hi.z; ++k) {                               \
+                for (int j = lo.y; j <= hi.y; ++j) {                           \
+                    for (int i = lo.x; i <= hi.x; ++i) {                       \
+                        bool res =                                             \
+                            AverageDownWithTruncationTagCpu<Gw::NGwScalars>(   \
+                                crse, fine, te, i, j, k, ncomp, lev, time,     \
+                                dt[lev], dx[lev], te_crit, ntags_trunc,        \
+                                materialize, params_mod);                      \
+                        te_tags(i, j, k) = res ? amrex::TagBox::SET            \
+                                               : amrex::TagBox::CLEAR;         \
+                    }                                                          \
+                }                                                              \
+            }                                                                  \
+        } else {                                                               \
+            for (int k = lo.z; k <= hi.z; ++k) {                               \
+                for (int j = lo.y; j <= hi.y; ++j) {                           \
+                    for (int i = lo.x; i <= hi.x; ++i) {                       \
+                        bool res =                                             \
+                            AverageDownWithTruncationTagCpu<Scalar::NScalars>( \
+                                crse, fine, te, i, j, k, ncomp, lev, time,     \
+                                dt[lev], dx[lev], te_crit, ntags_trunc,        \
+                                materialize, params_mod);                      \
+                        te_tags(i, j, k) = res ? amrex::TagBox::SET            \
+                                               : amrex::TagBox::CLEAR;         \
+                    }                                                          \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+    };
+
 /** @brief Overrides function in project class. Does tagging on CPUs but without
  *         using truncation error estimates.
  */
 #define SLEDGEHAMR_PRJ_TAG_WITHOUT_TRUNCATION_CPU                              \
     virtual void TagWithoutTruncationCpu(                                      \
-        const amrex::Array4<double const> &state_fab,                          \
+        const amrex::Array4<amrex::Real const> &state_fab,                     \
         const amrex::Array4<char> &tagarr, const amrex::Box &tilebox,          \
         double time, int lev, long *ntags_total,                               \
         const std::vector<double> &params) override {                          \
@@ -667,7 +885,7 @@ namespace sledgehamr {
  */
 #define SLEDGEHAMR_PRJ_TAG_WITHOUT_TRUNCATION_GPU                              \
     virtual void TagWithoutTruncationGpu(                                      \
-        const amrex::Array4<double const> &state_fab,                          \
+        const amrex::Array4<amrex::Real const> &state_fab,                     \
         const amrex::Array4<char> &tagarr, const amrex::Box &tilebox,          \
         double time, int lev, const std::vector<double> &params) override {    \
         amrex::Gpu::AsyncArray async_params(params.data(), params.size());     \
@@ -691,10 +909,13 @@ namespace sledgehamr {
     SLEDGEHAMR_PRJ_CONSTRUCTOR(prj)                                            \
     SLEDGEHAMR_PRJ_FILL_RHS                                                    \
     SLEDGEHAMR_PRJ_FILL_ADD_RHS                                                \
+    SLEDGEHAMR_PRJ_FILL_RHS_BOX                                                \
+    SLEDGEHAMR_PRJ_FILL_ADD_RHS_BOX                                            \
     SLEDGEHAMR_PRJ_TAG_WITH_TRUNCATION_CPU                                     \
     SLEDGEHAMR_PRJ_TAG_WITH_TRUNCATION_GPU                                     \
     SLEDGEHAMR_PRJ_TAG_WITHOUT_TRUNCATION_CPU                                  \
-    SLEDGEHAMR_PRJ_TAG_WITHOUT_TRUNCATION_GPU
+    SLEDGEHAMR_PRJ_TAG_WITHOUT_TRUNCATION_GPU                                  \
+    SLEDGEHAMR_PRJ_AVERAGE_DOWN_WITH_TRUNCATION_TAGS_CPU
 
 }; // namespace sledgehamr
 
@@ -0,0 +1,377 @@
+#include "morton_clustering.h"
+#include "sledgehamr.h"
+
+namespace sledgehamr {
+
+namespace {
+
+/** @brief Spreads the lowest 21 bits of an integer such that two zero bits
+ *         are inserted between each bit.
+ */
+std::uint64_t SpreadBits(std::uint64_t x) {
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffff;
+    x = (x | x << 16) & 0x1f0000ff0000ff;
+    x = (x | x << 8) & 0x100f00f00f00f00f;
+    x = (x | x << 4) & 0x10c30c30c30c30c3;
+    x = (x | x << 2) & 0x1249249249249249;
+    return x;
+}
+
+/** @brief Inverse of SpreadBits.
+ */
+std::uint64_t CompactBits(std::uint64_t x) {
+    x &= 0x1249249249249249;
+    x = (x ^ (x >> 2)) & 0x10c30c30c30c30c3;
+    x = (x ^ (x >> 4)) & 0x100f00f00f00f00f;
+    x = (x ^ (x >> 8)) & 0x1f0000ff0000ff;
+    x = (x ^ (x >> 16)) & 0x1f00000000ffff;
+    x = (x ^ (x >> 32)) & 0x1fffff;
+    return x;
+}
+
+}; // namespace
+
+/** @brief Reads clustering parameters.
+ * @param   owner   Pointer to the simulation.
+ */
+MortonClustering::MortonClustering(Sledgehamr *owner) : sim(owner) {
+    amrex::ParmParse pp("amr");
+    pp.query("clustering", algorithm);
+    pp.query("n_proper", n_proper);
+    pp.query("refine_grid_layout", refine_grid_layout);
+
+    if (algorithm < ClusteringAlgorithm::BergerRigoutsos ||
+        algorithm > ClusteringAlgorithm::Morton) {
+        amrex::Abort("#error: Unknown clustering algorithm: " +
+                     std::to_string(algorithm));
+    }
+}
+
+/** @brief Same as amrex::AmrMesh::MakeNewGrids but clusters tags by merging
+ *         Morton-sorted tiles.
+ * @param   lbase       Coarsest level that will not be changed.
+ * @param   time        Current time.
+ * @param   new_finest  New finest level.
+ * @param   new_grids   New BoxArrays of all levels above lbase.
+ */
+void MortonClustering::MakeNewGrids(int lbase, double time, int &new_finest,
+                                    amrex::Vector<amrex::BoxArray> &new_grids) {
+    const int max_crse = std::min(sim->finest_level, sim->max_level - 1);
+    if (new_grids.size() < max_crse + 2)
+        new_grids.resize(max_crse + 2);
+
+    // Tile size of each level in units of its cells, i.e. the blocking
+    // factor of the next finer level.
+    std::vector<int> bf(max_crse + 1, 1);
+    for (int lev = lbase; lev <= max_crse; ++lev)
+        bf[lev] = std::max(1, sim->blockingFactor(lev + 1)[0] / 2);
+
+    // Proper nesting domain in units of tiles. Derived from lbase which is
+    // not going to change.
+    std::vector<amrex::BoxList> p_n(max_crse + 1);
+    amrex::BoxList p_n_comp;
+    for (int lev = lbase; lev <= max_crse; ++lev) {
+        const amrex::Box pc_domain =
+            amrex::coarsen(sim->Geom(lev).Domain(), bf[lev]);
+
+        if (lev == lbase) {
+            amrex::BoxList bl = sim->boxArray(lbase).simplified_list();
+            bl.coarsen(bf[lev]);
+            p_n_comp.complementIn(pc_domain, bl);
+        } else {
+            p_n_comp.refine(std::max(1, 2 * bf[lev - 1] / bf[lev]));
+        }
+
+        // n_proper is given in cells of this level.
+        p_n_comp.simplify();
+        p_n_comp.accrete((n_proper + bf[lev] - 1) / bf[lev]);
+        ProjPeriodic(p_n_comp, pc_domain);
+        p_n[lev].complementIn(pc_domain, p_n_comp);
+        p_n[lev].simplify();
+    }
+
+    // Generate grids from the finest level down.
+    new_finest = lbase;
+    for (int levc = max_crse; levc >= lbase; --levc) {
+        const int levf = levc + 1;
+        const amrex::BoxArray &grids = sim->boxArray(levc);
+
+        // Grow tags far enough to contain the next finer level projected down.
+        amrex::IntVect ngt(sim->nErrorBuf(levc));
+        amrex::BoxArray ba_proj;
+        if (levf < new_finest) {
+            ba_proj = new_grids[levf + 1].simplified();
+            ba_proj.coarsen(sim->refRatio(levf));
+            ba_proj.growcoarsen(n_proper, sim->refRatio(levc));
+
+            amrex::BoxArray levc_ba = grids.simplified();
+            int ngrow = 0;
+            while (!levc_ba.contains(ba_proj)) {
+                levc_ba.grow(1);
+                ++ngrow;
+            }
+            ngt.max(amrex::IntVect(ngrow));
+        }
+
+        amrex::TagBoxArray tags(grids, sim->DistributionMap(levc), ngt);
+        sim->ErrorEst(levc, tags, time, 0);
+
+        if (levf < new_finest)
+            tags.setVal(ba_proj, amrex::TagBox::SET);
+
+        tags.buffer(amrex::IntVect(sim->nErrorBuf(levc)));
+        tags.mapPeriodicRemoveDuplicates(sim->Geom(levc));
+        const long ntags = CountTags(tags);
+        tags.coarsen(amrex::IntVect(bf[levc]));
+
+        // Largest cube edge in tiles that does not exceed max_grid_size.
+        const int max_tiles = std::max(
+            1, sim->maxGridSize(levf)[0] / (bf[levc] * sim->refRatio(levc)[0]));
+        int max_cube_level = 0;
+        while ((2 << max_cube_level) <= max_tiles)
+            ++max_cube_level;
+
+        const amrex::Box pc_domain =
+            amrex::coarsen(sim->Geom(levc).Domain(), bf[levc]);
+        amrex::BoxList new_bl = Cluster(tags, pc_domain, max_cube_level);
+        tags.clear();
+
+        new_bl.intersect(p_n[levc]);
+        if (new_bl.isEmpty())
+            continue;
+
+        new_finest = std::max(new_finest, levf);
+
+        // Join cubes into larger boxes and chop them in units of tiles such
+        // that they remain aligned with the blocking factor.
+        new_bl.simplify();
+        new_bl.maxSize(max_tiles);
+        new_bl.refine(bf[levc]);
+
+        long ncells = 0;
+        for (const amrex::Box &bx : new_bl)
+            ncells += bx.numPts();
+        sim->performance_monitor->Count(
+            sim->performance_monitor->idx_clustering_efficiency,
+            static_cast<double>(ntags) / static_cast<double>(ncells), levf);
+
+        new_bl.refine(sim->refRatio(levc));
+        new_grids[levf] = amrex::BoxArray(std::move(new_bl));
+    }
+
+    if (refine_grid_layout) {
+        for (int lev = lbase + 1; lev <= new_finest; ++lev) {
+            sim->ChopGrids(lev, new_grids[lev],
+                           amrex::ParallelDescriptor::NProcs());
+        }
+    }
+}
+
+/** @brief Merges all tagged tiles into aligned cubes, first on each rank and
+ *         then across ranks.
+ * @param   tags            Tags coarsened to one tag per tile.
+ * @param   domain          Problem domain in units of tiles.
+ * @param   max_cube_level  Cubes will at most contain 8^max_cube_level tiles.
+ * @return  Disjoint cubes covering exactly the tagged tiles of all ranks.
+ */
+amrex::BoxList MortonClustering::Cluster(const amrex::TagBoxArray &tags,
+                                         const amrex::Box &domain,
+                                         const int max_cube_level) {
+    std::vector<std::uint64_t> keys;
+
+#pragma omp parallel
+    {
+        std::vector<std::uint64_t> my_keys;
+
+        for (amrex::MFIter mfi(tags); mfi.isValid(); ++mfi) {
+            const amrex::Array4<char const> &tag_arr = tags.const_array(mfi);
+            const amrex::Box bx = amrex::Box(tag_arr) & domain;
+            const amrex::Dim3 lo = amrex::lbound(bx);
+            const amrex::Dim3 hi = amrex::ubound(bx);
+
+            for (int k = lo.z; k <= hi.z; ++k) {
+                for (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        if (tag_arr(i, j, k) == amrex::TagBox::SET)
+                            my_keys.push_back(Encode(amrex::IntVect(i, j, k)));
+                    }
+                }
+            }
+        }
+
+#pragma omp critical
+        keys.insert(keys.end(), my_keys.begin(), my_keys.end());
+    }
+
+    // Local merge. Tiles can appear twice if boxes overlap after coarsening.
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<Cube> cubes;
+    cubes.reserve(keys.size());
+    for (const std::uint64_t key : keys)
+        cubes.push_back({key, 0});
+    keys.clear();
+    Merge(cubes, max_cube_level);
+
+    // Global merge of the cubes of all ranks.
+    amrex::Vector<amrex::Box> boxes;
+    boxes.reserve(cubes.size());
+    for (const Cube &cube : cubes)
+        boxes.push_back(ToBox(cube));
+    amrex::AllGatherBoxes(boxes);
+
+    cubes.clear();
+    cubes.reserve(boxes.size());
+    for (const amrex::Box &box : boxes)
+        cubes.push_back(FromBox(box));
+    boxes.clear();
+
+    // Aligned cubes are either disjoint or nested. Remove nested ones.
+    std::sort(cubes.begin(), cubes.end(), [](const Cube &a, const Cube &b) {
+        return a.key < b.key || (a.key == b.key && a.level > b.level);
+    });
+    std::size_t n = 0;
+    std::uint64_t end = 0;
+    for (const Cube &cube : cubes) {
+        if (n > 0 && cube.key < end)
+            continue;
+
+        cubes[n++] = cube;
+        end = cube.key + (std::uint64_t(1) << (3 * cube.level));
+    }
+    cubes.resize(n);
+    Merge(cubes, max_cube_level);
+
+    amrex::BoxList bl;
+    for (const Cube &cube : cubes)
+        bl.push_back(ToBox(cube));
+
+    return bl;
+}
+
+/** @brief Merges any eight sibling cubes into their parent cube until no
+ *         further merges are possible.
+ * @param   cubes           Disjoint cubes sorted by key. Will be overwritten
+ *                          with the merged cubes.
+ * @param   max_cube_level  Cubes will at most contain 8^max_cube_level tiles.
+ */
+void MortonClustering::Merge(std::vector<Cube> &cubes,
+                             const int max_cube_level) {
+    std::vector<Cube> stack;
+    stack.reserve(cubes.size());
+
+    for (const Cube &cube : cubes) {
+        stack.push_back(cube);
+
+        while (stack.size() >= 8) {
+            const Cube first = stack[stack.size() - 8];
+            const int level = first.level;
+            const std::uint64_t len = std::uint64_t(1) << (3 * level);
+
+            if (level >= max_cube_level || first.key % (8 * len) != 0 ||
+                stack.back().key != first.key + 7 * len)
+                break;
+
+            bool siblings = true;
+            for (std::size_t s = stack.size() - 7; s < stack.size(); ++s)
+                siblings &= stack[s].level == level;
+
+            if (!siblings)
+                break;
+
+            stack.resize(stack.size() - 8);
+            stack.push_back({first.key, level + 1});
+        }
+    }
+
+    std::swap(cubes, stack);
+}
+
+/** @brief Counts the number of tagged cells across all ranks.
+ * @param   tags    Tags.
+ * @return  Number of tagged valid cells.
+ */
+long MortonClustering::CountTags(const amrex::TagBoxArray &tags) {
+    long ntags = 0;
+
+#pragma omp parallel reduction(+ : ntags)
+    for (amrex::MFIter mfi(tags, true); mfi.isValid(); ++mfi) {
+        const amrex::Box &tilebox = mfi.tilebox();
+        const amrex::Array4<char const> &tag_arr = tags.const_array(mfi);
+        const amrex::Dim3 lo = amrex::lbound(tilebox);
+        const amrex::Dim3 hi = amrex::ubound(tilebox);
+
+        for (int k = lo.z; k <= hi.z; ++k) {
+            for (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    if (tag_arr(i, j, k) == amrex::TagBox::SET)
+                        ntags++;
+                }
+            }
+        }
+    }
+
+    amrex::ParallelDescriptor::ReduceLongSum(ntags);
+    return ntags;
+}
+
+/** @brief Computes the Morton key of a tile.
+ * @param   iv  Tile index. Each component has to be < 2^21.
+ * @return  Morton key.
+ */
+std::uint64_t MortonClustering::Encode(const amrex::IntVect &iv) {
+    return SpreadBits(iv[0]) | SpreadBits(iv[1]) << 1 | SpreadBits(iv[2]) << 2;
+}
+
+/** @brief Computes the tile index of a Morton key.
+ * @param   key Morton key.
+ * @return  Tile index.
+ */
+amrex::IntVect MortonClustering::Decode(const std::uint64_t key) {
+    return amrex::IntVect(CompactBits(key), CompactBits(key >> 1),
+                          CompactBits(key >> 2));
+}
+
+/** @brief Converts a cube into a box in units of tiles.
+ */
+amrex::Box MortonClustering::ToBox(const Cube &cube) {
+    const amrex::IntVect lo = Decode(cube.key);
+    return amrex::Box(lo, lo + ((1 << cube.level) - 1));
+}
+
+/** @brief Converts a box created by ToBox back into a cube.
+ */
+MortonClustering::Cube MortonClustering::FromBox(const amrex::Box &box) {
+    int level = 0;
+    while ((1 << level) < box.length(0))
+        ++level;
+
+    return {Encode(box.smallEnd()), level};
+}
+
+/** @brief Adds periodic images of boxes that overlap the domain boundary.
+ * @param   bl      Boxes.
+ * @param   domain  Periodic domain.
+ */
+void MortonClustering::ProjPeriodic(amrex::BoxList &bl,
+                                    const amrex::Box &domain) const {
+    amrex::BoxList images;
+    const amrex::Periodicity period(domain.length());
+
+    for (const amrex::IntVect &shift : period.shiftIntVect()) {
+        if (shift == amrex::IntVect::TheZeroVector())
+            continue;
+
+        amrex::BoxList tmp(bl);
+        for (int d = 0; d < AMREX_SPACEDIM; ++d)
+            tmp.shift(d, shift[d]);
+        tmp.intersect(domain);
+        images.catenate(tmp);
+    }
+
+    bl.catenate(images);
+}
+
+}; // namespace sledgehamr
@@ -0,0 +1,81 @@
+#ifndef SLEDGEHAMR_MORTON_CLUSTERING_H_
+#define SLEDGEHAMR_MORTON_CLUSTERING_H_
+
+#include <cstdint>
+
+#include <AMReX_BoxList.H>
+#include <AMReX_TagBox.H>
+
+namespace sledgehamr {
+
+class Sledgehamr;
+
+/** @brief Enum containing all valid clustering algorithms for global regrids.
+ *         These are the values that are being used in the inputs file under
+ *         'amr.clustering'.
+ */
+enum ClusteringAlgorithm {
+    BergerRigoutsos = 0,
+    Morton = 1
+};
+
+/** @brief Generates the grids of a global regrid from blocking factor aligned
+ *         tiles instead of running Berger-Rigoutsos on the full tag set. Every
+ *         tagged tile is assigned a Morton key. Sorted by key, any eight
+ *         aligned sibling cubes of equal size are adjacent and can be merged
+ *         into their parent cube in a single stack-based pass. Tiles are
+ *         merged on each rank first, only the resulting cubes are gathered
+ *         and merged again across ranks. Proper nesting is enforced the same
+ *         way amrex::AmrMesh::MakeNewGrids does, i.e. new grids are clipped
+ *         to the proper nesting domain and the grids of the next finer level
+ *         are projected down and tagged.
+ */
+class MortonClustering {
+  public:
+    MortonClustering(Sledgehamr *owner);
+
+    void MakeNewGrids(int lbase, double time, int &new_finest,
+                      amrex::Vector<amrex::BoxArray> &new_grids);
+
+    static std::uint64_t Encode(const amrex::IntVect &iv);
+
+    /** @brief Selected clustering algorithm, see ClusteringAlgorithm.
+     */
+    int algorithm = ClusteringAlgorithm::BergerRigoutsos;
+
+  private:
+    /** @brief Aligned cube of 8^level tiles starting at Morton key key.
+     */
+    struct Cube {
+        std::uint64_t key;
+        int level;
+    };
+
+    static amrex::IntVect Decode(const std::uint64_t key);
+    static amrex::Box ToBox(const Cube &cube);
+    static Cube FromBox(const amrex::Box &box);
+    static void Merge(std::vector<Cube> &cubes, const int max_cube_level);
+    static long CountTags(const amrex::TagBoxArray &tags);
+
+    amrex::BoxList Cluster(const amrex::TagBoxArray &tags,
+                           const amrex::Box &domain, const int max_cube_level);
+    void ProjPeriodic(amrex::BoxList &bl, const amrex::Box &domain) const;
+
+    /** @brief Whether new grids are chopped such that every rank gets at
+     *         least one box. Same as amr.refine_grid_layout in AMReX.
+     */
+    bool refine_grid_layout = true;
+
+    /** @brief Number of cells by which a level is required to be nested within
+     *         the next coarser level. Same as amr.n_proper in AMReX.
+     */
+    int n_proper = 1;
+
+    /** @brief Pointer to the simulation.
+     */
+    Sledgehamr *sim;
+};
+
+}; // namespace sledgehamr
+
+#endif // SLEDGEHAMR_MORTON_CLUSTERING_H_
@@ -146,6 +146,7 @@ void Checkpoint::Read() {
     std::istringstream is(fileCharPtrString, std::istringstream::in);
 
     sim->finest_level = finest_level;
+    bool nghost_changed = false;
     for (int lev = 0; lev <= finest_level; ++lev) {
         amrex::BoxArray ba;
         ba.readFrom(is);
@@ -156,11 +157,18 @@ void Checkpoint::Read() {
         sim->SetDistributionMap(lev, dm);
 
         // In case nghost changed, we can create grid_old already with the new
-        // value. grid_new has to be set to the old value first since ghost
-        // cells are saved in the checkpoint. We change nghost for this MultiFab
-        // later below.
-        sim->grid_old[lev].define(ba, dm, nscalars, sim->nghost);
-        sim->grid_new[lev].define(ba, dm, nscalars, nghost, time);
+        // value. grid_new has to be set to the stored value first since ghost
+        // cells are saved in the checkpoint. The stored value may differ
+        // between levels with temporal blocking, so we take it from the
+        // MultiFab header. We change nghost for this MultiFab later below.
+        amrex::VisMF vismf(
+            amrex::MultiFabFileFullPrefix(lev, folder, "Level_", "Cell"));
+        const int stored_nghost = vismf.nGrow();
+        if (stored_nghost != sim->NGhost(lev))
+            nghost_changed = true;
+
+        sim->grid_old[lev].define(ba, dm, nscalars, sim->NGhost(lev));
+        sim->grid_new[lev].define(ba, dm, nscalars, stored_nghost, time);
     }
 
     for (int lev = 0; lev <= finest_level; ++lev) {
@@ -169,11 +177,11 @@ void Checkpoint::Read() {
             amrex::MultiFabFileFullPrefix(lev, folder, "Level_", "Cell"));
     }
 
-    if (nghost != sim->nghost) {
+    if (nghost_changed) {
         amrex::Print() << "#warning: Number of ghost cells has changed!\n"
                        << "checkpoint: " << nghost
                        << " vs input file: " << sim->nghost << std::endl;
-        sim->level_synchronizer->ChangeNGhost(nghost);
+        sim->level_synchronizer->ChangeNGhost();
     }
 
     if (MPIranks != amrex::ParallelDescriptor::NProcs()) {
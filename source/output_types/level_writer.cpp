@@ -61,6 +61,12 @@ void LevelWriter::ParseParams() {
                        << std::endl;
     }
 
+    if (precision == 64 && sizeof(amrex::Real) < sizeof(double)) {
+        amrex::Print() << "Warning: 64-bit output requested for " << name
+                       << " but state is stored in single precision."
+                       << std::endl;
+    }
+
     CheckDownsampleFactor();
 }
 
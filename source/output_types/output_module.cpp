@@ -59,20 +59,31 @@ void OutputModule::CreateParentFolder(std::string this_prefix) {
     }
 }
 
-/** @brief Does the actual writing if criteria are met.
+/** @brief Checks whether this output is going to be written at a given time.
  * @param   time    Current time.
- * @param   force   Output will be written independent of the current time
- *                  interval if forceable=true.
+ * @param   force   Whether the write would be forced.
+ * @return  Whether output is due.
  */
-void OutputModule::Write(double time, bool force) {
-    if (interval < 0) return;
+bool OutputModule::IsDue(double time, bool force) const {
+    if (interval < 0) return false;
 
     // Check if it is time to write output.
     double t_now  = time_modifier(time);
     double t_last = time_modifier(last_written);
 
-    if (t_now > t_max || t_now < t_min) return;
-    if (t_now - t_last < interval && (!force && forceable)) return;
+    if (t_now > t_max || t_now < t_min) return false;
+    if (t_now - t_last < interval && (!force && forceable)) return false;
+
+    return true;
+}
+
+/** @brief Does the actual writing if criteria are met.
+ * @param   time    Current time.
+ * @param   force   Output will be written independent of the current time
+ *                  interval if forceable=true.
+ */
+void OutputModule::Write(double time, bool force) {
+    if (!IsDue(time, force)) return;
 
     std::string this_prefix = (alternate && next_id%2 == 1) ?
                               alt_prefix : prefix;
@@ -32,6 +32,7 @@ class OutputModule {
     OutputModule(std::string module_name, output_fct function,
                  bool is_forceable=true);
     void Write(double time, bool force=false);
+    bool IsDue(double time, bool force=false) const;
 
     /** @brief Change the time interval to something arbitrary.
      * @param   mod Time modifier function.
@@ -47,6 +48,12 @@ class OutputModule {
         return time;
     };
 
+    /** @brief Whether this output is ever written.
+     */
+    bool IsEnabled() const {
+        return interval >= 0;
+    };
+
     /** @brief Change time interval width.
      */
     void SetInterval(double new_interval) {
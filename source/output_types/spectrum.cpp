@@ -4,12 +4,14 @@
 
 namespace sledgehamr {
 
-/** @brief Computes a spectrum and saves it to disk.
- * @param   id      Output counter id.
- * @param   file_id HDF5 file id.
- * @param   sim     Pointer to the simulation.
+/** @brief Computes the local contribution of this rank to a spectrum. The
+ *         reduction across ranks and writing to disk are done by the caller,
+ *         such that all spectra of an output step share a single reduction.
+ * @param   spectrum    Array of length sim->spectrum_bins->NBins(). Will
+ *                      contain the local contribution.
+ * @param   sim         Pointer to the simulation.
  */
-void Spectrum::Compute(const int id, const hid_t file_id, Sledgehamr *sim) {
+void Spectrum::Compute(double *spectrum, Sledgehamr *sim) {
     const int lev = 0;
     const int dimN = sim->dimN[lev];
     const double dx = sim->dx[lev];
@@ -20,7 +22,6 @@ void Spectrum::Compute(const int id, const hid_t file_id, Sledgehamr *sim) {
 
     amrex::MultiFab field, field_fft;
     field.define(ba, sim->dmap[lev], 1, 0);
-    // field_fft.define(ba, sim->dmap[lev], 1, 0);
 
     std::vector<double> params;
     sim->SetParamsSpectra(params, time);
@@ -50,66 +51,45 @@ void Spectrum::Compute(const int id, const hid_t file_id, Sledgehamr *sim) {
     double dk = 2. * M_PI / sim->L;
     double pre = fac * state.t / dk;
 
-    std::vector<int> &ks = sim->spectrum_ks;
-    const int kmax = ks.size();
-    constexpr int NTHREADS = 16;
-    const unsigned long SpecLen = kmax * NTHREADS;
-    std::unique_ptr<double[]> spectrum(new double[SpecLen]);
-    std::fill_n(spectrum.get(), SpecLen, 0.0);
+    SpectrumBins *bins = sim->spectrum_bins.get();
+    bins->Build(dimN);
+    const int *sq_to_bin = bins->sq_to_bin.data();
+    const int kmax = bins->NBins();
+    SpectrumHistogram histogram(kmax);
 
-#pragma omp parallel num_threads(std::min(NTHREADS, omp_get_max_threads()))
-    for (amrex::MFIter mfi(field_fft, true); mfi.isValid(); ++mfi) {
-        const amrex::Box &bx = mfi.tilebox();
-        const amrex::Array4<double> &field_fft_arr = field_fft.array(mfi);
-
-        const int il = bx.smallEnd()[0];
-        const int ih = bx.bigEnd()[0];
-        const int jl = bx.smallEnd()[1];
-        const int jh = bx.bigEnd()[1];
-        const int kl = bx.smallEnd()[2];
-        const int kh = bx.bigEnd()[2];
-
-        for (int i = il; i <= ih; ++i) {
-            for (int j = jl; j <= jh; ++j) {
-                AMREX_PRAGMA_SIMD
-                for (int k = kl; k <= kh; ++k) {
-                    // To account for negative frequencies
-                    double multpl = (i == 0 || i == dimN / 2) ? 1. : 2.;
-                    int li = i >= dimN / 2 ? i - dimN : i;
-                    int lj = j >= dimN / 2 ? j - dimN : j;
-                    int lk = k >= dimN / 2 ? k - dimN : k;
-                    unsigned int sq = li * li + lj * lj + lk * lk;
-                    unsigned long index =
-                        std::lower_bound(ks.begin(), ks.end(), sq) -
-                        ks.begin() + omp_get_thread_num() * kmax;
-                    spectrum[index] += multpl * pre *
-                                       field_fft_arr(i, j, k, 0) *
-                                       field_fft_arr(i, j, k, 0);
+#pragma omp parallel
+    {
+        double *hist = histogram.ThreadLocal();
+
+        for (amrex::MFIter mfi(field_fft, true); mfi.isValid(); ++mfi) {
+            const amrex::Box &bx = mfi.tilebox();
+            const amrex::Array4<amrex::Real> &field_fft_arr =
+                field_fft.array(mfi);
+
+            const amrex::Dim3 lo = amrex::lbound(bx);
+            const amrex::Dim3 hi = amrex::ubound(bx);
+
+            // The bin index is computed directly from the integer |k|^2. No
+            // SIMD here since different lanes may hit the same bin.
+            for (int k = lo.z; k <= hi.z; ++k) {
+                const int lk = k >= dimN / 2 ? k - dimN : k;
+                for (int j = lo.y; j <= hi.y; ++j) {
+                    const int lj = j >= dimN / 2 ? j - dimN : j;
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        // To account for negative frequencies
+                        double multpl = (i == 0 || i == dimN / 2) ? 1. : 2.;
+                        int li = i >= dimN / 2 ? i - dimN : i;
+                        unsigned int sq = li * li + lj * lj + lk * lk;
+                        const double f = field_fft_arr(i, j, k, 0);
+                        hist[sq_to_bin[sq]] += multpl * pre * f * f;
+                    }
                 }
             }
         }
     }
 
-    for (int a = 1; a < NTHREADS; ++a) {
-        for (int c = 0; c < kmax; ++c) {
-            spectrum[c] += spectrum[a * kmax + c];
-        }
-    }
-
-    amrex::ParallelDescriptor::ReduceRealSum(
-        spectrum.get(), kmax, amrex::ParallelDescriptor::IOProcessorNumber());
-
-    if (amrex::ParallelDescriptor::IOProcessor()) {
-        if (id == 0) {
-            const int nparams = 3;
-            double header_data[nparams] = {sim->grid_new[lev].t, (double)dimN,
-                                           (double)kmax};
-            utils::hdf5::Write(file_id, "Header", header_data, nparams);
-            utils::hdf5::Write(file_id, "k_sq", &(ks[0]), kmax);
-        }
-
-        utils::hdf5::Write(file_id, ident, spectrum.get(), kmax);
-    }
+    histogram.Reduce();
+    std::copy_n(histogram.Result(), kmax, spectrum);
 }
 
 }; // namespace sledgehamr
@@ -24,7 +24,7 @@ class Spectrum {
     Spectrum(spectrum_fct function, std::string identification)
         : fct{function}, ident{identification} { };
 
-    void Compute(const int id, const hid_t file_id, Sledgehamr* sim);
+    void Compute(double* spectrum, Sledgehamr* sim);
 
     static void Fft(const amrex::MultiFab& field, const int comp,
                     amrex::MultiFab& field_fft_real_or_abs,
@@ -1,4 +1,5 @@
 #include "performance_monitor.h"
+#include "hdf5_utils.h"
 #include "sledgehamr_utils.h"
 
 namespace sledgehamr {
@@ -38,6 +39,13 @@ PerformanceMonitor::PerformanceMonitor(Sledgehamr* owner)
         timer.emplace_back("LevelSynchronizer::FillIntermediatePatch " + post);
     }
 
+    idx_ghost_cache_build = timer.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        timer.emplace_back("CoarseFineGhostCache::CoarseFineGhostCache "
+                           + post);
+    }
+
     idx_average_down = timer.size() + 1;
     for(int lev = -1; lev <= sim->max_level; ++lev) {
         std::string post = utils::LevelName(lev);
@@ -64,12 +72,47 @@ PerformanceMonitor::PerformanceMonitor(Sledgehamr* owner)
                            + " (and higher)");
     }
 
+    idx_local_regrid_tag = timer.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        timer.emplace_back("LocalRegrid tagging " + post
+                           + " (and higher)");
+    }
+
+    idx_local_regrid_border = timer.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        timer.emplace_back("LocalRegrid C/F border detection " + post
+                           + " (and higher)");
+    }
+
+    idx_local_regrid_merge = timer.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        timer.emplace_back("UniqueLayout::Merge " + post
+                           + " (and higher)");
+    }
+
+    idx_local_regrid_distribute = timer.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        timer.emplace_back("UniqueLayout::Distribute " + post
+                           + " (and higher)");
+    }
+
     idx_global_regrid = timer.size() + 1;
     for(int lev = -1; lev <= sim->max_level; ++lev) {
         std::string post = utils::LevelName(lev);
         timer.emplace_back("AmrCore::regrid " + post + " (and higher)");
     }
 
+    idx_clustering = timer.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        timer.emplace_back("Sledgehamr::MakeNewGrids " + post
+                           + " (and higher)");
+    }
+
     idx_read_input = timer.size();
     if (sim->restart_sim)
         timer.emplace_back("IOModule::RestartSim");
@@ -80,6 +123,107 @@ PerformanceMonitor::PerformanceMonitor(Sledgehamr* owner)
     for(OutputModule& out : sim->io_module->output) {
         timer.emplace_back("OutputModule::Write " + out.GetName());
     }
+
+    // Counters. Same level offset as timers.
+    idx_rkn_bytes_allocated = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("IntegratorRkn bytes allocated/cell " + post);
+    }
+
+    idx_rkn_bytes_resident = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("IntegratorRkn bytes resident/cell " + post);
+    }
+
+    idx_scratch_pool_hits = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("ScratchPool hits " + post);
+    }
+
+    idx_scratch_pool_misses = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("ScratchPool misses " + post);
+    }
+
+    idx_cells_per_second = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("Cells/s advanced " + post);
+    }
+
+    idx_grid_old_bytes = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("grid_old bytes resident " + post);
+    }
+
+    idx_grid_old_bytes_unreleased = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("grid_old bytes resident (never released) "
+                             + post);
+    }
+
+    idx_load_imbalance_before = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("Load imbalance before balancing " + post);
+    }
+
+    idx_load_imbalance_after = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("Load imbalance after balancing " + post);
+    }
+
+    idx_regrids_skipped = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("Regrids skipped by prediction " + post);
+    }
+
+    idx_tagging_cells_skipped = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("Fraction of cells skipped by tagging " + post);
+    }
+
+    idx_tagging_cells_missed = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("Tags missed by incremental tagging " + post);
+    }
+
+    idx_clustering_boxes = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("Boxes created by global regrid " + post);
+    }
+
+    idx_clustering_efficiency = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("Fill efficiency of Morton clustering " + post);
+    }
+
+    idx_autotune_tile_size = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("Tile size chosen by autotuner " + post);
+    }
+
+    idx_autotune_max_grid_size = counter.size() + 1;
+    for(int lev = -1; lev <= sim->max_level; ++lev) {
+        std::string post = utils::LevelName(lev);
+        counter.emplace_back("Max grid size chosen by autotuner " + post);
+    }
+
+    idx_scratch_pool_bytes = counter.size();
+    counter.emplace_back("ScratchPool bytes allocated");
 }
 
 /** @brief Starts a timer.
@@ -106,6 +250,16 @@ double PerformanceMonitor::Stop(int id, int offset) {
     }
 }
 
+/** @brief Adds a sample to a counter.
+ * @param   id      ID of counter.
+ * @param   value   Value to be added.
+ * @param   offset  Offset to be added to the counter ID.
+ */
+void PerformanceMonitor::Count(int id, double value, int offset) {
+    if (active)
+        counter[id + offset].Add(value);
+}
+
 /** @brief Sorts all timers by total time passed.
  * @param   timers  Vector of timers.
  * @return Vector of indices that would sort the timers.
@@ -123,10 +277,29 @@ std::vector<int> PerformanceMonitor::TimerArgsort(std::vector<Timer> timers) {
     return idx;
 }
 
-/** @brief Prints total time passed of all timers.
- * @param  file_id HDF5 file to log the times. Currently not implemented.
+/** @brief Prints total time passed of all timers. Counters with at least one
+ *         sample are printed afterwards.
+ * @param  file_id HDF5 file to log to. Only the storage precision and the
+ *                 mean number of cells advanced per second on each level are
+ *                 written, such that runs with different SLEDGEHAMR_REAL can
+ *                 be compared.
  */
 void PerformanceMonitor::Log(hid_t file_id) {
+    if (amrex::ParallelDescriptor::IOProcessor()) {
+        const int nlevels = sim->max_level + 1;
+        std::vector<double> cells_per_second(nlevels, 0.);
+        for (int lev = 0; lev < nlevels; ++lev) {
+            Counter &c = counter[idx_cells_per_second + lev];
+            if (c.GetNumberOfSamples() > 0)
+                cells_per_second[lev] = c.GetMean();
+        }
+
+        int storage_bytes = sizeof(amrex::Real);
+        utils::hdf5::Write(file_id, "storage_bytes", &storage_bytes, 1, true);
+        utils::hdf5::Write(file_id, "cells_per_second",
+                           cells_per_second.data(), nlevels);
+    }
+
     std::vector<int> idx = TimerArgsort(timer);
 
     amrex::Print() << " ------------------------ PERFORMANCE"
@@ -140,6 +313,19 @@ void PerformanceMonitor::Log(hid_t file_id) {
     }
     amrex::Print() << " ------------------------------------"
                    << "-------------------------------------" << std::endl;
+
+    amrex::Print() << " ------------------ COUNTERS (mean, max, total)"
+                   << " --------------------------\n";
+    for (Counter& c : counter) {
+        if (c.GetNumberOfSamples() == 0)
+            continue;
+
+        amrex::Print() << std::left << std::setw(60) << c.GetName()
+                       << std::setw(14) << c.GetMean() << std::setw(14)
+                       << c.GetMax() << c.GetTotal() << "\n";
+    }
+    amrex::Print() << " ------------------------------------"
+                   << "-------------------------------------" << std::endl;
 }
 
 }; // namespace sledgehamr
@@ -1,6 +1,7 @@
 #ifndef SLEDGEHAMR_PERFORMANCE_MONITOR_H_
 #define SLEDGEHAMR_PERFORMANCE_MONITOR_H_
 
+#include "counter.h"
 #include "sledgehamr.h"
 #include "timer.h"
 
@@ -12,6 +13,7 @@ class PerformanceMonitor {
 
     void Start(int id, int offset = 0);
     double Stop(int id, int offset = 0);
+    void Count(int id, double value, int offset = 0);
     void Log(hid_t file_id);
 
     /** @brief Returns whether the performance monitor is active.
@@ -26,18 +28,48 @@ class PerformanceMonitor {
     int idx_rhs = -1;
     int idx_fill_patch = -1;
     int idx_fill_intermediate_patch = -1;
+    int idx_ghost_cache_build = -1;
     int idx_average_down = -1;
     int idx_truncation_error = -1;
     int idx_tagging = -1;
     int idx_local_regrid = -1;
+    int idx_local_regrid_tag = -1;
+    int idx_local_regrid_border = -1;
+    int idx_local_regrid_merge = -1;
+    int idx_local_regrid_distribute = -1;
     int idx_global_regrid = -1;
+    int idx_clustering = -1;
     int idx_read_input = -1;
     int idx_output = -1;
 
+    /** @brief IDs of counters.
+     */
+    int idx_rkn_bytes_allocated = -1;
+    int idx_rkn_bytes_resident = -1;
+    int idx_scratch_pool_hits = -1;
+    int idx_scratch_pool_misses = -1;
+    int idx_scratch_pool_bytes = -1;
+    int idx_cells_per_second = -1;
+    int idx_grid_old_bytes = -1;
+    int idx_grid_old_bytes_unreleased = -1;
+    int idx_load_imbalance_before = -1;
+    int idx_load_imbalance_after = -1;
+    int idx_regrids_skipped = -1;
+    int idx_tagging_cells_skipped = -1;
+    int idx_tagging_cells_missed = -1;
+    int idx_clustering_boxes = -1;
+    int idx_clustering_efficiency = -1;
+    int idx_autotune_tile_size = -1;
+    int idx_autotune_max_grid_size = -1;
+
     /** @brief Vector of all timers.
      */
     std::vector<Timer> timer;
 
+    /** @brief Vector of all counters.
+     */
+    std::vector<Counter> counter;
+
   private:
     std::vector<int> TimerArgsort(std::vector<Timer> timers);
 
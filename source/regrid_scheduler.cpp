@@ -2,6 +2,15 @@
 
 namespace sledgehamr {
 
+/** @brief Reads parameters of the predictive regrid scheduling.
+ */
+RegridScheduler::RegridScheduler() {
+    amrex::ParmParse pp("amr");
+    pp.query("predictive_regrid", predictive_regrid);
+    pp.query("predictive_regrid_safety", predictive_regrid_safety);
+    pp.query("predictive_regrid_max_delay", predictive_regrid_max_delay);
+}
+
 /** @brief Schedules a regrid.
  * @param   lev Lowest level to be regridded.
  * @param   t   Regrid time.
@@ -64,8 +73,11 @@ int RegridScheduler::FindSchedule(double t) const {
     int id = -1;
 
     if (!schedule.empty())
-        id = std::distance(schedule.begin(), std::find(schedule.begin(),
-                           schedule.end(), t));
+        id = std::distance(schedule.begin(),
+                           std::find_if(schedule.begin(), schedule.end(),
+                                        [&](const ScheduledRegrid &s) {
+                                            return s.Matches(t, tolerance);
+                                        }));
 
     if (id == schedule.size())
         id = -1;
@@ -73,4 +85,84 @@ int RegridScheduler::FindSchedule(double t) const {
     return id;
 }
 
+/** @brief Records the shortest distance between a tagged cell and the
+ *         coarse/fine boundary of a level measured during a regrid. Updates
+ *         the front velocity if the boundary has not moved since the last
+ *         measurement and predicts the latest safe time for the next regrid.
+ *         Needs to be called with identical arguments on all MPI ranks.
+ * @param   lev             Level.
+ * @param   t               Time.
+ * @param   distance        Shortest distance in cells of level lev.
+ * @param   layout_changed  Whether the layout of lev has been changed as a
+ *                          result of this regrid.
+ * @param   regrid_dt       Regular regrid interval of level lev.
+ * @param   n_error_buf     Size of the error buffer. Tagged cells closer than
+ *                          this to the boundary require a regrid.
+ */
+void RegridScheduler::RecordFront(int lev, double t, double distance,
+                                  bool layout_changed, double regrid_dt,
+                                  int n_error_buf) {
+    if (static_cast<int>(front.size()) <= lev) {
+        front.resize(lev + 1);
+        front_velocity.resize(lev + 1, -1.);
+        predicted_time.resize(lev + 1, -DBL_MAX);
+    }
+
+    FrontSample &last = front[lev];
+    if (!last.layout_changed && t > last.t + tolerance) {
+        double v = std::max(0., last.distance - distance) / (t - last.t);
+        front_velocity[lev] = std::max(v, 0.5 * front_velocity[lev]);
+    }
+
+    last.t = t;
+    last.distance = distance;
+    last.layout_changed = layout_changed;
+
+    // We cannot say anything about the distance to a boundary that has just
+    // been moved or if we have never seen tags move.
+    if (layout_changed || front_velocity[lev] < 0) {
+        predicted_time[lev] = -DBL_MAX;
+        return;
+    }
+
+    double delay = predictive_regrid_max_delay * regrid_dt;
+    if (front_velocity[lev] > 0) {
+        delay = std::min(delay, std::max(0., distance - n_error_buf) /
+                                    (predictive_regrid_safety *
+                                     front_velocity[lev]));
+    }
+
+    predicted_time[lev] = t + delay;
+}
+
+/** @brief Forgets the last measurement of a level, e.g. after a global regrid
+ *         that did not measure distances.
+ * @param   lev Level.
+ */
+void RegridScheduler::InvalidateFront(int lev) {
+    if (lev < static_cast<int>(front.size())) {
+        front[lev] = FrontSample();
+        predicted_time[lev] = -DBL_MAX;
+    }
+}
+
+/** @brief Latest time by which a regrid at lev is predicted to be needed
+ *         such that tagged cells on all finer levels stay within the refined
+ *         region.
+ * @param   lev             Coarsest level to be regridded.
+ * @param   finest_level    Current finest level.
+ * @return  Predicted time. -DBL_MAX if disabled or unknown.
+ */
+double RegridScheduler::LatestRegridTime(int lev, int finest_level) const {
+    if (!predictive_regrid || lev >= finest_level ||
+        finest_level >= static_cast<int>(predicted_time.size()))
+        return -DBL_MAX;
+
+    double t = DBL_MAX;
+    for (int l = lev + 1; l <= finest_level; ++l)
+        t = std::min(t, predicted_time[l]);
+
+    return t;
+}
+
 }; // namespace sledgehamr
@@ -21,11 +21,11 @@ class ScheduledRegrid {
 
     /** @brief Checks whether this regrid has been scheduled at a given time.
      * @param  time    Time to match.
+     * @param  tol     Absolute tolerance.
      * @return Whether times match.
      */
-    bool operator==(const double time) const {
-        double teps = t*1e-12;
-        return (t > time - teps && t < time + teps);
+    bool Matches(const double time, const double tol) const {
+        return std::abs(t - time) <= tol;
     }
 
     /** @brief Lowest level to be regridded.
@@ -37,28 +37,89 @@ class ScheduledRegrid {
     double t;
 };
 
+/** @brief Measurement of the shortest distance between a tagged cell and a
+ *         coarse/fine boundary of a level. Used to estimate how fast tagged
+ *         features approach the boundary.
+ */
+struct FrontSample {
+    /** @brief Time of measurement.
+     */
+    double t = -DBL_MAX;
+
+    /** @brief Shortest distance in units of cells of the level.
+     */
+    double distance = -1;
+
+    /** @brief Whether the layout of the level has been changed right after
+     *         the measurement.
+     */
+    bool layout_changed = true;
+};
+
 /** @brief A class that helps us keep track of when and on what levels we want
  *         to regrid. That way we can adjust our workflow accordingly by e.g.
  *         computing truncation error estimates ahead of time or creating
- *         shadow level.
+ *         shadow level. Optionally predicts whether a regrid can be skipped
+ *         based on how fast tagged cells have been approaching the coarse/fine
+ *         boundaries in the past.
  */
 class RegridScheduler {
   public:
-    /** @brief Does nothing.
-     */
-    RegridScheduler() {};
+    RegridScheduler();
 
     void Schedule(int lev, double t);
     bool DoRegrid(int lev, double t) const;
     bool NeedTruncationError(int lev, double t) const;
     void DidRegrid(double t);
 
+    /** @brief Sets the tolerance within which two times are considered equal.
+     * @param   tol Absolute tolerance.
+     */
+    void SetTolerance(double tol) { tolerance = tol; };
+
+    void RecordFront(int lev, double t, double distance, bool layout_changed,
+                     double regrid_dt, int n_error_buf);
+    void InvalidateFront(int lev);
+    double LatestRegridTime(int lev, int finest_level) const;
+
   private:
     int FindSchedule(double t) const;
 
     /** @brief Vector containing all scheduled regrids.
      */
     std::vector<ScheduledRegrid> schedule;
+
+    /** @brief Times within this tolerance are considered equal.
+     */
+    double tolerance = 0;
+
+    /** @brief Whether to skip regrids that are predicted to be unnecessary.
+     */
+    bool predictive_regrid = false;
+
+    /** @brief Factor by which the measured front velocity is overestimated.
+     */
+    double predictive_regrid_safety = 2.;
+
+    /** @brief Maximum delay of a regrid in units of the regular regrid
+     *         interval.
+     */
+    double predictive_regrid_max_delay = 4.;
+
+    /** @brief Most recent distance measurement on each level.
+     */
+    std::vector<FrontSample> front;
+
+    /** @brief Measured velocity in cells per unit time by which tagged cells
+     *         approach the coarse/fine boundary on each level. Negative if
+     *         unknown.
+     */
+    std::vector<double> front_velocity;
+
+    /** @brief Latest time by which each level is predicted to need a regrid.
+     *         -DBL_MAX if unknown.
+     */
+    std::vector<double> predicted_time;
 };
 
 }; // namespace sledgehamr
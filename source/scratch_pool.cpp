@@ -0,0 +1,72 @@
+#include "scratch_pool.h"
+#include "sledgehamr.h"
+
+namespace sledgehamr {
+
+/** @brief Hands out a MultiFab with the requested layout. Recycles an idle
+ *         one if available and allocates a new one otherwise. The content of
+ *         the MultiFab is undefined.
+ * @param   ba      BoxArray.
+ * @param   dm      DistributionMapping.
+ * @param   ncomp   Number of components.
+ * @param   nghost  Number of ghost cells.
+ * @param   lev     Level the MultiFab belongs to.
+ * @return  MultiFab. Should be returned with ScratchPool::Release.
+ */
+std::unique_ptr<RhsMultiFab>
+ScratchPool::Get(const amrex::BoxArray &ba,
+                 const amrex::DistributionMapping &dm, const int ncomp,
+                 const int nghost, const int lev) {
+    if (static_cast<int>(pool.size()) < lev + 2)
+        pool.resize(lev + 2);
+
+    std::vector<std::unique_ptr<RhsMultiFab>> &p = pool[lev + 1];
+    for (auto it = p.begin(); it != p.end(); ++it) {
+        RhsMultiFab &mf = **it;
+        if (mf.nComp() == ncomp && mf.nGrow() == nghost &&
+            mf.boxArray() == ba && mf.DistributionMap() == dm) {
+            std::unique_ptr<RhsMultiFab> ret = std::move(*it);
+            p.erase(it);
+            sim->performance_monitor->Count(
+                sim->performance_monitor->idx_scratch_pool_hits, 1, lev);
+            return ret;
+        }
+    }
+
+    std::unique_ptr<RhsMultiFab> ret =
+        std::make_unique<RhsMultiFab>(ba, dm, ncomp, nghost);
+    current_bytes += Bytes(*ret);
+    sim->performance_monitor->Count(
+        sim->performance_monitor->idx_scratch_pool_misses, 1, lev);
+    sim->performance_monitor->Count(
+        sim->performance_monitor->idx_scratch_pool_bytes, current_bytes);
+    return ret;
+}
+
+/** @brief Returns a MultiFab to the pool such that it can be reused.
+ * @param   mf  MultiFab. Does not need to originate from ScratchPool::Get but
+ *              it has to be defined on level lev.
+ * @param   lev Level the MultiFab belongs to.
+ */
+void ScratchPool::Release(std::unique_ptr<RhsMultiFab> mf, const int lev) {
+    if (static_cast<int>(pool.size()) < lev + 2)
+        pool.resize(lev + 2);
+
+    pool[lev + 1].push_back(std::move(mf));
+}
+
+/** @brief Frees all idle MultiFabs of a level. Needs to be called whenever
+ *         the layout of a level changes.
+ * @param   lev Level.
+ */
+void ScratchPool::Invalidate(const int lev) {
+    if (static_cast<int>(pool.size()) < lev + 2)
+        return;
+
+    for (std::unique_ptr<RhsMultiFab> &mf : pool[lev + 1])
+        current_bytes -= Bytes(*mf);
+
+    pool[lev + 1].clear();
+}
+
+}; // namespace sledgehamr
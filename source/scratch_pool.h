@@ -0,0 +1,64 @@
+#ifndef SLEDGEHAMR_SCRATCH_POOL_H_
+#define SLEDGEHAMR_SCRATCH_POOL_H_
+
+#include <AMReX_MultiFab.H>
+
+#include "level_data.h"
+
+namespace sledgehamr {
+
+class Sledgehamr;
+
+/** @brief Pool of temporary MultiFabs. Temporaries requested during a time
+ *         step, e.g. by the integrators or the level synchronizer, are handed
+ *         out from and returned to this pool such that they can be recycled
+ *         across time steps instead of being allocated every time. A pooled
+ *         MultiFab is only reused for requests with the same BoxArray,
+ *         DistributionMapping, number of components and ghost cells. The pool
+ *         of a level has to be invalidated whenever its layout changes.
+ */
+class ScratchPool {
+  public:
+    ScratchPool(Sledgehamr *owner) : sim(owner){};
+
+    std::unique_ptr<RhsMultiFab> Get(const amrex::BoxArray &ba,
+                                     const amrex::DistributionMapping &dm,
+                                     const int ncomp, const int nghost,
+                                     const int lev);
+    void Release(std::unique_ptr<RhsMultiFab> mf, const int lev);
+    void Invalidate(const int lev);
+
+    /** @brief Computes the local memory footprint of a FabArray.
+     * @param   mf  FabArray.
+     * @return  Bytes owned by this rank.
+     */
+    template <class FAB>
+    static double Bytes(const amrex::FabArray<FAB> &mf) {
+        double bytes = 0;
+        for (amrex::MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            bytes += mfi.fabbox().numPts() * mf.nComp() *
+                     sizeof(typename FAB::value_type);
+        }
+
+        return bytes;
+    }
+
+  private:
+    /** @brief Idle MultiFabs per level, pool[lev+1] to include the shadow
+     *         level.
+     */
+    std::vector<std::vector<std::unique_ptr<RhsMultiFab>>> pool;
+
+    /** @brief Bytes currently allocated through the pool on this rank,
+     *         including MultiFabs that are handed out.
+     */
+    double current_bytes = 0;
+
+    /** @brief Pointer to the simulation.
+     */
+    Sledgehamr *sim;
+};
+
+}; // namespace sledgehamr
+
+#endif // SLEDGEHAMR_SCRATCH_POOL_H_
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <random>
+
+#include <AMReX_FArrayBox.H>
+#include <AMReX_Loop.H>
+
+#include "simd_kernels.h"
+#include "sledgehamr_utils.h"
+
+namespace sledgehamr {
+namespace kernels {
+namespace simd {
+
+/** @brief Compares the vectorized kernels against utils::Laplacian<2> and
+ *         kernels::KreissOligerDissipation on a box filled with random
+ *         numbers. Box position, extent and data are drawn from a fixed seed
+ *         such that the check is reproducible. The extent is chosen such that
+ *         both full vectors and scalar remainders are exercised.
+ * @return Largest relative deviation found.
+ */
+double Verify() {
+#ifdef AMREX_USE_FLOAT
+    return 0.;
+#else
+    std::mt19937 rng(20241016);
+    std::uniform_int_distribution<int> lo_dist(-8, 8);
+    std::uniform_int_distribution<int> len_dist(Vector::width + 1, 21);
+    std::uniform_real_distribution<double> val_dist(-1., 1.);
+
+    amrex::IntVect lo, hi;
+    for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+        lo[d] = lo_dist(rng);
+        hi[d] = lo[d] + len_dist(rng) - 1;
+    }
+    const amrex::Box bx(lo, hi);
+
+    constexpr int ncomp = 3;
+    const double dx = 0.37;
+    const double dx2 = dx * dx;
+    const double strength[ncomp] = {0.3, 1., 2.5};
+
+    amrex::FArrayBox state_fab(amrex::grow(bx, 3), ncomp,
+                               amrex::The_Cpu_Arena());
+    amrex::FArrayBox lap_fab(bx, ncomp, amrex::The_Cpu_Arena());
+    amrex::FArrayBox rhs_fab(bx, ncomp, amrex::The_Cpu_Arena());
+
+    double* p = state_fab.dataPtr();
+    for (amrex::Long m = 0; m < state_fab.size(); ++m)
+        p[m] = val_dist(rng);
+
+    const amrex::Array4<double const>& state = state_fab.const_array();
+    const amrex::Array4<double>& lap = lap_fab.array();
+    const amrex::Array4<double>& rhs = rhs_fab.array();
+
+    // Data is of order unity, so the stencils are bounded by these scales.
+    double max_dev = 0.;
+    Laplacian2(bx, lap, 0, state, 0, ncomp, dx2);
+    amrex::LoopOnCpu(bx, ncomp, [&](int i, int j, int k, int n) {
+        const double ref = utils::Laplacian<2>(state, i, j, k, n, dx2);
+        max_dev = std::max(max_dev, std::abs(lap(i, j, k, n) - ref) * dx2);
+    });
+
+    for (int order : {2, 3}) {
+        rhs_fab.setVal<amrex::RunOn::Cpu>(0.);
+        if (order == 2) {
+            AddKreissOligerDissipation<2>(bx, rhs, state, ncomp, dx,
+                                          strength);
+        } else {
+            AddKreissOligerDissipation<3>(bx, rhs, state, ncomp, dx,
+                                          strength);
+        }
+
+        amrex::LoopOnCpu(bx, ncomp, [&](int i, int j, int k, int n) {
+            const double ref = order == 2
+                ? kernels::KreissOligerDissipation<2>(state, i, j, k, n, dx,
+                                                      strength[n])
+                : kernels::KreissOligerDissipation<3>(state, i, j, k, n, dx,
+                                                      strength[n]);
+            max_dev = std::max(max_dev, std::abs(rhs(i, j, k, n) - ref)
+                                        * dx / strength[n]);
+        });
+    }
+
+    return max_dev;
+#endif
+}
+
+}; // namespace simd
+}; // namespace kernels
+}; // namespace sledgehamr
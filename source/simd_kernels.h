@@ -0,0 +1,330 @@
+#ifndef SLEDGEHAMR_SIMD_KERNELS_H_
+#define SLEDGEHAMR_SIMD_KERNELS_H_
+
+#include <cmath>
+#include <cstddef>
+
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+
+#if !defined(AMREX_USE_GPU) && (defined(__AVX512F__) || defined(__AVX2__))
+#include <immintrin.h>
+#endif
+
+#include "kernels.h"
+
+namespace sledgehamr {
+namespace kernels {
+namespace simd {
+
+/** @brief Whether the SIMD stencil path is used. Only enabled if no GPU
+ *         backend is used since the kernels operate on host memory, if the
+ *         state is stored in double precision and if AVX2 or AVX-512 is
+ *         available. Otherwise the pointwise kernels are used.
+ */
+#if !defined(AMREX_USE_GPU) && !defined(AMREX_USE_FLOAT) && \
+    (defined(__AVX512F__) || defined(__AVX2__))
+constexpr bool kEnabled = true;
+#else
+constexpr bool kEnabled = false;
+#endif
+
+/** @brief Single double with the same interface as the vector types below.
+ *         Used for remainders and if no vector extension is available.
+ */
+struct ScalarLane {
+    static constexpr int width = 1;
+    double v;
+
+    static ScalarLane Load(const double* p) { return {*p}; }
+    static ScalarLane Set(const double a) { return {a}; }
+    void Store(double* p) const { *p = v; }
+
+    friend ScalarLane operator+(ScalarLane a, ScalarLane b) {
+        return {a.v + b.v};
+    }
+    friend ScalarLane operator-(ScalarLane a, ScalarLane b) {
+        return {a.v - b.v};
+    }
+    friend ScalarLane operator*(ScalarLane a, ScalarLane b) {
+        return {a.v * b.v};
+    }
+    friend ScalarLane operator/(ScalarLane a, ScalarLane b) {
+        return {a.v / b.v};
+    }
+    friend ScalarLane operator-(ScalarLane a) { return {-a.v}; }
+};
+
+#if !defined(AMREX_USE_GPU) && defined(__AVX512F__)
+/** @brief Eight doubles in an AVX-512 register.
+ */
+struct Vector {
+    static constexpr int width = 8;
+    __m512d v;
+
+    static Vector Load(const double* p) { return {_mm512_loadu_pd(p)}; }
+    static Vector Set(const double a) { return {_mm512_set1_pd(a)}; }
+    void Store(double* p) const { _mm512_storeu_pd(p, v); }
+
+    friend Vector operator+(Vector a, Vector b) {
+        return {_mm512_add_pd(a.v, b.v)};
+    }
+    friend Vector operator-(Vector a, Vector b) {
+        return {_mm512_sub_pd(a.v, b.v)};
+    }
+    friend Vector operator*(Vector a, Vector b) {
+        return {_mm512_mul_pd(a.v, b.v)};
+    }
+    friend Vector operator/(Vector a, Vector b) {
+        return {_mm512_div_pd(a.v, b.v)};
+    }
+    friend Vector operator-(Vector a) {
+        return {_mm512_sub_pd(_mm512_setzero_pd(), a.v)};
+    }
+};
+#elif !defined(AMREX_USE_GPU) && defined(__AVX2__)
+/** @brief Four doubles in an AVX2 register.
+ */
+struct Vector {
+    static constexpr int width = 4;
+    __m256d v;
+
+    static Vector Load(const double* p) { return {_mm256_loadu_pd(p)}; }
+    static Vector Set(const double a) { return {_mm256_set1_pd(a)}; }
+    void Store(double* p) const { _mm256_storeu_pd(p, v); }
+
+    friend Vector operator+(Vector a, Vector b) {
+        return {_mm256_add_pd(a.v, b.v)};
+    }
+    friend Vector operator-(Vector a, Vector b) {
+        return {_mm256_sub_pd(a.v, b.v)};
+    }
+    friend Vector operator*(Vector a, Vector b) {
+        return {_mm256_mul_pd(a.v, b.v)};
+    }
+    friend Vector operator/(Vector a, Vector b) {
+        return {_mm256_div_pd(a.v, b.v)};
+    }
+    friend Vector operator-(Vector a) {
+        return {_mm256_sub_pd(_mm256_setzero_pd(), a.v)};
+    }
+};
+#else
+using Vector = ScalarLane;
+#endif
+
+/** @brief Calls f(j, k) for every row of bx along the contiguous
+ *         i-direction. Kernels use this to set up row pointers once per row
+ *         and then sweep all components along the row with RowSweep.
+ * @param   bx  Box to loop over.
+ * @param   f   Function to call.
+ */
+template <class F>
+AMREX_FORCE_INLINE void RowLoop(const amrex::Box& bx, F&& f) {
+    const amrex::Dim3 lo = amrex::lbound(bx);
+    const amrex::Dim3 hi = amrex::ubound(bx);
+
+    for (int k = lo.z; k <= hi.z; ++k) {
+        for (int j = lo.y; j <= hi.y; ++j)
+            f(j, k);
+    }
+}
+
+/** @brief Calls f(V, i) for the offsets i = 0, ..., len-1 along a row, where
+ *         V is the vector type that processes the cells i, ..., i+V::width-1
+ *         at once. The row is split into full vectors and a scalar remainder.
+ * @param   len Length of the row.
+ * @param   f   Function to call.
+ */
+template <class F>
+AMREX_FORCE_INLINE void RowSweep(const int len, F&& f) {
+    int i = 0;
+    for (; i + Vector::width <= len; i += Vector::width)
+        f(Vector{}, i);
+    for (; i < len; ++i)
+        f(ScalarLane{}, i);
+}
+
+/** @brief Vectorized version of utils::Laplacian<2> for V::width consecutive
+ *         cells. Performs the same operations in the same order.
+ * @param   c   Pointer to the first center cell.
+ * @param   sj  Stride in j-direction.
+ * @param   sk  Stride in k-direction.
+ * @param   dx2 Squared grid spacing.
+ * @return Laplacian.
+ */
+template <class V>
+AMREX_FORCE_INLINE V Laplacian2(const double* c, const std::ptrdiff_t sj,
+                                const std::ptrdiff_t sk, const double dx2) {
+    const V far = V::Load(c + 2) + V::Load(c - 2)
+                + V::Load(c + 2*sj) + V::Load(c - 2*sj)
+                + V::Load(c + 2*sk) + V::Load(c - 2*sk);
+    const V near = V::Load(c + 1) + V::Load(c - 1)
+                 + V::Load(c + sj) + V::Load(c - sj)
+                 + V::Load(c + sk) + V::Load(c - sk);
+    return (-far + V::Set(16.) * near - V::Set(90.) * V::Load(c))
+           / (V::Set(12.) * V::Set(dx2));
+}
+
+/** @brief Vectorized version of kernels::KreissOligerDissipation<order> for
+ *         V::width consecutive cells. Performs the same operations in the same
+ *         order. Only order 2 and 3 are implemented.
+ * @param   c                       Pointer to the first center cell.
+ * @param   sj                      Stride in j-direction.
+ * @param   sk                      Stride in k-direction.
+ * @param   dx                      Grid spacing.
+ * @param   dissipation_strength    Dissipation strength.
+ * @return Dissipation value.
+ */
+template <int order, class V>
+AMREX_FORCE_INLINE V KreissOligerDissipation(
+        const double* c, const std::ptrdiff_t sj, const std::ptrdiff_t sk,
+        const double dx, const double dissipation_strength) {
+    static_assert(order == 2 || order == 3,
+                  "Only 2nd and 3rd order dissipation is implemented.");
+    const V s0 = V::Load(c);
+    V d = V::Set(0.);
+
+    for (const std::ptrdiff_t s : {std::ptrdiff_t(1), sj, sk}) {
+        if constexpr (order == 2) {
+            d = d + (V::Load(c + 2*s) - V::Set(4.) * V::Load(c + s)
+                   + V::Load(c - 2*s) - V::Set(4.) * V::Load(c - s)
+                   + V::Set(6.) * s0);
+        } else {
+            d = d + (V::Load(c + 3*s) - V::Set(6.) * V::Load(c + 2*s)
+                   + V::Set(15.) * V::Load(c + s)
+                   + V::Load(c - 3*s) - V::Set(6.) * V::Load(c - 2*s)
+                   + V::Set(15.) * V::Load(c - s)
+                   - V::Set(20.) * s0);
+        }
+    }
+
+    if constexpr (order == 2) {
+        return -V::Set(dissipation_strength) * d / V::Set(16.) / V::Set(dx);
+    } else {
+        return V::Set(dissipation_strength) * d / V::Set(64.) / V::Set(dx);
+    }
+}
+
+/** @brief Computes the 2nd order Laplacian of several components on a box
+ *         using the vectorized stencil. Useful for projects that want to
+ *         evaluate Laplacians for an entire tile before computing the Rhs.
+ *         Row pointers are set up once per row and shared by all
+ *         components, which are then swept along the row one after another
+ *         while the neighbouring rows are still in cache.
+ * @param   bx      Box on which the Laplacian is computed.
+ * @param   lap     Container to store the Laplacian in.
+ * @param   dcomp   First component of lap to be filled.
+ * @param   state   Data from which Laplacian is to be calculated. Needs to be
+ *                  valid on bx grown by 2 cells.
+ * @param   scomp   First component of state.
+ * @param   ncomp   Number of components.
+ * @param   dx2     Squared grid spacing.
+ */
+inline void Laplacian2(const amrex::Box& bx, const amrex::Array4<double>& lap,
+                       const int dcomp,
+                       const amrex::Array4<double const>& state,
+                       const int scomp, const int ncomp, const double dx2) {
+    const std::ptrdiff_t sj = state.jstride;
+    const std::ptrdiff_t sk = state.kstride;
+    const std::ptrdiff_t sn = state.nstride;
+    const std::ptrdiff_t ln = lap.nstride;
+    const int len = bx.length(0);
+    const int ilo = bx.smallEnd(0);
+
+    RowLoop(bx, [&](int j, int k) {
+        const double* s = state.ptr(ilo, j, k, scomp);
+        double* l = lap.ptr(ilo, j, k, dcomp);
+        for (int n = 0; n < ncomp; ++n, s += sn, l += ln) {
+            RowSweep(len, [&](auto v, int i) {
+                using V = decltype(v);
+                Laplacian2<V>(s + i, sj, sk, dx2).Store(l + i);
+            });
+        }
+    });
+}
+
+/** @brief Adds Kreiss-Oliger dissipation of the first ncomp components to the
+ *         Rhs on a box using the vectorized stencil. Row pointers are set up
+ *         once per row and shared by all components, which are then swept
+ *         along the row one after another while the neighbouring rows are
+ *         still in cache. kernels::simd::Verify compares the result against
+ *         kernels::KreissOligerDissipation.
+ * @param   bx                      Box on which dissipation is added.
+ * @param   rhs                     Rhs to add dissipation to.
+ * @param   state                   Current field state. Needs to be valid on
+ *                                  bx grown by order cells.
+ * @param   ncomp                   Number of components.
+ * @param   dx                      Grid spacing.
+ * @param   dissipation_strength    Dissipation strength of each component.
+ */
+template <int order>
+void AddKreissOligerDissipation(const amrex::Box& bx,
+                                const amrex::Array4<double>& rhs,
+                                const amrex::Array4<double const>& state,
+                                const int ncomp, const double dx,
+                                const double* dissipation_strength) {
+    const std::ptrdiff_t sj = state.jstride;
+    const std::ptrdiff_t sk = state.kstride;
+    const std::ptrdiff_t sn = state.nstride;
+    const std::ptrdiff_t rn = rhs.nstride;
+    const int len = bx.length(0);
+    const int ilo = bx.smallEnd(0);
+
+    RowLoop(bx, [&](int j, int k) {
+        const double* s = state.ptr(ilo, j, k, 0);
+        double* r = rhs.ptr(ilo, j, k, 0);
+        for (int n = 0; n < ncomp; ++n, s += sn, r += rn) {
+            const double strength = dissipation_strength[n];
+            RowSweep(len, [&](auto v, int i) {
+                using V = decltype(v);
+                const V ko = KreissOligerDissipation<order, V>(
+                    s + i, sj, sk, dx, strength);
+                (V::Load(r + i) + ko).Store(r + i);
+            });
+        }
+    });
+}
+
+/** @brief Runtime dispatch of AddKreissOligerDissipation for all boxes in a
+ *         box list. Does nothing for unsupported orders or single precision.
+ * @param   bxs                     Boxes on which dissipation is added.
+ * @param   rhs                     Rhs to add dissipation to.
+ * @param   state                   Current field state.
+ * @param   ncomp                   Number of components.
+ * @param   dx                      Grid spacing.
+ * @param   order                   Order of dissipation.
+ * @param   dissipation_strength    Dissipation strength of each component.
+ */
+inline void AddKreissOligerDissipation(
+        const amrex::BoxList& bxs, const amrex::Array4<double>& rhs,
+        const amrex::Array4<amrex::Real const>& state, const int ncomp,
+        const double dx, const int order, const double* dissipation_strength) {
+#ifndef AMREX_USE_FLOAT
+    for (const amrex::Box& bx : bxs) {
+        switch (order) {
+            case 2:
+                AddKreissOligerDissipation<2>(bx, rhs, state, ncomp, dx,
+                                              dissipation_strength);
+                break;
+            case 3:
+                AddKreissOligerDissipation<3>(bx, rhs, state, ncomp, dx,
+                                              dissipation_strength);
+                break;
+        }
+    }
+#endif
+}
+
+/** @brief Compares the vectorized kernels against utils::Laplacian<2> and
+ *         kernels::KreissOligerDissipation on a box filled with random
+ *         numbers.
+ * @return Largest relative deviation found.
+ */
+double Verify();
+
+}; // namespace simd
+}; // namespace kernels
+}; // namespace sledgehamr
+
+#endif // SLEDGEHAMR_SIMD_KERNELS_H_
@@ -3,6 +3,7 @@
 #include <AMReX_MultiFabUtil.H>
 #include <AMReX_ParmParse.H>
 
+#include "fft.h"
 #include "fill_level.h"
 #include "hdf5_utils.h"
 #include "sledgehamr.h"
@@ -20,6 +21,13 @@ Sledgehamr::Sledgehamr() {
     // Initialize modules.
     time_stepper = std::make_unique<TimeStepper>(this);
     io_module = std::make_unique<IOModule>(this);
+    scratch_pool = std::make_unique<ScratchPool>(this);
+    load_balancer = std::make_unique<LoadBalancer>(this);
+    incremental_tagging = std::make_unique<IncrementalTagging>(this);
+    clustering = std::make_unique<MortonClustering>(this);
+    regrid_recorder = std::make_unique<RegridRecorder>(this);
+    spectrum_bins = std::make_unique<SpectrumBins>(
+        this, "output.spectra", SpectrumBinScheme::ShellBins);
 
     grid_new.resize(max_level + 1);
     grid_old.resize(max_level + 1);
@@ -30,6 +38,9 @@ Sledgehamr::Sledgehamr() {
         dt.push_back(dx[lev] * cfl);
     }
 
+    // Regrid times are matched up to a fraction of the finest time step.
+    time_stepper->scheduler->SetTolerance(1e-3 * dt[max_level]);
+
     DoPrerunChecks();
 }
 
@@ -45,6 +56,7 @@ void Sledgehamr::InitSledgehamr() {
     // can initialize boundary conditions.
     level_synchronizer = std::make_unique<LevelSynchronizer>(this);
     performance_monitor = std::make_unique<PerformanceMonitor>(this);
+    autotuner = std::make_unique<Autotuner>(this);
 
     ParseInputScalars();
 
@@ -57,6 +69,12 @@ void Sledgehamr::InitSledgehamr() {
         return;
     }
 
+    if (regrid_recorder->replaying) {
+        time_stepper->local_regrid->Replay();
+        no_simulation = true;
+        return;
+    }
+
     performance_monitor->Start(performance_monitor->idx_read_input);
 
     if (restart_sim) {
@@ -68,12 +86,16 @@ void Sledgehamr::InitSledgehamr() {
     if (increase_coarse_level_resolution)
         level_synchronizer->IncreaseCoarseLevelResolution();
 
+    // The initial layout has been created with the first autotuner candidate.
+    autotuner->DidGlobalRegrid(0, finest_level);
+
     performance_monitor->Stop(performance_monitor->idx_read_input);
 
     // Initialize project
     Init();
 
     io_module->UpdateOutputModules();
+    io_module->BuildSpectrumBins();
 }
 
 /** @brief Starts the evolution
@@ -127,8 +149,8 @@ void Sledgehamr::MakeNewLevelFromScratch(int lev, amrex::Real time,
     const int ncomp = scalar_fields.size();
 
     // Define lowest level from scratch.
-    grid_new[lev].define(ba, dm, ncomp, nghost, time);
-    grid_old[lev].define(ba, dm, ncomp, nghost);
+    grid_new[lev].define(ba, dm, ncomp, NGhost(lev), time);
+    grid_old[lev].define(ba, dm, ncomp, NGhost(lev));
 
     SetBoxArray(lev, ba);
     SetDistributionMap(lev, dm);
@@ -150,16 +172,19 @@ void Sledgehamr::MakeNewLevelFromCoarse(int lev, amrex::Real time,
                                         const amrex::BoxArray &ba,
                                         const amrex::DistributionMapping &dm) {
     const int ncomp = grid_new[lev - 1].nComp();
-    const int nghost = grid_new[lev - 1].nGrow();
+    const int nghost = NGhost(lev);
 
-    grid_new[lev].define(ba, dm, ncomp, nghost, time);
+    // time is an amrex::Real and therefore rounded in single precision
+    // builds. Take the exact time from the coarse level instead.
+    const double t = grid_new[lev - 1].t;
+    grid_new[lev].define(ba, dm, ncomp, nghost, t);
     grid_old[lev].define(ba, dm, ncomp, nghost);
 
     SetBoxArray(lev, ba);
     SetDistributionMap(lev, dm);
 
     // Fill new level with coarse level data.
-    level_synchronizer->FillCoarsePatch(lev, time, grid_new[lev]);
+    level_synchronizer->FillCoarsePatch(lev, t, grid_new[lev]);
 }
 
 /** @brief Remake a new level using provided BoxArray and
@@ -176,6 +201,13 @@ void Sledgehamr::RemakeLevel(int lev, amrex::Real time,
     const int ncomp = grid_new[lev].nComp();
     const int nghost = grid_new[lev].nGrow();
 
+    // Temporaries of this level (and of the shadow level if lev == 0) no
+    // longer match the new layout.
+    scratch_pool->Invalidate(lev);
+    if (lev == 0)
+        scratch_pool->Invalidate(-1);
+    utils::FftContext::Release();
+
     // Remake new_grid and fill with data.
     LevelData new_state(ba, dm, ncomp, nghost, grid_new[lev].t);
     new_state.istep = grid_new[lev].istep;
@@ -193,10 +225,99 @@ void Sledgehamr::RemakeLevel(int lev, amrex::Real time,
  * @param   lev Level to be deleted.
  */
 void Sledgehamr::ClearLevel(int lev) {
+    scratch_pool->Invalidate(lev);
+    utils::FftContext::Release();
+    level_synchronizer->ClearGhostCache(lev);
+    incremental_tagging->Invalidate(lev);
     grid_new[lev].clear();
     grid_old[lev].clear();
 }
 
+/** @brief Creates the DistributionMapping of a new BoxArray using the load
+ *         balancer. Overrides the virtual function in amrex::AmrMesh.
+ * @param   lev Level.
+ * @param   ba  New amrex::BoxArray.
+ * @return  New amrex::DistributionMapping.
+ */
+amrex::DistributionMapping
+Sledgehamr::MakeDistributionMap(int lev, const amrex::BoxArray &ba) {
+    return load_balancer->MakeDistributionMap(lev, ba);
+}
+
+/** @brief Performs a global regrid of all levels above lbase. Same as
+ *         amrex::AmrCore::regrid, which it overrides, except that the new
+ *         grids are computed with the selected clustering algorithm. The
+ *         non-virtual amrex::AmrMesh::MakeNewGrids cannot be overridden for
+ *         this purpose.
+ * @param   lbase   Coarsest level that will not be changed.
+ * @param   time    Current time.
+ * @param   initial Unused, see amrex::AmrCore::regrid.
+ */
+void Sledgehamr::regrid(int lbase, amrex::Real time, bool initial) {
+    if (lbase >= max_level)
+        return;
+
+    int new_finest;
+    amrex::Vector<amrex::BoxArray> new_grids(finest_level + 2);
+    ClusterNewGrids(lbase, time, new_finest, new_grids);
+
+    bool coarse_ba_changed = false;
+    for (int lev = lbase + 1; lev <= new_finest; ++lev) {
+        if (lev <= finest_level) {
+            const bool ba_changed = (new_grids[lev] != grids[lev]);
+            if (ba_changed || coarse_ba_changed) {
+                amrex::BoxArray level_grids = grids[lev];
+                amrex::DistributionMapping level_dmap = dmap[lev];
+                if (ba_changed) {
+                    level_grids = new_grids[lev];
+                    level_dmap = MakeDistributionMap(lev, level_grids);
+                }
+                RemakeLevel(lev, time, level_grids, level_dmap);
+                SetBoxArray(lev, level_grids);
+                SetDistributionMap(lev, level_dmap);
+            }
+            coarse_ba_changed = ba_changed;
+        } else {
+            amrex::DistributionMapping new_dmap =
+                MakeDistributionMap(lev, new_grids[lev]);
+            MakeNewLevelFromCoarse(lev, time, new_grids[lev], new_dmap);
+        }
+    }
+
+    for (int lev = new_finest + 1; lev <= finest_level; ++lev) {
+        ClearLevel(lev);
+        ClearBoxArray(lev);
+        ClearDistributionMap(lev);
+    }
+
+    finest_level = new_finest;
+    autotuner->DidGlobalRegrid(lbase, finest_level);
+}
+
+/** @brief Computes the grids of a global regrid using the clustering algorithm
+ *         selected by amr.clustering.
+ * @param   lbase       Coarsest level that will not be changed.
+ * @param   time        Current time.
+ * @param   new_finest  New finest level.
+ * @param   new_grids   New BoxArrays of all levels above lbase.
+ */
+void Sledgehamr::ClusterNewGrids(int lbase, amrex::Real time, int &new_finest,
+                                 amrex::Vector<amrex::BoxArray> &new_grids) {
+    performance_monitor->Start(performance_monitor->idx_clustering, lbase);
+
+    if (clustering->algorithm == ClusteringAlgorithm::Morton)
+        clustering->MakeNewGrids(lbase, time, new_finest, new_grids);
+    else
+        amrex::AmrMesh::MakeNewGrids(lbase, time, new_finest, new_grids);
+
+    performance_monitor->Stop(performance_monitor->idx_clustering, lbase);
+
+    for (int lev = lbase + 1; lev <= new_finest; ++lev) {
+        performance_monitor->Count(performance_monitor->idx_clustering_boxes,
+                                   new_grids[lev].size(), lev);
+    }
+}
+
 /** @brief Tag cells for refinement. Overrides the pure virtual function in
  *         amrex::AmrCore.
  * @param   lev         Level on which cells are tagged.
@@ -250,12 +371,117 @@ void Sledgehamr::CreateShadowLevel() {
     time_stepper->integrator->Advance(-1);
 }
 
+/** @brief Sets up the Rhs meta data of a level at a given time such that it
+ *         can be shared by all tiles of a temporally blocked integrator.
+ * @param   params  Meta data to be set up.
+ * @param   time    Time at which the Rhs is evaluated.
+ * @param   lev     Current level.
+ */
+void Sledgehamr::SetUpRhsBoxParams(RhsBoxParams &params, const double time,
+                                   const int lev) {
+    params.time = time;
+
+    std::vector<double> tmp;
+    SetParamsRhs(tmp, time, lev);
+    params.params_rhs.resize(tmp.size());
+    amrex::Gpu::copy(amrex::Gpu::hostToDevice, tmp.begin(), tmp.end(),
+                     params.params_rhs.begin());
+
+    tmp.clear();
+    if (with_gravitational_waves)
+        SetParamsGravitationalWaveRhs(tmp, time, lev);
+    params.params_gw_rhs.resize(tmp.size());
+    amrex::Gpu::copy(amrex::Gpu::hostToDevice, tmp.begin(), tmp.end(),
+                     params.params_gw_rhs.begin());
+
+    params.dissipation_strength.resize(dissipation_strength.size());
+    amrex::Gpu::copy(amrex::Gpu::hostToDevice, dissipation_strength.begin(),
+                     dissipation_strength.end(),
+                     params.dissipation_strength.begin());
+}
+
 /** @brief Checks whether we want to save the coarse level box layout for
- *         chunking of the initial state.
+ *         chunking of the initial state or run any of the self-checks.
  */
 void Sledgehamr::DoPrerunChecks() {
     if (get_box_layout_nodes > 0)
         DetermineBoxLayout();
+
+    if (check_simd_kernels)
+        CheckSimdKernels();
+
+    if (check_box_wrapping)
+        CheckBoxWrapping();
+
+    if (check_gw_projection)
+        CheckGwProjection();
+
+    if (benchmark_fft_cache > 0)
+        BenchmarkFftCache();
+}
+
+/** @brief Compares the vectorized stencils against the pointwise kernels and
+ *         exits. Aborts if they deviate by more than round-off.
+ */
+void Sledgehamr::CheckSimdKernels() {
+    const double deviation = kernels::simd::Verify();
+    amrex::Print() << "SIMD stencils (width " << kernels::simd::Vector::width
+                   << ", enabled " << kernels::simd::kEnabled
+                   << "): max. relative deviation " << deviation << std::endl;
+
+    if (deviation > 1e-12)
+        amrex::Abort("#error: SIMD stencils deviate from pointwise kernels.");
+
+    no_simulation = true;
+}
+
+/** @brief Tests wrapping boxes across periodic boundaries and exits. Aborts
+ *         if any of the tests fails.
+ */
+void Sledgehamr::CheckBoxWrapping() {
+    amrex::Print() << "Checking periodic box wrapping ..." << std::endl;
+
+    if (!LocalRegrid::CheckWrapBoxArray())
+        amrex::Abort("#error: Wrapping boxes across periodic boundaries "
+                     "failed.");
+
+    no_simulation = true;
+}
+
+/** @brief Compares the gravitational wave projection against the explicit sum
+ *         over the TT-projector, prints timings of both and exits. Aborts if
+ *         they deviate by more than round-off.
+ */
+void Sledgehamr::CheckGwProjection() {
+    if (GravitationalWaves::CheckProjection() > 1e-12)
+        amrex::Abort("#error: Gravitational wave projection deviates from "
+                     "the explicit sum.");
+
+    no_simulation = true;
+}
+
+/** @brief Times FFTs of a coarse level field with and without cached FFT
+ *         contexts and exits. Uses a single component as for spectra and a
+ *         batch of six as for gravitational waves.
+ */
+void Sledgehamr::BenchmarkFftCache() {
+    amrex::Box bx(amrex::IntVect(0),
+                  amrex::IntVect(coarse_level_grid_size - 1));
+    amrex::BoxArray ba(bx);
+    ChopGrids(0, ba, amrex::ParallelDescriptor::NProcs());
+    amrex::DistributionMapping dm(ba, amrex::ParallelDescriptor::NProcs());
+
+    const int ncomp = 6;
+    amrex::MultiFab field(ba, dm, ncomp, 0);
+    field.setVal(1.0);
+
+    const int comps[ncomp] = {0, 1, 2, 3, 4, 5};
+    utils::BenchmarkFftCache(field, comps, 1, geom[0], 1,
+                             benchmark_fft_cache);
+    utils::BenchmarkFftCache(field, comps, ncomp, geom[0], 1,
+                             benchmark_fft_cache);
+
+    no_simulation = true;
 }
 
 /** @brief Saves the coarse level box layout.
@@ -294,30 +520,27 @@ void Sledgehamr::DoErrorEstCpu(int lev, amrex::TagBoxArray &tags, double time) {
     if (shadow_hierarchy)
         SetParamsTruncationModifier(params_mod, time, lev);
 
-        // Loop over boxes and cells.
-#pragma omp parallel reduction(+ : ntags_total) reduction(+ : ntags_user)      \
-    reduction(vec_long_plus : ntags_trunc)
-    for (amrex::MFIter mfi(state, true); mfi.isValid(); ++mfi) {
-        const amrex::Box &tilebox = mfi.tilebox();
-        const amrex::Array4<double const> &state_fab = state.array(mfi);
-        const amrex::Array4<double const> &state_fab_te = state_te.array(mfi);
-        const amrex::Array4<char> &tag_arr = tags.array(mfi);
+    // Truncation error tags may have been computed while averaging down.
+    const bool fused = shadow_hierarchy && state_te.truncation_tags;
+    if (fused)
+        ntags_trunc = state_te.ntruncation_tags;
 
-        // Tag with or without truncation errors.
-        if (shadow_hierarchy && state_te.contains_truncation_errors) {
-            TagWithTruncationCpu(state_fab, state_fab_te, tag_arr, tilebox,
-                                 time, lev, &ntags_total, &ntags_user,
-                                 &(ntags_trunc[0]), params_tag, params_mod);
-        } else if (shadow_hierarchy) {
-            std::string msg = "Trying to tag using truncation errors but no ";
-            msg += "truncation errors are computed on level ";
-            msg += std::to_string(lev) + "!";
-            amrex::Abort(msg.c_str());
-        } else {
-            TagWithoutTruncationCpu(state_fab, tag_arr, tilebox, time, lev,
-                                    &ntags_total, params_tag);
-        }
-    }
+    // Tiles far away from previous tags are known to remain untagged.
+    const bool incremental =
+        incremental_tagging->Begin(lev, time, state.boxArray());
+    long ncells_skipped = 0;
+
+    TagTilesCpu(lev, tags, time, incremental, fused, params_tag, params_mod,
+                ntags_total, ntags_user, ntags_trunc, ncells_skipped);
+
+    incremental_tagging->Finish(lev, time, state, tags, incremental,
+                                ncells_skipped);
+
+    if (incremental && incremental_tagging->check)
+        CheckIncrementalTags(lev, tags, time, fused, params_tag, params_mod);
+
+    if (fused)
+        ntags_total += ntags_user;
 
     // Collect all tags across MPI ranks.
     amrex::ParallelDescriptor::ReduceLongSum(ntags_total, 0);
@@ -347,6 +570,178 @@ void Sledgehamr::DoErrorEstCpu(int lev, amrex::TagBoxArray &tags, double time) {
     }
 }
 
+/** @brief Evaluates the tagging criteria on all tiles of a level on CPUs.
+ * @param   lev             Tagging level.
+ * @param   tags            Container to save tags.
+ * @param   time            Current time.
+ * @param   incremental     Whether tiles far from previous tags are skipped.
+ * @param   fused           Whether truncation error tags have been computed
+ *                          while averaging down.
+ * @param   params_tag      Parameters of the user-defined tagging criteria.
+ * @param   params_mod      Parameters of the truncation error modifiers.
+ * @param   ntags_total     Adds number of tagged cells.
+ * @param   ntags_user      Adds number of user-defined tags.
+ * @param   ntags_trunc     Adds number of truncation error tags per field.
+ * @param   ncells_skipped  Adds number of cells that have been skipped.
+ */
+void Sledgehamr::TagTilesCpu(const int lev, amrex::TagBoxArray &tags,
+                             const double time, const bool incremental,
+                             const bool fused,
+                             const std::vector<double> &params_tag,
+                             const std::vector<double> &params_mod,
+                             long &ntags_total, long &ntags_user,
+                             std::vector<long> &ntags_trunc,
+                             long &ncells_skipped) {
+    const amrex::MultiFab &state = grid_new[lev];
+    const LevelData &state_te = grid_old[lev];
+
+    long l_ntags_total = 0;
+    long l_ntags_user = 0;
+    std::vector<long> l_ntags_trunc(ntags_trunc.size(), 0);
+    long l_ncells_skipped = 0;
+
+#pragma omp parallel reduction(+ : l_ntags_total) reduction(+ : l_ntags_user) \
+    reduction(vec_long_plus : l_ntags_trunc)                                   \
+    reduction(+ : l_ncells_skipped)
+    for (amrex::MFIter mfi(state, true); mfi.isValid(); ++mfi) {
+        const amrex::Box &tilebox = mfi.tilebox();
+        const amrex::Array4<char> &tag_arr = tags.array(mfi);
+        if (incremental && !incremental_tagging->NeedsTagging(lev, tilebox)) {
+            // Only user-defined tags are skipped. Fused truncation error tags
+            // are counted in ntags_trunc already and cheap to apply.
+            if (fused) {
+                AddTruncationErrorTagsCpu(
+                    state_te.truncation_tags->const_array(mfi), tag_arr,
+                    tilebox, &l_ntags_total);
+            }
+            l_ncells_skipped += tilebox.numPts();
+            continue;
+        }
+
+        const amrex::Array4<amrex::Real const> &state_fab = state.array(mfi);
+
+        // Tag with or without truncation errors.
+        if (fused) {
+            TagWithoutTruncationCpu(state_fab, tag_arr, tilebox, time, lev,
+                                    &l_ntags_user, params_tag);
+            AddTruncationErrorTagsCpu(
+                state_te.truncation_tags->const_array(mfi), tag_arr, tilebox,
+                &l_ntags_total);
+        } else if (shadow_hierarchy && state_te.contains_truncation_errors) {
+            const amrex::Array4<amrex::Real const> &state_fab_te =
+                state_te.array(mfi);
+            TagWithTruncationCpu(state_fab, state_fab_te, tag_arr, tilebox,
+                                 time, lev, &l_ntags_total, &l_ntags_user,
+                                 &(l_ntags_trunc[0]), params_tag, params_mod);
+        } else if (shadow_hierarchy) {
+            std::string msg = "Trying to tag using truncation errors but no ";
+            msg += "truncation errors are computed on level ";
+            msg += std::to_string(lev) + "!";
+            amrex::Abort(msg.c_str());
+        } else {
+            TagWithoutTruncationCpu(state_fab, tag_arr, tilebox, time, lev,
+                                    &l_ntags_total, params_tag);
+        }
+    }
+
+    ntags_total += l_ntags_total;
+    ntags_user += l_ntags_user;
+    for (int n = 0; n < ntags_trunc.size(); ++n)
+        ntags_trunc[n] += l_ntags_trunc[n];
+    ncells_skipped += l_ncells_skipped;
+}
+
+/** @brief Repeats an incremental tagging sweep as a full sweep and compares
+ *         the resulting tag sets cell by cell. Aborts if they differ.
+ * @param   lev         Tagging level.
+ * @param   tags        Tags of the incremental sweep.
+ * @param   time        Current time.
+ * @param   fused       Whether truncation error tags have been computed
+ *                      while averaging down.
+ * @param   params_tag  Parameters of the user-defined tagging criteria.
+ * @param   params_mod  Parameters of the truncation error modifiers.
+ */
+void Sledgehamr::CheckIncrementalTags(const int lev,
+                                      const amrex::TagBoxArray &tags,
+                                      const double time, const bool fused,
+                                      const std::vector<double> &params_tag,
+                                      const std::vector<double> &params_mod) {
+    amrex::TagBoxArray full_tags(tags.boxArray(), tags.DistributionMap(),
+                                 tags.nGrow());
+    full_tags.setVal(amrex::TagBox::CLEAR);
+
+    long ntags_total = 0;
+    long ntags_user = 0;
+    std::vector<long> ntags_trunc(scalar_fields.size(), 0);
+    long ncells_skipped = 0;
+    TagTilesCpu(lev, full_tags, time, false, fused, params_tag, params_mod,
+                ntags_total, ntags_user, ntags_trunc, ncells_skipped);
+
+    long nmissed = 0;
+    long nspurious = 0;
+
+#pragma omp parallel reduction(+ : nmissed) reduction(+ : nspurious)
+    for (amrex::MFIter mfi(full_tags, true); mfi.isValid(); ++mfi) {
+        const amrex::Array4<char const> &inc = tags.const_array(mfi);
+        const amrex::Array4<char const> &full = full_tags.const_array(mfi);
+
+        amrex::LoopOnCpu(mfi.tilebox(), [&](int i, int j, int k) {
+            const bool inc_set = inc(i, j, k) == amrex::TagBox::SET;
+            const bool full_set = full(i, j, k) == amrex::TagBox::SET;
+            nmissed += full_set && !inc_set;
+            nspurious += inc_set && !full_set;
+        });
+    }
+
+    amrex::ParallelDescriptor::ReduceLongSum(nmissed);
+    amrex::ParallelDescriptor::ReduceLongSum(nspurious);
+
+    amrex::Print() << "    Incremental vs full tagging on level " << lev
+                   << ": " << nmissed << " tags missed, " << nspurious
+                   << " spurious tags." << std::endl;
+
+    if (nmissed > 0 || nspurious > 0) {
+        amrex::Abort("#error: Incremental tagging differs from full tagging "
+                     "on level " + std::to_string(lev) + "!");
+    }
+}
+
+/** @brief Adds truncation error tags that have been computed while averaging
+ *         down. Each coarse cell tag refines all eight fine cells it covers.
+ * @param   te_tags     Truncation error tags, one per coarse cell.
+ * @param   tagarr      Tag status.
+ * @param   tilebox     Current (tile)box.
+ * @param   ntags_total Counts number of cells that have been tagged.
+ */
+void Sledgehamr::AddTruncationErrorTagsCpu(
+    const amrex::Array4<char const> &te_tags, const amrex::Array4<char> &tagarr,
+    const amrex::Box &tilebox, long *ntags_total) {
+    const amrex::Dim3 lo = amrex::lbound(tilebox);
+    const amrex::Dim3 hi = amrex::ubound(tilebox);
+
+    // Truncation errors are only defined on even fine cells.
+    for (int k = lo.z + (lo.z & 1); k <= hi.z; k += 2) {
+        for (int j = lo.y + (lo.y & 1); j <= hi.y; j += 2) {
+            for (int i = lo.x + (lo.x & 1); i <= hi.x; i += 2) {
+                if (te_tags(i / 2, j / 2, k / 2) != amrex::TagBox::SET)
+                    continue;
+
+                for (int kk = k; kk <= k + 1; ++kk) {
+                    for (int jj = j; jj <= j + 1; ++jj) {
+                        for (int ii = i; ii <= i + 1; ++ii) {
+                            if (tagarr(ii, jj, kk) == amrex::TagBox::SET)
+                                continue;
+
+                            tagarr(ii, jj, kk) = amrex::TagBox::SET;
+                            (*ntags_total)++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 /** @brief Same as Sledgehamr::DoErrorEstCpu but on GPUs. Will not keep track
  *         of tagging statistics.
  */
@@ -367,8 +762,11 @@ void Sledgehamr::DoErrorEstGpu(int lev, amrex::TagBoxArray &tags, double time) {
     for (amrex::MFIter mfi(state, amrex::TilingIfNotGPU()); mfi.isValid();
          ++mfi) {
         const amrex::Box &tilebox = mfi.tilebox();
-        const amrex::Array4<double const> &state_fab = state.array(mfi);
-        const amrex::Array4<double const> &state_fab_te = state_te.array(mfi);
+        const amrex::Array4<amrex::Real const> &state_fab = state.array(mfi);
+        // The old state of the finest level may have been released if no
+        // truncation errors are used.
+        const amrex::Array4<amrex::Real const> &state_fab_te =
+            shadow_hierarchy ? state_te.array(mfi) : state_fab;
         const amrex::Array4<char> &tag_arr = tags.array(mfi);
 
         // Tag with or without truncation errors.
@@ -417,6 +815,22 @@ void Sledgehamr::ParseInput() {
     utils::AssessParam(validity, param_name, get_box_layout_nodes, error_msg,
                        warning_msg, nerrors, do_thorough_checks);
 
+    param_name = "input.check_simd_kernels";
+    pp.query(param_name.c_str(), check_simd_kernels);
+    utils::AssessParamOK(param_name, check_simd_kernels, do_thorough_checks);
+
+    param_name = "input.check_box_wrapping";
+    pp.query(param_name.c_str(), check_box_wrapping);
+    utils::AssessParamOK(param_name, check_box_wrapping, do_thorough_checks);
+
+    param_name = "input.check_gw_projection";
+    pp.query(param_name.c_str(), check_gw_projection);
+    utils::AssessParamOK(param_name, check_gw_projection, do_thorough_checks);
+
+    param_name = "input.benchmark_fft_cache";
+    pp.query(param_name.c_str(), benchmark_fft_cache);
+    utils::AssessParamOK(param_name, benchmark_fft_cache, do_thorough_checks);
+
     param_name = "amr.nghost";
     pp.query(param_name.c_str(), nghost);
     validity = utils::ErrorState::OK;
@@ -435,6 +849,11 @@ void Sledgehamr::ParseInput() {
     pp.query(param_name.c_str(), tagging_on_gpu);
     utils::AssessParamOK(param_name, tagging_on_gpu, do_thorough_checks);
 
+    param_name = "amr.fuse_truncation_error_tagging";
+    pp.query(param_name.c_str(), fuse_truncation_error_tagging);
+    utils::AssessParamOK(param_name, fuse_truncation_error_tagging,
+                         do_thorough_checks);
+
     param_name = "amr.coarse_level_grid_size";
     pp.get(param_name.c_str(), coarse_level_grid_size);
     validity = (utils::ErrorState)utils::IsPowerOfTwo(coarse_level_grid_size);
@@ -547,71 +966,4 @@ void Sledgehamr::ParseInputScalars() {
     }
 }
 
-/** @brief Loads the spectrum binning from file. Aborts if they are not found.
- * @param   reload  We reload the binning from file. Needed e.g. when we change
- *                  the coarse level resolution.
- */
-void Sledgehamr::ReadSpectrumKs(bool reload) {
-    if (!spectrum_ks.empty() && !reload)
-        return;
-
-    if (reload) {
-        spectrum_ks.clear();
-        gw_spectrum_ks.clear();
-        index_to_k.clear();
-    }
-
-    ReadK(spectrum_ks, dimN[0]);
-
-    if (gravitational_waves == nullptr) {
-        return;
-    }
-
-    int dim = dimN[0] * gravitational_waves->GetZeroPadding();
-    ReadK(gw_spectrum_ks, dim);
-    ReadProj(dim);
-}
-
-void Sledgehamr::ReadK(std::vector<int> &spec, int dim) {
-    std::string filename = SLEDGEHAMR_DATA_PATH;
-    filename += "spectra_ks.hdf5";
-    std::string sdimN = std::to_string(dim);
-
-    std::string msg =
-        "Sledgehamr::ReadSpectrumKs: Could not find precomputed "
-        "spectrum binning!\n Either the path to sledgehamr was set "
-        "wrongly during compilation\n (currently set to " SLEDGEHAMR_DATA_PATH
-        ")\n or data for a " +
-        sdimN +
-        "^3 grid has"
-        "not yet been added to the file (github repo only comes "
-        "with binnings for a grid up to 512^3).\n Spectrum binning "
-        "for a larger grid can generated by running the Jupyter "
-        "notebook sledgehamr/notebooks/AddSpectrumBins.ipynb.";
-
-    std::vector<int> nks(1);
-    if (!utils::hdf5::Read(filename, {sdimN + "_nks"}, &(nks[0]))) {
-        amrex::Abort(msg);
-    }
-
-    spec.resize(nks[0]);
-    if (!utils::hdf5::Read(filename, {sdimN + "_bins"}, &(spec[0]))) {
-        amrex::Abort(msg);
-    }
-}
-
-void Sledgehamr::ReadProj(int dim) {
-    std::string filename = SLEDGEHAMR_DATA_PATH;
-    filename += "spectra_ks.hdf5";
-    std::string sdimN = std::to_string(dim);
-    std::string projection =
-        std::to_string(gravitational_waves->GetProjectionType());
-    index_to_k.resize(dim);
-    amrex::Print() << "Load gw spectra pre-computed data." << std::endl;
-    if (!utils::hdf5::Read(filename, {sdimN + "_k" + projection},
-                           &(index_to_k[0]))) {
-        amrex::Abort("Could not read projection!");
-    }
-}
-
 }; // namespace sledgehamr
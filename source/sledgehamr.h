@@ -1,27 +1,42 @@
 #ifndef SLEDGEHAMR_SLEDGEHAMR_H_
 #define SLEDGEHAMR_SLEDGEHAMR_H_
 
+#include <climits>
+
 #include <AMReX_AmrCore.H>
+#include <AMReX_GpuContainers.H>
 
 #ifdef AMREX_MEM_PROFILING
 #include <AMReX_MemProfiler.H>
 #endif
 
 #include "kernels.h"
+#include "simd_kernels.h"
 #include "macros.h"
 
+#include "autotuner.h"
 #include "gravitational_waves.h"
+#include "incremental_tagging.h"
 #include "io_module.h"
 #include "level_data.h"
 #include "level_synchronizer.h"
+#include "load_balancer.h"
 #include "local_regrid/local_regrid.h"
+#include "morton_clustering.h"
 #include "output_types/checkpoint.h"
 #include "performance_monitor.h"
 #include "projection.h"
 #include "scalars.h"
+#include "scratch_pool.h"
 #include "spectrum.h"
+#include "spectrum_bins.h"
 #include "time_stepper.h"
 
+#ifdef SLEDGEHAMR_REAL
+static_assert(std::is_same<SLEDGEHAMR_REAL, amrex::Real>::value,
+              "SLEDGEHAMR_REAL needs to match the precision of AMReX.");
+#endif
+
 namespace sledgehamr {
 
 class LevelSynchronizer;
@@ -34,6 +49,32 @@ class Spectrum;
 class GravitationalWaves;
 class Checkpoint;
 class PerformanceMonitor;
+class LoadBalancer;
+class IncrementalTagging;
+class MortonClustering;
+class RegridRecorder;
+class Autotuner;
+
+/** @brief Rhs meta data of one level at one time. Set up once per level and
+ *         stage by temporally blocked integrators and shared by all tiles.
+ */
+struct RhsBoxParams {
+    /** @brief Time at which the Rhs is evaluated.
+     */
+    double time = 0;
+
+    /** @brief Parameters set by Sledgehamr::SetParamsRhs.
+     */
+    amrex::Gpu::DeviceVector<double> params_rhs;
+
+    /** @brief Parameters set by Sledgehamr::SetParamsGravitationalWaveRhs.
+     */
+    amrex::Gpu::DeviceVector<double> params_gw_rhs;
+
+    /** @brief Kreiss-Oliger dissipation strength of each component.
+     */
+    amrex::Gpu::DeviceVector<double> dissipation_strength;
+};
 
 /** @brief Abstract base class for all derived projects. Combines all the
  *         ingredients to make this code work.
@@ -49,12 +90,19 @@ class Sledgehamr : public amrex::AmrCore {
     friend class GravitationalWaves;
     friend class Checkpoint;
     friend class PerformanceMonitor;
+    friend class LoadBalancer;
+    friend class IncrementalTagging;
+    friend class MortonClustering;
+    friend class Autotuner;
 
   public:
     Sledgehamr();
     void InitSledgehamr();
     void Evolve();
 
+    virtual void regrid(int lbase, amrex::Real time,
+                        bool initial = false) override;
+
     /** @brief Virtual function that loops over a state to fill the RHS. Has to
      *         be defined by derived project class, though this will be hidden
      *         from the user. Reason for this is so that the RHS function,
@@ -67,10 +115,13 @@ class Sledgehamr : public amrex::AmrCore {
      * @param   lev         Currently level.
      * @param   dt          Time step size.
      * @param   dx          Grid spacing.
+     * @param   region      Only compute Rhs for cells in this region, see
+     *                      utils::RhsRegion.
      */
-    virtual void FillRhs(amrex::MultiFab &rhs_mf,
+    virtual void FillRhs(RhsMultiFab &rhs_mf,
                          const amrex::MultiFab &state_mf, const double time,
-                         const int lev, const double dt, const double dx) = 0;
+                         const int lev, const double dt, const double dx,
+                         const int region = utils::RhsRegion::AllCells) = 0;
 
     /** @brief Like FillRhs but the result will be added to rhs_mf rather than
      *         set.
@@ -81,11 +132,49 @@ class Sledgehamr : public amrex::AmrCore {
      * @param   dt          Time step size.
      * @param   dx          Grid spacing.
      * @param   weight      rhs = weight*rhs + ...
+     * @param   region      Only compute Rhs for cells in this region, see
+     *                      utils::RhsRegion.
      */
-    virtual void FillAddRhs(amrex::MultiFab &rhs_mf,
+    virtual void FillAddRhs(RhsMultiFab &rhs_mf,
                             const amrex::MultiFab &state_mf, const double time,
                             const int lev, const double dt, const double dx,
-                            const double weight) = 0;
+                            const double weight,
+                            const int region = utils::RhsRegion::AllCells) = 0;
+
+    /** @brief Like FillRhs but only for a single box. Used by temporally
+     *         blocked integrators.
+     * @param   bx          Box on which the Rhs is computed.
+     * @param   rhs_fab     Container to fill the Rhs with.
+     * @param   state_fab   State from which the RHS is to be computed.
+     * @param   params      Rhs parameters at the current time.
+     * @param   lev         Currently level.
+     * @param   dt          Time step size.
+     * @param   dx          Grid spacing.
+     */
+    virtual void FillRhsBox(const amrex::Box &bx,
+                            const amrex::Array4<double> &rhs_fab,
+                            const amrex::Array4<amrex::Real const> &state_fab,
+                            const RhsBoxParams &params, const int lev,
+                            const double dt, const double dx) = 0;
+
+    /** @brief Like FillAddRhs but only for a single box.
+     * @param   bx          Box on which the Rhs is computed.
+     * @param   rhs_fab     Container to add the Rhs to.
+     * @param   state_fab   State from which the RHS is to be computed.
+     * @param   params      Rhs parameters at the current time.
+     * @param   lev         Currently level.
+     * @param   dt          Time step size.
+     * @param   dx          Grid spacing.
+     * @param   weight      rhs = weight*rhs + ...
+     */
+    virtual void FillAddRhsBox(
+        const amrex::Box &bx, const amrex::Array4<double> &rhs_fab,
+        const amrex::Array4<amrex::Real const> &state_fab,
+        const RhsBoxParams &params, const int lev, const double dt,
+        const double dx, const double weight) = 0;
+
+    void SetUpRhsBoxParams(RhsBoxParams &params, const double time,
+                           const int lev);
 
     /** @brief Returns the box length L.
      */
@@ -129,6 +218,14 @@ class Sledgehamr : public amrex::AmrCore {
      */
     LevelData &GetOldLevelData(const int lev) { return grid_old[lev]; }
 
+    /** @brief Returns the number of ghost cells at a given level. Levels
+     *         advanced with temporal blocking carry a wider halo.
+     * @param   lev Level.
+     */
+    int NGhost(const int lev) const {
+        return lev >= blocked_min_level ? blocked_nghost : nghost;
+    }
+
     /** @brief Returns the blocking factor at a given level.
      * @param   lev Level.
      */
@@ -151,10 +248,44 @@ class Sledgehamr : public amrex::AmrCore {
      */
     std::unique_ptr<IOModule> io_module;
 
-    /** @brief Number of ghost cells.
+    /** @brief Pool of temporary MultiFabs.
+     */
+    std::unique_ptr<ScratchPool> scratch_pool;
+
+    /** @brief Pointer to the load balancer.
+     */
+    std::unique_ptr<LoadBalancer> load_balancer;
+
+    /** @brief Keeps track of previous tags to skip untagged regions.
+     */
+    std::unique_ptr<IncrementalTagging> incremental_tagging;
+
+    /** @brief Pointer to the Morton clustering backend of global regrids.
+     */
+    std::unique_ptr<MortonClustering> clustering;
+
+    /** @brief Pointer to the recorder of local regrids.
+     */
+    std::unique_ptr<RegridRecorder> regrid_recorder;
+
+    /** @brief Pointer to the tile size and max grid size autotuner.
+     */
+    std::unique_ptr<Autotuner> autotuner;
+
+    /** @brief Number of ghost cells, i.e. the stencil width of a single Rhs
+     *         evaluation. Use NGhost(lev) for the halo of a level.
      */
     int nghost = 0;
 
+    /** @brief Number of ghost cells of levels >= blocked_min_level, which are
+     *         advanced with temporal blocking.
+     */
+    int blocked_nghost = 0;
+
+    /** @brief Coarsest level advanced with temporal blocking.
+     */
+    int blocked_min_level = INT_MAX;
+
     /** @brief Whether we are running with gravitional waves.
      */
     bool with_gravitational_waves = false;
@@ -188,6 +319,8 @@ class Sledgehamr : public amrex::AmrCore {
                              const amrex::DistributionMapping &dm) override;
 
     virtual void ClearLevel(int lev) override;
+    virtual amrex::DistributionMapping
+    MakeDistributionMap(int lev, const amrex::BoxArray &ba) override;
     virtual void ErrorEst(int lev, amrex::TagBoxArray &tags, amrex::Real time,
                           int ngrow) override;
 
@@ -205,8 +338,8 @@ class Sledgehamr : public amrex::AmrCore {
      * @param   params_mod      User-defined parameters.
      */
     virtual void
-    TagWithTruncationCpu(const amrex::Array4<const double> &state_fab,
-                         const amrex::Array4<const double> &state_fab_te,
+    TagWithTruncationCpu(const amrex::Array4<const amrex::Real> &state_fab,
+                         const amrex::Array4<const amrex::Real> &state_fab_te,
                          const amrex::Array4<char> &tagarr,
                          const amrex::Box &tilebox, double time, int lev,
                          long *ntags_total, long *ntags_user, long *ntags_trunc,
@@ -216,8 +349,8 @@ class Sledgehamr : public amrex::AmrCore {
     /** @brief Same as TagWithTruncationCpu but performs work on GPUs.
      */
     virtual void
-    TagWithTruncationGpu(const amrex::Array4<const double> &state_fab,
-                         const amrex::Array4<const double> &state_fab_te,
+    TagWithTruncationGpu(const amrex::Array4<const amrex::Real> &state_fab,
+                         const amrex::Array4<const amrex::Real> &state_fab_te,
                          const amrex::Array4<char> &tagarr,
                          const amrex::Box &tilebox, double time, int lev,
                          const std::vector<double> &params_tag,
@@ -227,7 +360,7 @@ class Sledgehamr : public amrex::AmrCore {
      *         truncation error tags.
      */
     virtual void
-    TagWithoutTruncationCpu(const amrex::Array4<const double> &state_fab,
+    TagWithoutTruncationCpu(const amrex::Array4<const amrex::Real> &state_fab,
                             const amrex::Array4<char> &tagarr,
                             const amrex::Box &tilebox, double time, int lev,
                             long *ntags_total,
@@ -237,11 +370,35 @@ class Sledgehamr : public amrex::AmrCore {
      *         truncation error tags.
      */
     virtual void
-    TagWithoutTruncationGpu(const amrex::Array4<const double> &state_fab,
+    TagWithoutTruncationGpu(const amrex::Array4<const amrex::Real> &state_fab,
                             const amrex::Array4<char> &tagarr,
                             const amrex::Box &tilebox, double time, int lev,
                             const std::vector<double> &params) = 0;
 
+    /** @brief Virtual function that averages down a fine level onto the
+     *         coarse level while computing truncation error tags in the same
+     *         pass. Will automatically be overriden by the project class.
+     *         Work is performed on CPUs.
+     * @param   crse            Coarse level data.
+     * @param   fine            Fine level data.
+     * @param   te              Container to save truncation errors if
+     *                          materialize is true.
+     * @param   te_tags         Truncation error tags, one per coarse cell.
+     * @param   tilebox         Current coarse (tile)box.
+     * @param   time            Current time.
+     * @param   lev             Fine level.
+     * @param   materialize     Whether truncation errors are saved as well.
+     * @param   ntags_trunc     Counts number of truncation error tags.
+     * @param   params_mod      User-defined parameters.
+     */
+    virtual void AverageDownWithTruncationTagsCpu(
+        const amrex::Array4<amrex::Real> &crse,
+        const amrex::Array4<amrex::Real const> &fine,
+        const amrex::Array4<amrex::Real> &te,
+        const amrex::Array4<char> &te_tags, const amrex::Box &tilebox,
+        double time, int lev, bool materialize, long *ntags_trunc,
+        const std::vector<double> &params_mod) = 0;
+
     /** @brief Initialize project specific details. To be overriden by each
      *         project if required.
      */
@@ -413,18 +570,9 @@ class Sledgehamr : public amrex::AmrCore {
      */
     std::vector<double> te_crit;
 
-    /** @brief Unique bins for spectrum calculation.
-     */
-    std::vector<int> spectrum_ks;
-
-    /** @brief Unique bins for gravitational wave spectrum calculation.
-     */
-    std::vector<int> gw_spectrum_ks;
-
-    /** @brief Pre-computed conversion of index to k for gravitational wave
-     * spectrum calculation.
+    /** @brief Binning of spectra.
      */
-    std::vector<double> index_to_k;
+    std::unique_ptr<SpectrumBins> spectrum_bins;
 
     /** @brief  Vector of respective dissipation strenths.
      */
@@ -446,21 +594,43 @@ class Sledgehamr : public amrex::AmrCore {
     double last_full_time = 0;
 
   private:
+    void ClusterNewGrids(int lbase, amrex::Real time, int &new_finest,
+                         amrex::Vector<amrex::BoxArray> &new_grids);
     void DoErrorEstCpu(int lev, amrex::TagBoxArray &tags, double time);
     void DoErrorEstGpu(int lev, amrex::TagBoxArray &tags, double time);
+    void TagTilesCpu(const int lev, amrex::TagBoxArray &tags,
+                     const double time, const bool incremental,
+                     const bool fused, const std::vector<double> &params_tag,
+                     const std::vector<double> &params_mod, long &ntags_total,
+                     long &ntags_user, std::vector<long> &ntags_trunc,
+                     long &ncells_skipped);
+    void CheckIncrementalTags(const int lev, const amrex::TagBoxArray &tags,
+                              const double time, const bool fused,
+                              const std::vector<double> &params_tag,
+                              const std::vector<double> &params_mod);
+    void AddTruncationErrorTagsCpu(const amrex::Array4<char const> &te_tags,
+                                   const amrex::Array4<char> &tagarr,
+                                   const amrex::Box &tilebox,
+                                   long *ntags_total);
 
     void ParseInput();
     void ParseInputScalars();
-    void ReadSpectrumKs(bool reload = false);
-    void ReadK(std::vector<int> &spec, int dim);
-    void ReadProj(int dim);
     void DoPrerunChecks();
     void DetermineBoxLayout();
+    void CheckSimdKernels();
+    void CheckBoxWrapping();
+    void CheckGwProjection();
+    void BenchmarkFftCache();
 
     /** @brief Whether tagging should be performed on gpu if possible.
      */
     bool tagging_on_gpu = false;
 
+    /** @brief Whether truncation error tags are computed while averaging down
+     *         instead of storing truncation errors for the tagging step.
+     */
+    bool fuse_truncation_error_tagging = true;
+
     /** @brief Whether we actually want to perform a simulation or just checking
      *         parameters or other things.
      */
@@ -471,6 +641,26 @@ class Sledgehamr : public amrex::AmrCore {
      */
     int get_box_layout_nodes = 0;
 
+    /** @brief Whether to compare the vectorized stencils against the
+     *         pointwise kernels on a random box and exit.
+     */
+    bool check_simd_kernels = false;
+
+    /** @brief Whether to test wrapping boxes across periodic boundaries and
+     *         exit.
+     */
+    bool check_box_wrapping = false;
+
+    /** @brief Whether to compare and time the gravitational wave projection
+     *         against the explicit sum over the TT-projector and exit.
+     */
+    bool check_gw_projection = false;
+
+    /** @brief Number of FFTs timed with and without cached FFT contexts
+     *         before exiting. 0 disables the benchmark.
+     */
+    int benchmark_fft_cache = 0;
+
     /** @brief Whether we want to increase the coarse level resolution once.
      */
     bool increase_coarse_level_resolution = false;
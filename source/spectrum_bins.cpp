@@ -0,0 +1,238 @@
+#include "spectrum_bins.h"
+#include "hdf5_utils.h"
+#include "sledgehamr.h"
+
+namespace sledgehamr {
+
+namespace {
+
+/** @brief Checks whether an integer can be written as the sum of three squares
+ *         with each component bounded by m.
+ * @param   sq      Integer to check.
+ * @param   m       Largest allowed component.
+ * @param   two_sq  Flags all sums of two squares with components bounded by m.
+ */
+bool IsShell(const long sq, const long m, const std::vector<char> &two_sq) {
+    // Legendre's three-square theorem.
+    long r = sq;
+    while (r > 0 && r % 4 == 0)
+        r /= 4;
+    if (r % 8 == 7)
+        return false;
+
+    // No component of any decomposition can exceed m.
+    if (sq <= m * m)
+        return true;
+
+    const long rest = sq - 2 * m * m;
+    long kmin = std::sqrt(static_cast<double>(std::max(0L, rest)));
+    while (kmin * kmin < rest)
+        ++kmin;
+
+    for (long k = kmin; k <= m && k * k <= sq; ++k) {
+        if (two_sq[sq - k * k])
+            return true;
+    }
+
+    return false;
+}
+
+}; // namespace
+
+/** @brief Reads the bin scheme of a spectrum.
+ * @param   owner           Pointer to the simulation.
+ * @param   prefix          Prefix of the input parameters, e.g.
+ *                          'output.spectra'.
+ * @param   default_scheme  Scheme to use if none is given.
+ */
+SpectrumBins::SpectrumBins(Sledgehamr *owner, const std::string &prefix,
+                           const int default_scheme)
+    : scheme(default_scheme), sim(owner) {
+    amrex::ParmParse pp(prefix);
+    pp.query("bin_scheme", scheme);
+    pp.query("bin_width", bin_width);
+    pp.query("bins_per_decade", bins_per_decade);
+
+    if (scheme < SpectrumBinScheme::ShellBins ||
+        scheme > SpectrumBinScheme::LogBins) {
+        amrex::Abort("#error: Unknown " + prefix +
+                     ".bin_scheme: " + std::to_string(scheme));
+    }
+
+    if (bin_width <= 0)
+        amrex::Abort("#error: " + prefix + ".bin_width needs to be > 0!");
+
+    if (bins_per_decade < 1)
+        amrex::Abort("#error: " + prefix +
+                     ".bins_per_decade needs to be >= 1!");
+}
+
+/** @brief Builds the bins and the |k|^2 to bin lookup for a given grid size.
+ *         Does nothing if they already exist for this grid size.
+ * @param   dim Number of cells in each direction, including zero padding.
+ */
+void SpectrumBins::Build(const int dim) {
+    if (dim == built_dim)
+        return;
+
+    built_dim = dim;
+    std::vector<int> shells = GetShells(dim);
+
+    const long m = dim / 2;
+    const long max_sq = 3 * m * m;
+    sq_to_bin.assign(max_sq + 1, -1);
+    ks.clear();
+
+    if (scheme == SpectrumBinScheme::ShellBins) {
+        ks.assign(shells.begin(), shells.end());
+        for (int b = 0; b < shells.size(); ++b)
+            sq_to_bin[shells[b]] = b;
+    } else if (scheme == SpectrumBinScheme::LinearBins) {
+        const double kmax = std::sqrt(static_cast<double>(max_sq));
+        const int nbins = static_cast<int>(kmax / bin_width + .5) + 1;
+        for (int n = 0; n < nbins; ++n) {
+            const double k = n * bin_width;
+            ks.push_back(k * k);
+        }
+
+        for (const int sq : shells) {
+            sq_to_bin[sq] = static_cast<int>(
+                std::sqrt(static_cast<double>(sq)) / bin_width + .5);
+        }
+    } else {
+        // The zero mode gets its own bin.
+        int last = -1;
+        for (const int sq : shells) {
+            const int raw =
+                sq == 0 ? -1
+                        : static_cast<int>(std::floor(
+                              .5 * bins_per_decade *
+                              std::log10(static_cast<double>(sq))));
+            if (ks.empty() || raw != last) {
+                ks.push_back(sq);
+                last = raw;
+            }
+            sq_to_bin[sq] = ks.size() - 1;
+        }
+    }
+}
+
+/** @brief Returns all unique |k|^2 of a grid. Reads them from the cache next
+ *         to the checkpoints if available, otherwise generates and caches them.
+ * @param   dim Number of cells in each direction.
+ */
+std::vector<int> SpectrumBins::GetShells(const int dim) {
+    const std::string folder = sim->io_module->output_folder + "/checkpoints";
+    const std::string filename =
+        folder + "/spectrum_bins_" + std::to_string(dim) + ".hdf5";
+
+    std::vector<int> shells;
+    int nks = 0;
+    if (utils::hdf5::Read(filename, {"nks"}, &nks)) {
+        shells.resize(nks);
+        if (utils::hdf5::Read(filename, {"bins"}, shells.data()))
+            return shells;
+    }
+
+    amrex::Print() << "Generate spectrum binning for a " << dim << "^3 grid."
+                   << std::endl;
+    shells = GenerateShells(dim);
+
+    if (amrex::ParallelDescriptor::IOProcessor()) {
+        amrex::UtilCreateDirectory(folder, 0755);
+        hid_t file_id = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC,
+                                  H5P_DEFAULT, H5P_DEFAULT);
+        nks = shells.size();
+        utils::hdf5::Write(file_id, "nks", &nks, 1);
+        utils::hdf5::Write(file_id, "bins", shells.data(), shells.size());
+        H5Fclose(file_id);
+    }
+
+    // Make sure nobody reads the cache while it is being written.
+    amrex::ParallelDescriptor::Barrier();
+
+    return shells;
+}
+
+/** @brief Computes all unique |k|^2 of a grid. Each rank checks a contiguous
+ *         range of |k|^2 using OpenMP, the results are gathered on the I/O
+ *         rank and broadcasted.
+ * @param   dim Number of cells in each direction.
+ */
+std::vector<int> SpectrumBins::GenerateShells(const int dim) {
+    const long m = dim / 2;
+    const long max_sq = 3 * m * m;
+
+    std::vector<char> two_sq(2 * m * m + 1, 0);
+    for (long i = 0; i <= m; ++i) {
+        for (long j = i; j <= m; ++j)
+            two_sq[i * i + j * j] = 1;
+    }
+
+    const int nprocs = amrex::ParallelDescriptor::NProcs();
+    const int rank = amrex::ParallelDescriptor::MyProc();
+    const long chunk = (max_sq + nprocs) / nprocs;
+    const long lo = std::min(max_sq + 1, rank * chunk);
+    const long hi = std::min(max_sq + 1, lo + chunk);
+
+    std::vector<char> is_shell(hi - lo);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (long sq = lo; sq < hi; ++sq)
+        is_shell[sq - lo] = IsShell(sq, m, two_sq);
+
+    std::vector<int> local;
+    for (long sq = lo; sq < hi; ++sq) {
+        if (is_shell[sq - lo])
+            local.push_back(sq);
+    }
+
+    const int root = amrex::ParallelDescriptor::IOProcessorNumber();
+    int nlocal = local.size();
+    std::vector<int> counts(nprocs), displs(nprocs, 0);
+    amrex::ParallelDescriptor::Gather(&nlocal, 1, counts.data(), 1, root);
+
+    int ntotal = 0;
+    if (amrex::ParallelDescriptor::IOProcessor()) {
+        for (int p = 0; p < nprocs; ++p) {
+            displs[p] = ntotal;
+            ntotal += counts[p];
+        }
+    }
+    amrex::ParallelDescriptor::Bcast(&ntotal, 1, root);
+
+    // Ranges are ordered by rank, so the result is sorted.
+    std::vector<int> shells(ntotal);
+    amrex::ParallelDescriptor::Gatherv(local.data(), nlocal, shells.data(),
+                                       counts, displs, root);
+    amrex::ParallelDescriptor::Bcast(shells.data(), ntotal, root);
+
+    return shells;
+}
+
+/** @brief Allocates one zeroed histogram per OpenMP thread.
+ * @param   number_of_bins  Number of bins.
+ */
+SpectrumHistogram::SpectrumHistogram(const int number_of_bins)
+    : nbins(number_of_bins), nthreads(amrex::OpenMP::get_max_threads()) {
+    data.resize(static_cast<std::size_t>(nthreads) * nbins, 0.);
+}
+
+/** @brief Sums all thread-private histograms into the first one using a
+ *         pairwise tree reduction.
+ */
+void SpectrumHistogram::Reduce() {
+    for (int stride = 1; stride < nthreads; stride *= 2) {
+        const int npairs = (nthreads + stride - 1) / (2 * stride);
+        const std::size_t offset = static_cast<std::size_t>(stride) * nbins;
+
+#pragma omp parallel for collapse(2)
+        for (int p = 0; p < npairs; ++p) {
+            for (int b = 0; b < nbins; ++b) {
+                const std::size_t dst = 2 * p * offset + b;
+                data[dst] += data[dst + offset];
+            }
+        }
+    }
+}
+
+}; // namespace sledgehamr
@@ -0,0 +1,120 @@
+#ifndef SLEDGEHAMR_SPECTRUM_BINS_H_
+#define SLEDGEHAMR_SPECTRUM_BINS_H_
+
+#include <AMReX_AmrCore.H>
+#include <AMReX_OpenMP.H>
+
+namespace sledgehamr {
+
+class Sledgehamr;
+
+/** @brief Enum containing all valid bin schemes of spectra. These are the
+ *         values that are being used in the inputs file under
+ *         'output.spectra.bin_scheme' and 'output.gw_spectra.bin_scheme'.
+ *         ShellBins:   Each unique integer |k|^2 forms its own bin.
+ *         LinearBins:  Bins of constant width in |k| centred on multiples of
+ *                      the width.
+ *         LogBins:     Logarithmically spaced bins in |k|. Empty bins are
+ *                      dropped.
+ */
+enum SpectrumBinScheme {
+    ShellBins = 0,
+    LinearBins = 1,
+    LogBins = 2
+};
+
+/** @brief Maps the integer |k|^2 of a k-mode onto the bin of a spectrum. The
+ *         unique |k|^2 shells of a grid are generated in parallel at startup
+ *         and cached on disk next to the checkpoints, such that any grid size
+ *         and zero padding is supported without pre-computed data.
+ */
+class SpectrumBins {
+  public:
+    SpectrumBins(Sledgehamr *owner, const std::string &prefix,
+                 const int default_scheme);
+
+    void Build(const int dim);
+
+    /** @brief Returns the bin of a k-mode.
+     * @param   k_sq    Integer |k|^2 of the k-mode.
+     */
+    int Bin(const int k_sq) const { return sq_to_bin[k_sq]; }
+
+    /** @brief Returns the number of bins.
+     */
+    int NBins() const { return ks.size(); }
+
+    /** @brief Selected bin scheme. See SpectrumBinScheme.
+     */
+    int scheme = SpectrumBinScheme::ShellBins;
+
+    /** @brief Representative |k|^2 of each bin. The shell itself for
+     *         ShellBins, the squared bin centre for LinearBins and the
+     *         smallest shell within the bin for LogBins.
+     */
+    std::vector<double> ks;
+
+    /** @brief Lookup from integer |k|^2 to bin. Entries that do not correspond
+     *         to any k-mode of the grid are -1.
+     */
+    std::vector<int> sq_to_bin;
+
+  private:
+    std::vector<int> GetShells(const int dim);
+    std::vector<int> GenerateShells(const int dim);
+
+    /** @brief Bin width in units of the fundamental mode if LinearBins.
+     */
+    double bin_width = 1;
+
+    /** @brief Number of bins per decade in |k| if LogBins.
+     */
+    int bins_per_decade = 10;
+
+    /** @brief Grid size the bins have been built for.
+     */
+    int built_dim = -1;
+
+    /** @brief Pointer to the simulation.
+     */
+    Sledgehamr *sim;
+};
+
+/** @brief Thread-private histograms over the bins of a spectrum. Each OpenMP
+ *         thread accumulates into its own copy, which avoids atomics and works
+ *         for any number of threads. The copies are combined with a pairwise
+ *         tree reduction.
+ */
+class SpectrumHistogram {
+  public:
+    SpectrumHistogram(const int number_of_bins);
+
+    void Reduce();
+
+    /** @brief Returns the histogram of the calling thread.
+     */
+    double *ThreadLocal() {
+        return data.data() + amrex::OpenMP::get_thread_num() * nbins;
+    }
+
+    /** @brief Returns the combined histogram. Only valid after Reduce.
+     */
+    double *Result() { return data.data(); }
+
+  private:
+    /** @brief Number of bins.
+     */
+    int nbins;
+
+    /** @brief Number of thread-private copies.
+     */
+    int nthreads;
+
+    /** @brief Histograms of all threads stored consecutively.
+     */
+    std::vector<double> data;
+};
+
+}; // namespace sledgehamr
+
+#endif // SLEDGEHAMR_SPECTRUM_BINS_H_
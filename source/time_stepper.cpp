@@ -73,6 +73,7 @@ void TimeStepper::ParseParams() {
     double reg_dt = DBL_MAX;
     pp_amr.query("regrid_dt", reg_dt);
     pp_amr.query("semistatic_sim", semistatic_sim);
+    pp_amr.query("release_old_state", release_old_state);
 
     for (int lev = 0; lev <= sim->max_level; ++lev) {
         regrid_dt.push_back(reg_dt / pow(2, lev));
@@ -110,9 +111,18 @@ void TimeStepper::Advance(int lev) {
 
     // Advance this level.
     PreAdvanceMessage(lev);
+    sim->autotuner->BeginStep(lev);
     utils::sctp timer = utils::StartTimer();
     integrator->Advance(lev);
-    PostAdvanceMessage(lev, utils::DurationSeconds(timer));
+    double duration = utils::DurationSeconds(timer);
+    sim->autotuner->EndStep(lev, sim->CountCells(lev));
+    PostAdvanceMessage(lev, duration);
+    sim->load_balancer->RecordStep(lev, sim->CountCells(lev), duration);
+    if (duration > 0) {
+        sim->performance_monitor->Count(
+            sim->performance_monitor->idx_cells_per_second,
+            static_cast<double>(sim->CountCells(lev)) / duration, lev);
+    }
 
     // Advance any finer levels twice.
     if (lev != sim->finest_level) {
@@ -130,6 +140,10 @@ void TimeStepper::Advance(int lev) {
     // advancing times on each level separately.
     if (lev == 0)
         SynchronizeTimes();
+
+    // Free the old state if nobody is going to read it before this level is
+    // advanced again.
+    ReleaseOldState(lev);
 }
 
 /** @brief Synchronizes two levels by averaging down. Computes truncation
@@ -170,6 +184,50 @@ void TimeStepper::SynchronizeTimes() {
         sim->grid_new[lev].t = sim->grid_new[0].t;
 }
 
+/** @brief Determines whether the old state of a level is going to be read
+ *         before the level is advanced again.
+ * @param   lev Level.
+ * @return  Whether sim->grid_old[lev] needs to be kept.
+ */
+bool TimeStepper::NeedsOldState(int lev) {
+    // Multi-step integrators read the previous time step.
+    if (integrator->NeedsOldState())
+        return true;
+
+    // Ghost cells of the finer level are interpolated in time between the old
+    // and new state of this level.
+    if (lev < sim->finest_level)
+        return true;
+
+    // The shadow level is created from the old coarse level state.
+    if (lev == 0 && sim->shadow_hierarchy)
+        return true;
+
+    // Truncation errors are needed until the scheduled regrid has been
+    // performed.
+    return sim->grid_old[lev].contains_truncation_errors;
+}
+
+/** @brief Frees the old state of a level if it is not needed anymore. Time
+ *         and step number are kept such that the sanity checks on
+ *         sim->grid_old[lev].t remain valid. The memory is allocated again
+ *         during the next time step by Integrator::Advance.
+ * @param   lev Level.
+ */
+void TimeStepper::ReleaseOldState(int lev) {
+    LevelData &old_state = sim->grid_old[lev];
+
+    if (release_old_state && old_state.isDefined() && !NeedsOldState(lev))
+        old_state.clear();
+
+    sim->performance_monitor->Count(
+        sim->performance_monitor->idx_grid_old_bytes,
+        old_state.isDefined() ? ScratchPool::Bytes(old_state) : 0., lev);
+    sim->performance_monitor->Count(
+        sim->performance_monitor->idx_grid_old_bytes_unreleased,
+        ScratchPool::Bytes(sim->grid_new[lev]), lev);
+}
+
 /** @brief Prints message just before a level has been advanced.
  * @param   lev Level that will be advanced.
  */
@@ -266,6 +324,12 @@ void TimeStepper::ScheduleRegrid(int lev) {
         return;
     }
 
+    // A skipped regrid would be performed one time step after the next
+    // opportunity.
+    if (SkipPredictedRegrid(lev, time_next_opportunity + sim->dt[lev])) {
+        return;
+    }
+
     // This is to avoid regridding on coarse right after restarting from a
     // checkpoint. We do not have a valid grid_old yet to evolve the needed
     // shadow level.
@@ -335,10 +399,43 @@ void TimeStepper::NoShadowRegrid(int lev) {
     if (!sim->DoCreateLevelIf(lev + 1, time + sim->dt[lev]))
         return;
 
+    if (SkipPredictedRegrid(lev, time + sim->dt[lev]))
+        return;
+
     // Actually do regrid if we made it this far.
     DoRegrid(lev, time);
 }
 
+/** @brief Checks whether a regrid that is due according to the regular
+ *         regrid interval can be skipped since tagged cells are predicted to
+ *         remain within the refined levels until the next opportunity.
+ * @param   lev         Coarsest level to be regridded.
+ * @param   time_next   Time by which a regrid would be performed if we were to
+ *                      skip this one.
+ * @return  Whether to skip the regrid.
+ */
+bool TimeStepper::SkipPredictedRegrid(int lev, double time_next) {
+    if (local_regrid->do_global_regrid[lev])
+        return false;
+
+    double t_latest = scheduler->LatestRegridTime(lev, sim->finest_level);
+    if (t_latest < time_next)
+        return false;
+
+    // Shift the regular interval such that the regrid becomes due again once
+    // the predicted time is reached.
+    last_regrid_time[lev] = t_latest - regrid_dt[lev];
+
+    std::string level_message = LevelMessage(lev, sim->grid_new[lev].istep);
+    amrex::Print() << std::left << std::setw(50) << level_message
+                   << "Regrid postponed until t=" << t_latest << " as tagged "
+                   << "cells are predicted to stay within refined levels."
+                   << std::endl;
+    sim->performance_monitor->Count(
+        sim->performance_monitor->idx_regrids_skipped, 1, lev);
+    return true;
+}
+
 /** @brief Performs the actual regrid, either local or global as
  *         appropriate.
  * @param   lev     Level at which to tag cells.
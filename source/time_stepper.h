@@ -53,6 +53,10 @@ private:
     void DoRegridIfScheduled(int lev);
     void NoShadowRegrid(int lev);
     void DoRegrid(int lev, double time);
+    bool SkipPredictedRegrid(int lev, double time_next);
+
+    bool NeedsOldState(int lev);
+    void ReleaseOldState(int lev);
 
     void ParseParams();
     void SetIntegrator();
@@ -66,6 +70,11 @@ private:
      */
     bool semistatic_sim = false;
 
+    /** @brief Whether to free grid_old of levels that do not need it in
+     *         between time steps.
+     */
+    bool release_old_state = true;
+
     /** @brief Pointer to the simulation.
      */
     Sledgehamr* sim;
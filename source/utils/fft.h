@@ -13,7 +13,9 @@
 #else
 #include <AMReX_FFT.H>
 #endif
+#include <chrono>
 #include <iterator>
+#include <list>
 
 #include "hdf5_utils.h"
 
@@ -129,6 +131,211 @@ static void WriteThis(const amrex::MultiFab *state, hid_t file_id, int comp) {
     hdf5::Write(file_id, "hey", (int *)&(hey[0]), hey.size());
     hdf5::Write(file_id, "hez", (int *)&(hez[0]), hez.size());
 }
+
+#ifndef OLD_FFT
+/** @brief Persistent state needed to compute FFTs of fields on a given layout:
+ *         the zero-padded layouts, their MultiFabs and the R2C plan. Building
+ *         these is much more expensive than the FFT itself, and spectra are
+ *         computed many times per output on the same layout. Contexts are
+ *         cached by FftContext::Get and keyed on the BoxArray and
+ *         DistributionMapping of the field, the domain, the zero padding and
+ *         the number of components transformed in one batch.
+ */
+struct FftContext {
+    /** @brief Builds padded layouts and the plan for a field.
+     * @param   field           Field layout.
+     * @param   geom            Geometry of the field.
+     * @param   zero_padding    Zero padding factor.
+     * @param   batch_size      Number of components transformed at once.
+     */
+    FftContext(const amrex::MultiFab &field, const amrex::Geometry &geom,
+               int zero_padding, int batch_size)
+        : ba{field.boxArray()},
+          dm{field.DistributionMap()},
+          domain{geom.Domain()},
+          padding{zero_padding},
+          ncomp{batch_size},
+          padded_geom{geom} {
+        const amrex::Vector<int> &original_pmap = dm.ProcessorMap();
+        const int N = ba.minimalBox().length(0);
+
+        // Original layout followed by shifted copies that will remain zero.
+        amrex::Vector<int> tmp_padded_pmap;
+        amrex::BoxList tmp_padded_bl;
+        for (int i = 0; i < zero_padding; ++i) {
+            for (int j = 0; j < zero_padding; ++j) {
+                for (int k = 0; k < zero_padding; ++k) {
+                    amrex::BoxList new_bl = ba.boxList();
+                    new_bl.shift(0, i * N);
+                    new_bl.shift(1, j * N);
+                    new_bl.shift(2, k * N);
+                    tmp_padded_bl.join(new_bl);
+
+                    std::copy(original_pmap.begin(), original_pmap.end(),
+                              std::back_inserter(tmp_padded_pmap));
+                }
+            }
+        }
+        amrex::BoxArray tmp_padded_ba(tmp_padded_bl);
+        amrex::DistributionMapping tmp_padded_dm(tmp_padded_pmap);
+
+        padded_geom.refine(
+            amrex::IntVect(zero_padding, zero_padding, zero_padding));
+
+        tmp_padded_field.define(tmp_padded_ba, tmp_padded_dm, ncomp, 0);
+        tmp_padded_field.setVal(0.0);
+
+        amrex::BoxArray padded_ba(tmp_padded_ba.minimalBox());
+        ChopGrids(padded_ba, amrex::ParallelDescriptor::NProcs());
+        amrex::DistributionMapping padded_dm(
+            padded_ba, amrex::ParallelDescriptor::NProcs());
+        padded_field.define(padded_ba, padded_dm, ncomp, 0);
+
+        // All components share a single redistribution and transpose.
+        r2c = std::make_unique<amrex::FFT::R2C<amrex::Real>>(
+            padded_ba.minimalBox(), amrex::FFT::Info().setBatchSize(ncomp));
+        auto const &[cba, cdm] = r2c->getSpectralDataLayout();
+        phi_fft.define(cba, cdm, ncomp, 0);
+    }
+
+    /** @brief Whether this context can be used for a given field.
+     */
+    bool Matches(const amrex::MultiFab &field, const amrex::Geometry &geom,
+                 int zero_padding, int batch_size) const {
+        return padding == zero_padding && ncomp == batch_size &&
+               domain == geom.Domain() &&
+               ba == field.boxArray() && dm == field.DistributionMap();
+    }
+
+    /** @brief Returns a cached context or creates a new one. The least
+     *         recently used context is evicted once the cache is full.
+     * @param   field           Field layout.
+     * @param   geom            Geometry of the field.
+     * @param   zero_padding    Zero padding factor.
+     * @param   batch_size      Number of components transformed at once.
+     */
+    static FftContext &Get(const amrex::MultiFab &field,
+                           const amrex::Geometry &geom, int zero_padding,
+                           int batch_size) {
+        static bool registered = false;
+
+        // Plans need to be destroyed before MPI is finalized.
+        if (!registered) {
+            amrex::ExecOnFinalize([]() { Release(); });
+            registered = true;
+        }
+
+        for (auto it = cache.begin(); it != cache.end() && max_size > 0;
+             ++it) {
+            if ((*it)->Matches(field, geom, zero_padding, batch_size)) {
+                cache.splice(cache.begin(), cache, it);
+                return *cache.front();
+            }
+        }
+
+        // The context that is returned needs to stay alive even if caching
+        // is disabled.
+        while (!cache.empty() &&
+               static_cast<int>(cache.size()) >= std::max(max_size, 1))
+            cache.pop_back();
+
+        cache.push_front(std::make_unique<FftContext>(
+            field, geom, zero_padding, batch_size));
+        return *cache.front();
+    }
+
+    /** @brief Frees all cached contexts including their padded fields and
+     *         plans. Needs to be called whenever the layout of a level
+     *         changes, and may be called after each output step to free
+     *         memory.
+     */
+    static void Release() { cache.clear(); }
+
+    /** @brief Number of contexts in the cache.
+     */
+    static int CacheSize() { return cache.size(); }
+
+    /** @brief Maximum number of cached contexts. 0 disables reuse between
+     *         calls.
+     */
+    inline static int max_size = 4;
+
+    /** @brief Forward transform of several components of a field.
+     * @param   field   Field.
+     * @param   comps   Components of field to be transformed. Has to contain
+     *                  ncomp elements.
+     */
+    void Forward(const amrex::MultiFab &field, const int *comps) {
+        // Only the original boxes overlap with the field, the zero-padded
+        // copies remain untouched. Consecutive components are copied at
+        // once.
+        for (int n = 0; n < ncomp;) {
+            int len = 1;
+            while (n + len < ncomp && comps[n + len] == comps[n] + len)
+                ++len;
+
+            tmp_padded_field.ParallelCopy(field, comps[n], n, len);
+            n += len;
+        }
+
+        amrex::Vector<amrex::BCRec> bcs;
+        bcs.resize(ncomp);
+        for (int n = 0; n < ncomp; ++n) {
+            for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+                bcs[n].setLo(i, amrex::BCType::int_dir);
+                bcs[n].setHi(i, amrex::BCType::int_dir);
+            }
+        }
+
+        amrex::CpuBndryFuncFab bndry_func(nullptr);
+        amrex::PhysBCFunct<amrex::CpuBndryFuncFab> physbc(padded_geom, bcs,
+                                                          bndry_func);
+
+        amrex::Vector<amrex::MultiFab *> smf{&tmp_padded_field};
+        amrex::Vector<double> stime{0};
+
+        amrex::FillPatchSingleLevel(padded_field, 0, smf, stime, 0, 0, ncomp,
+                                    padded_geom, physbc, 0);
+
+        r2c->forward(padded_field, phi_fft);
+    }
+
+    /** @brief Layout, domain, zero padding and batch size this context was
+     *         built for.
+     */
+    amrex::BoxArray ba;
+    amrex::DistributionMapping dm;
+    amrex::Box domain;
+    int padding;
+    int ncomp;
+
+    /** @brief Geometry of the zero-padded domain.
+     */
+    amrex::Geometry padded_geom;
+
+    /** @brief Field on the original layout plus zero-padded copies.
+     */
+    amrex::MultiFab tmp_padded_field;
+
+    /** @brief Zero-padded field on a layout suitable for the FFT.
+     */
+    amrex::MultiFab padded_field;
+
+    /** @brief FFT plan.
+     */
+    std::unique_ptr<amrex::FFT::R2C<amrex::Real>> r2c;
+
+    /** @brief FFT of the padded field.
+     */
+    amrex::FabArray<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>> phi_fft;
+
+  private:
+    /** @brief Cached contexts, most recently used first.
+     */
+    inline static std::list<std::unique_ptr<FftContext>> cache;
+};
+#endif
+
 /** @brief This function computes the FFT of some quantity.
  * @param   field                   State to compute the FFT of.
  * @param   field_fft_real_or_abs   Contains the real or absolute part of the
@@ -144,6 +351,46 @@ static void Fft(const amrex::MultiFab &field, const int comp,
                 amrex::MultiFab &field_fft_real_or_abs,
                 amrex::MultiFab &field_fft_imag, const amrex::Geometry &geom,
                 bool abs, int zero_padding = 1) {
+#ifndef OLD_FFT
+    // Use the new amrex::FFT setup. Layouts and plan are reused across calls.
+    FftContext &ctx = FftContext::Get(field, geom, zero_padding, 1);
+    ctx.Forward(field, &comp);
+
+    // create storage for the FFT
+    auto const &[cba, cdm] = ctx.r2c->getSpectralDataLayout();
+
+    field_fft_real_or_abs.define(cba, cdm, 1, 0);
+    field_fft_imag.define(cba, cdm, 1, 0);
+
+    amrex::FabArray<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>> &phi_fft =
+        ctx.phi_fft;
+
+    for (amrex::MFIter mfi(phi_fft); mfi.isValid(); ++mfi) {
+
+        amrex::Array4<amrex::GpuComplex<amrex::Real>> const &phi_fft_ptr =
+            phi_fft.array(mfi);
+        amrex::Array4<amrex::Real> real_or_abs =
+            field_fft_real_or_abs.array(mfi);
+        amrex::Array4<amrex::Real> imag = field_fft_imag.array(mfi);
+
+        const amrex::Box &bx = mfi.fabbox();
+
+        if (abs) {
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j,
+                                                        int k) noexcept {
+                real_or_abs(i, j, k, 0) = std::sqrt(
+                    phi_fft_ptr(i, j, k).real() * phi_fft_ptr(i, j, k).real() +
+                    phi_fft_ptr(i, j, k).imag() * phi_fft_ptr(i, j, k).imag());
+            });
+        } else {
+            amrex::ParallelFor(
+                bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+                    real_or_abs(i, j, k, 0) = phi_fft_ptr(i, j, k).real();
+                    imag(i, j, k, 0) = phi_fft_ptr(i, j, k).imag();
+                });
+        }
+    }
+#else
     const amrex::BoxArray &original_ba = field.boxArray();
     const amrex::Vector<int> &original_pmap =
         field.DistributionMap().ProcessorMap();
@@ -217,51 +464,6 @@ static void Fft(const amrex::MultiFab &field, const int comp,
     amrex::FillPatchSingleLevel(padded_field, 0, smf, stime, 0, 0, 1,
                                 padded_geom, physbc, 0);
 
-#ifndef OLD_FFT
-    // Use the new amrex::FFT setup
-    amrex::Box domain = padded_ba.minimalBox();
-    amrex::FFT::R2C my_fft(domain);
-
-    // create storage for the FFT
-    auto const &[cba, cdm] = my_fft.getSpectralDataLayout();
-
-    // amrex::Print() << "padded ba" << padded_ba << std::endl;
-    // amrex::Print() << "cba" << cba << std::endl;
-
-    field_fft_real_or_abs.define(cba, cdm, 1, 0);
-    field_fft_imag.define(cba, cdm, 1, 0);
-
-    amrex::FabArray<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>> phi_fft(
-        cba, cdm, 1, 0);
-    my_fft.forward(padded_field, phi_fft);
-
-    for (amrex::MFIter mfi(phi_fft); mfi.isValid(); ++mfi) {
-
-        amrex::Array4<amrex::GpuComplex<amrex::Real>> const &phi_fft_ptr =
-            phi_fft.array(mfi);
-        amrex::Array4<amrex::Real> real_or_abs =
-            field_fft_real_or_abs.array(mfi);
-        amrex::Array4<amrex::Real> imag = field_fft_imag.array(mfi);
-
-        const amrex::Box &bx = mfi.fabbox();
-
-        if (abs) {
-            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j,
-                                                        int k) noexcept {
-                real_or_abs(i, j, k, 0) = std::sqrt(
-                    phi_fft_ptr(i, j, k).real() * phi_fft_ptr(i, j, k).real() +
-                    phi_fft_ptr(i, j, k).imag() * phi_fft_ptr(i, j, k).imag());
-            });
-        } else {
-            amrex::ParallelFor(
-                bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-                    real_or_abs(i, j, k, 0) = phi_fft_ptr(i, j, k).real();
-                    imag(i, j, k, 0) = phi_fft_ptr(i, j, k).imag();
-                });
-        }
-    }
-#else
-
     // Now setup SWFFT
     int nx = padded_ba[0].size()[0];
     int ny = padded_ba[0].size()[1];
@@ -350,6 +552,75 @@ static void Fft(const amrex::MultiFab &field, const int comp,
 #endif
 }
 
+#ifndef OLD_FFT
+/** @brief Same as Fft but transforms several components of a field at once.
+ *         All components share a single redistribution and transpose.
+ *         Components should be passed in storage order such that they can
+ *         be copied at once.
+ * @param   field           State to compute the FFT of.
+ * @param   comps           Components of field to be transformed.
+ * @param   ncomp           Number of components.
+ * @param   geom            Geometry of the data.
+ * @param   zero_padding    Zero padding factor.
+ * @return  Complex FFT with one component per transformed component. Owned
+ *          by the cached FftContext and only valid until the next transform
+ *          on the same layout or until the cache is released.
+ */
+static amrex::FabArray<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>> &
+FftBatch(const amrex::MultiFab &field, const int *comps, const int ncomp,
+         const amrex::Geometry &geom, int zero_padding = 1) {
+    FftContext &ctx = FftContext::Get(field, geom, zero_padding, ncomp);
+    ctx.Forward(field, comps);
+    return ctx.phi_fft;
+}
+#endif
+
+#ifndef OLD_FFT
+/** @brief Times repeated batched forward transforms of a field once with a
+ *         new context for every transform and once reusing the cached
+ *         context. Releases the cache afterwards.
+ * @param   field           Field to be transformed.
+ * @param   comps           Components of field to be transformed.
+ * @param   ncomp           Number of components.
+ * @param   geom            Geometry of the data.
+ * @param   zero_padding    Zero padding factor.
+ * @param   nrepeat         Number of transforms.
+ */
+static void BenchmarkFftCache(const amrex::MultiFab &field, const int *comps,
+                              const int ncomp, const amrex::Geometry &geom,
+                              const int zero_padding, const int nrepeat) {
+    FftContext::Release();
+
+    amrex::ParallelDescriptor::Barrier();
+    std::chrono::steady_clock::time_point start_time =
+        std::chrono::steady_clock::now();
+    for (int r = 0; r < nrepeat; ++r) {
+        FftContext ctx(field, geom, zero_padding, ncomp);
+        ctx.Forward(field, comps);
+    }
+    amrex::Gpu::streamSynchronize();
+    amrex::ParallelDescriptor::Barrier();
+    const double t_without = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_time).count();
+
+    start_time = std::chrono::steady_clock::now();
+    for (int r = 0; r < nrepeat; ++r)
+        FftContext::Get(field, geom, zero_padding, ncomp).Forward(field, comps);
+    amrex::Gpu::streamSynchronize();
+    amrex::ParallelDescriptor::Barrier();
+    const double t_with = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_time).count();
+
+    FftContext::Release();
+
+    amrex::Print() << "FFT of " << ncomp << " components on "
+                   << geom.Domain().length(0) * zero_padding << "^3 cells, "
+                   << nrepeat << " repetitions: " << t_without
+                   << "s without cache, " << t_with << "s with cache, speedup "
+                   << t_without / t_with << std::endl;
+}
+#endif
+
 }; // namespace utils
 }; // namespace sledgehamr
 
@@ -76,14 +76,16 @@ static bool Read(std::string filename, std::vector<std::string> dnames,
 }
 
 /** @brief Template function to write a dataset of type T to an HDF5 file.
- * @param   file_id HDF5 file id.
- * @param   dset    Dataset name.
- * @param   data    Array pointer to data.
- * @param   size    Length of data.
+ * @param   file_id     HDF5 file id.
+ * @param   dset        Dataset name.
+ * @param   data        Array pointer to data.
+ * @param   size        Length of data.
+ * @param   native_int  Whether integers are stored as integers rather than
+ *                      doubles.
  */
 template <typename T>
 static void Write(hid_t file_id, std::string dset, T *data,
-                  unsigned long long size) {
+                  unsigned long long size, bool native_int = false) {
     // Identify datatype.
     hid_t mem_type_id, dset_type_id;
     if (std::is_same<T, float>::value) {
@@ -94,7 +96,7 @@ static void Write(hid_t file_id, std::string dset, T *data,
         dset_type_id = H5T_IEEE_F64LE;
     } else if (std::is_same<T, int>::value) {
         mem_type_id = H5T_NATIVE_INT;
-        dset_type_id = H5T_IEEE_F64LE;
+        dset_type_id = native_int ? H5T_NATIVE_INT : H5T_IEEE_F64LE;
     } else {
         amrex::Abort("#error: Writing of dataset " + dset +
                      " failed due to unknown datatype.");
@@ -224,6 +224,48 @@ static bool ApproxEqual(double a, double b, double eps = 1e-8) {
     return (fabs(a - b) < a*eps);
 }
 
+/** @brief Cell regions of a box for which the Rhs can be computed
+ *         separately. Interior cells do not depend on ghost cells.
+ */
+enum RhsRegion {
+    AllCells = 0,
+    InteriorCells = 1,
+    BoundaryCells = 2
+};
+
+/** @brief Returns the part of a tile that belongs to a given RhsRegion.
+ * @param   tilebox     Tile.
+ * @param   validbox    Valid box the tile belongs to.
+ * @param   width       Stencil width, i.e. number of ghost cells needed.
+ * @param   region      RhsRegion.
+ * @return  List of boxes. Empty if no cell of the tile is in the region.
+ */
+static amrex::BoxList RhsRegionBoxes(const amrex::Box& tilebox,
+                                     const amrex::Box& validbox,
+                                     const int width, const int region) {
+    if (region == RhsRegion::AllCells)
+        return amrex::BoxList(tilebox);
+
+    const amrex::Box interior = tilebox & amrex::grow(validbox, -width);
+
+    if (region == RhsRegion::InteriorCells)
+        return interior.ok() ? amrex::BoxList(interior) : amrex::BoxList();
+
+    return interior.ok() ? amrex::boxDiff(tilebox, interior)
+                         : amrex::BoxList(tilebox);
+}
+
+/** @brief Wrapper around amrex::ParallelFor that loops over all boxes in a
+ *         list.
+ * @param   bl  List of boxes.
+ * @param   f   Kernel.
+ */
+template <typename F>
+static void ParallelFor(const amrex::BoxList& bl, const F& f) {
+    for (const amrex::Box& bx : bl)
+        amrex::ParallelFor(bx, f);
+}
+
 enum ErrorState {
     ERROR = 0,
     OK = 1,